@@ -7,7 +7,9 @@
 #include "eval/evaluator.hpp"
 #include "form/formula_gen.hpp"
 #include "lang/parser.hpp"
+#include "lang/program_archive.hpp"
 #include "lang/program_util.hpp"
+#include "mine/reducer.hpp"
 #include "seq/managed_seq.hpp"
 #include "sys/log.hpp"
 #include "sys/setup.hpp"
@@ -15,6 +17,8 @@
 
 void Benchmark::smokeTest() {
   operations();
+  allocations();
+  reductions();
   programs();
 }
 
@@ -25,15 +29,16 @@ std::string fillString(std::string s, size_t n) {
   return s;
 }
 
-void Benchmark::operations() {
-  std::cout << "| Operation |  Time     |" << std::endl;
-  std::cout << "|-----------|-----------|" << std::endl;
-  std::vector<Number> ops(1000);
+std::vector<Number> randomNumbers(size_t count, int64_t max_digits,
+                                  bool mixed) {
+  std::vector<Number> nums(count);
   int64_t num_digits;
   std::string str;
-  for (Number& n : ops) {
-    if (Random::get().gen() % 2) {
-      num_digits = (Random::get().gen() % 500) + 1;
+  for (Number& n : nums) {
+    if (!mixed) {
+      num_digits = max_digits;
+    } else if (Random::get().gen() % 2) {
+      num_digits = (Random::get().gen() % max_digits) + 1;
     } else {
       num_digits = (Random::get().gen() % 18) + 1;
     }
@@ -47,41 +52,155 @@ void Benchmark::operations() {
     }
     n = Number(str);
   }
+  return nums;
+}
+
+std::string operationSpeed(Operation::Type type,
+                           const std::vector<Number>& ops) {
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t i = 0; i + 1 < ops.size(); i++) {
+    try {
+      Interpreter::calc(type, ops[i], ops[i + 1]);
+    } catch (const std::exception& e) {
+      // Log::get().warn( std::string( e.what() ) );
+    }
+  }
+  auto cur_time = std::chrono::steady_clock::now();
+  double speed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     cur_time - start_time)
+                     .count() /
+                 static_cast<double>(ops.size());
+  std::stringstream buf;
+  buf.setf(std::ios::fixed);
+  buf.precision(2);
+  buf << speed;
+  return buf.str() + "µs";
+}
+
+void Benchmark::operations() {
+  std::cout << "| Operation |  Time     | 500 Digits |" << std::endl;
+  std::cout << "|-----------|-----------|------------|" << std::endl;
+  auto mixed = randomNumbers(1000, 500, true);
+  auto large = randomNumbers(1000, 500, false);
   for (auto& type : Operation::Types) {
     if (!ProgramUtil::isArithmetic(type)) {
       continue;
     }
+    std::cout << "|    "
+              << Operation::Metadata::get(type).name + "    | " +
+                     fillString(operationSpeed(type, mixed), 10) + " | " +
+                     fillString(operationSpeed(type, large), 11) + " |"
+              << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+void Benchmark::allocations() {
+  // number of heap-allocated big numbers per operation
+  std::cout << "| Digits | BigNum/Op | Time      |" << std::endl;
+  std::cout << "|--------|-----------|-----------|" << std::endl;
+  static const size_t num_ops = 100000;
+  std::vector<Number> results(1000);
+  for (int64_t num_digits : {18, 30, 37, 60, 500}) {
+    auto nums = randomNumbers(1000, num_digits, false);
+    // copy, add, subtract, move and compare numbers of the given size
+    const auto allocs_start = Number::getNumHeapAllocations();
     auto start_time = std::chrono::steady_clock::now();
-    for (size_t i = 0; i + 1 < ops.size(); i++) {
-      try {
-        Interpreter::calc(type, ops[i], ops[i + 1]);
-      } catch (const std::exception& e) {
-        // Log::get().warn( std::string( e.what() ) );
+    for (size_t i = 0; i < num_ops; i++) {
+      const auto& a = nums[i % nums.size()];
+      const auto& b = nums[(i + 1) % nums.size()];
+      Number c = a;
+      c += b;
+      c -= a;
+      if (c != b) {
+        Log::get().error("Unexpected result: " + c.to_string(), true);
       }
+      results[i % results.size()] = std::move(c);
     }
     auto cur_time = std::chrono::steady_clock::now();
-    double speed = std::chrono::duration_cast<std::chrono::microseconds>(
-                       cur_time - start_time)
-                       .count() /
-                   static_cast<double>(ops.size());
-    std::stringstream buf;
-    buf.setf(std::ios::fixed);
-    buf.precision(2);
-    buf << speed;
-    std::cout << "|    "
-              << Operation::Metadata::get(type).name + "    | " +
-                     fillString(buf.str() + "µs", 10) + " |"
-              << std::endl;
+    const double allocs = (Number::getNumHeapAllocations() - allocs_start) /
+                          static_cast<double>(num_ops);
+    const double speed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             cur_time - start_time)
+                             .count() /
+                         static_cast<double>(num_ops);
+    std::stringstream a, t;
+    a.setf(std::ios::fixed);
+    a.precision(2);
+    a << allocs;
+    t.setf(std::ios::fixed);
+    t.precision(2);
+    t << speed;
+    std::cout << "| " << fillString(std::to_string(num_digits), 6) << " | "
+              << fillString(a.str(), 9) << " | "
+              << fillString(t.str() + "ns", 9) << " |" << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+template <class S, class F>
+std::string reductionSpeed(const std::vector<S>& seqs, F reduce) {
+  static const size_t num_ops = 200000;
+  S s;
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    s = seqs[i % seqs.size()];
+    reduce(s);
+  }
+  auto cur_time = std::chrono::steady_clock::now();
+  const double secs = std::chrono::duration_cast<std::chrono::microseconds>(
+                          cur_time - start_time)
+                          .count() /
+                      1000000.0;
+  std::stringstream buf;
+  buf.setf(std::ios::fixed);
+  buf.precision(2);
+  buf << (num_ops / std::max(secs, 1e-6) / 1000000.0);
+  return buf.str() + "M/s";
+}
+
+void Benchmark::reductions() {
+  std::cout << "| Reduction | Terms |  Number   |  Compact  |" << std::endl;
+  std::cout << "|-----------|-------|-----------|-----------|" << std::endl;
+  for (int64_t num_terms : {static_cast<int64_t>(Settings::DEFAULT_NUM_TERMS),
+                            static_cast<int64_t>(100)}) {
+    // sequences similar to the ones produced by mined programs
+    std::vector<Sequence> seqs(1000);
+    for (auto& seq : seqs) {
+      const int64_t a = Random::get().gen() % 100;
+      const int64_t b = (Random::get().gen() % 100) + 1;
+      const int64_t c = Random::get().gen() % 3;
+      for (int64_t n = 0; n < num_terms; n++) {
+        seq.push_back(Number(a + b * (n + c * n * n)));
+      }
+    }
+    const std::vector<CompactSequence> compact(seqs.begin(), seqs.end());
+    auto row = [&](const std::string& name, auto reduce) {
+      std::cout << "| " << fillString(name, 9) << " | "
+                << fillString(std::to_string(num_terms), 5) << " | "
+                << fillString(reductionSpeed(seqs, reduce), 9) << " | "
+                << fillString(reductionSpeed(compact, reduce), 9) << " |"
+                << std::endl;
+    };
+    row("truncate", [](auto& s) { Reducer::truncate(s); });
+    row("shrink", [](auto& s) { Reducer::shrink(s); });
+    row("delta", [](auto& s) { Reducer::delta(s, 4); });
+    row("binary", [](auto& s) { Reducer::digit(s, 2); });
+    row("decimal", [](auto& s) { Reducer::digit(s, 10); });
   }
   std::cout << std::endl;
 }
 
 void Benchmark::programs() {
   Setup::setProgramsHome("tests/programs");
-  std::cout << "| Sequence | Terms  | Reg Eval | Inc Eval | Vir Eval |"
-            << std::endl;
-  std::cout << "|----------|--------|----------|----------|----------|"
-            << std::endl;
+  std::cout
+      << "| Sequence | Terms  | Reg Eval | Bytecode | Snapshot | Inc Eval | "
+         "Vir Eval | Mat Eval |"
+      << std::endl;
+  std::cout
+      << "|----------|--------|----------|----------|----------|----------|"
+         "----------|----------|"
+      << std::endl;
   program(40, 1000);
   program(394, 1000);
   program(401, 1000);
@@ -109,18 +228,27 @@ void Benchmark::program(size_t id, size_t num_terms) {
   Parser parser;
   UID uid('A', id);
   auto program = parser.parse(ProgramUtil::getProgramPath(uid));
-  auto speed_reg = programEval(program, EVAL_REGULAR, num_terms);
-  auto speed_inc = programEval(program, EVAL_INCREMENTAL, num_terms);
-  auto speed_vir = programEval(program, EVAL_VIRTUAL, num_terms);
+  auto speed_reg = programEval(program, EVAL_REGULAR, num_terms, false);
+  auto speed_bc = programEval(program, EVAL_REGULAR, num_terms, true);
+  auto speed_snap = programEval(program, EVAL_REGULAR, num_terms, true, false);
+  auto speed_inc = programEval(program, EVAL_INCREMENTAL, num_terms, true);
+  auto speed_vir = programEval(program, EVAL_VIRTUAL, num_terms, true);
+  auto speed_mat = programEval(program, EVAL_MATRIX, num_terms, true);
   std::cout << "| " << uid.string() << "  | "
             << fillString(std::to_string(num_terms), 6) << " | "
-            << fillString(speed_reg, 8) << " | " << fillString(speed_inc, 8)
-            << " | " << fillString(speed_vir, 8) << " |" << std::endl;
+            << fillString(speed_reg, 8) << " | " << fillString(speed_bc, 8)
+            << " | " << fillString(speed_snap, 8) << " | "
+            << fillString(speed_inc, 8) << " | "
+            << fillString(speed_vir, 8) << " | " << fillString(speed_mat, 8)
+            << " |" << std::endl;
 }
 
 std::string Benchmark::programEval(const Program& p, eval_mode_t eval_mode,
-                                   size_t num_terms) {
+                                   size_t num_terms, bool use_bytecode,
+                                   bool use_journal) {
   Settings settings;
+  settings.use_bytecode = use_bytecode;
+  settings.use_memory_journal = use_journal;
   Evaluator evaluator(settings, eval_mode, false);
   if (!evaluator.supportsEvalModes(p, eval_mode)) {
     return "-";
@@ -144,7 +272,6 @@ std::string Benchmark::programEval(const Program& p, eval_mode_t eval_mode,
 }
 
 void Benchmark::findSlowPrograms(int64_t num_terms, Operation::Type type) {
-  Parser parser;
   Settings settings;
   Interpreter interpreter(settings);
   Evaluator evaluator(settings, EVAL_ALL, false);
@@ -153,12 +280,10 @@ void Benchmark::findSlowPrograms(int64_t num_terms, Operation::Type type) {
   std::priority_queue<std::pair<int64_t, UID> > queue;
   for (size_t id = 0; id < 400000; id++) {
     UID uid('A', id);
-    std::ifstream in(ProgramUtil::getProgramPath(uid));
-    if (!in) {
-      continue;
-    }
     try {
-      program = parser.parse(in);
+      if (!ProgramArchive::get().load(uid, program)) {
+        continue;
+      }
     } catch (std::exception& e) {
       Log::get().warn("Skipping " + uid.string() + ": " + e.what());
       continue;
@@ -186,18 +311,15 @@ void Benchmark::findSlowPrograms(int64_t num_terms, Operation::Type type) {
 }
 
 void Benchmark::findSlowFormulas() {
-  Parser parser;
   Settings settings;
   Program program;
   std::priority_queue<std::pair<int64_t, UID> > queue;
   for (size_t id = 0; id < 400000; id++) {
     UID uid('A', id);
-    std::ifstream in(ProgramUtil::getProgramPath(uid));
-    if (!in) {
-      continue;
-    }
     try {
-      program = parser.parse(in);
+      if (!ProgramArchive::get().load(uid, program)) {
+        continue;
+      }
     } catch (const std::exception& e) {
       Log::get().warn("Skipping " + uid.string() + ": " + e.what());
       continue;
@@ -10,6 +10,10 @@ class Benchmark {
 
   void operations();
 
+  void allocations();
+
+  void reductions();
+
   void programs();
 
   void findSlowPrograms(int64_t num_terms, Operation::Type type);
@@ -20,5 +24,6 @@ class Benchmark {
   void program(size_t id, size_t num_terms);
 
   std::string programEval(const Program& p, eval_mode_t eval_mode,
-                          size_t num_terms);
+                          size_t num_terms, bool use_bytecode,
+                          bool use_journal = true);
 };
@@ -18,6 +18,7 @@
 #include "form/formula_parser.hpp"
 #include "form/function.hpp"
 #include "form/lean.hpp"
+#include "form/native.hpp"
 #include "form/pari.hpp"
 #include "form/recursion.hpp"
 #include "gen/iterator.hpp"
@@ -62,7 +63,7 @@ void Commands::help() {
   std::cout << "  check     <program>  Verify correctness of an integer "
             << "sequence program (see -b)" << std::endl;
   std::cout << "  mine                 Mine programs for integer sequences "
-               "(see -i,-p,-P,-H)"
+               "(see -i,-p,-P,-T,-H)"
             << std::endl;
   std::cout
       << "  submit  <file> [id]  Submit an integer sequence program to the "
@@ -139,9 +140,27 @@ void Commands::help() {
   std::cout << "  -P <number>          Parallel mining using custom number of "
                "instances"
             << std::endl;
+  std::cout << "  -T <number>          Number of mining or validation threads "
+               "per instance (default: 1)"
+            << std::endl;
   std::cout
       << "  -H <number>          Number of mining hours (default: unlimited)"
       << std::endl;
+  std::cout << "  --no-term-store      Do not share evaluated sequence terms "
+               "between miners"
+            << std::endl;
+  std::cout << "  --no-shared-seqs     Do not share sequence data between "
+               "miners"
+            << std::endl;
+  std::cout << "  --stats-threads <n>  Number of threads for generating "
+               "program stats (default: all)"
+            << std::endl;
+  std::cout << "  --eval-threads <n>   Number of threads for evaluating "
+               "program terms (default: 1; -t is the number of terms)"
+            << std::endl;
+  std::cout << "  --seen-programs <n>  Number of recently generated programs "
+               "to skip if seen again (default: 1000000)"
+            << std::endl;
 }
 
 // official commands
@@ -596,6 +615,17 @@ void Commands::testAnalyzer() {
                   " programs have exponential complexity");
 }
 
+template <typename FormulaType>
+bool convertFormula(const Formula& formula, int64_t offset, bool as_vector,
+                    FormulaType& result) {
+  return FormulaType::convert(formula, offset, as_vector, result);
+}
+
+bool convertFormula(const Formula& formula, int64_t, bool,
+                    NativeFormula& result) {
+  return NativeFormula::convert(formula, result);
+}
+
 template <typename FormulaType>
 void testFormula(const std::string& test_id, const Settings& settings,
                  bool as_vector,
@@ -641,8 +671,8 @@ void testFormula(const std::string& test_id, const Settings& settings,
       if (!generator.generate(program, id.number(), formula, true)) {
         continue;
       }
-      if (!FormulaType::convert(formula, ProgramUtil::getOffset(program),
-                                as_vector, formula_obj)) {
+      if (!convertFormula(formula, ProgramUtil::getOffset(program), as_vector,
+                          formula_obj)) {
         continue;
       }
     } catch (const std::exception& e) {
@@ -747,6 +777,11 @@ void Commands::testLean(const std::string& test_id) {
   testFormula<LeanFormula>(test_id, settings, false);
 }
 
+void Commands::testNative(const std::string& test_id) {
+  initLog(false);
+  testFormula<NativeFormula>(test_id, settings, false);
+}
+
 void Commands::testFormulaParser(const std::string& test_id) {
   initLog(false);
   Parser parser;
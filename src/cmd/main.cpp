@@ -121,6 +121,10 @@ int dispatch(Settings settings, const std::vector<std::string>& args) {
       cmd != "check") {
     Log::get().error("Option -b not allowed for this command", true);
   }
+  if (settings.num_eval_threads > 1 && cmd != "evaluate" && cmd != "eval") {
+    Log::get().error("Option --eval-threads only allowed in evaluate command",
+                     true);
+  }
   if (settings.parallel_mining && cmd != "mine") {
     Log::get().error("Option -p only allowed in mine command", true);
   }
@@ -249,6 +253,12 @@ int dispatch(Settings settings, const std::vector<std::string>& args) {
       id = args.at(1);
     }
     commands.testEval(id, EVAL_VIRTUAL);
+  } else if (cmd == "test-mateval") {
+    std::string id;
+    if (args.size() > 1) {
+      id = args.at(1);
+    }
+    commands.testEval(id, EVAL_MATRIX);
   } else if (cmd == "test-analyzer") {
     commands.testAnalyzer();
   } else if (cmd == "test-pari") {
@@ -263,6 +273,12 @@ int dispatch(Settings settings, const std::vector<std::string>& args) {
       id = args.at(1);
     }
     commands.testLean(id);
+  } else if (cmd == "test-native") {
+    std::string id;
+    if (args.size() > 1) {
+      id = args.at(1);
+    }
+    commands.testNative(id);
   } else if (cmd == "test-formula-parser") {
     std::string id;
     if (args.size() > 1) {
@@ -1,11 +1,13 @@
 #include "cmd/test.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <deque>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
 #include "eval/evaluator.hpp"
 #include "eval/fold.hpp"
@@ -13,9 +15,11 @@
 #include "eval/minimizer.hpp"
 #include "eval/optimizer.hpp"
 #include "eval/range_generator.hpp"
+#include "eval/term_store.hpp"
 #include "form/formula_gen.hpp"
 #include "form/formula_parser.hpp"
 #include "form/lean.hpp"
+#include "form/native.hpp"
 #include "form/pari.hpp"
 #include "gen/blocks.hpp"
 #include "gen/generator_v1.hpp"
@@ -23,18 +27,28 @@
 #include "lang/comments.hpp"
 #include "lang/constants.hpp"
 #include "lang/parser.hpp"
+#include "lang/program_archive.hpp"
 #include "lang/program_util.hpp"
 #include "lang/subprogram.hpp"
 #include "lang/virtual_seq.hpp"
 #include "math/big_number.hpp"
+#include "math/compact_sequence.hpp"
 #include "math/semantics.hpp"
 #include "mine/api_client.hpp"
+#include "mine/checker.hpp"
 #include "mine/config.hpp"
+#include "mine/fingerprint_index.hpp"
 #include "mine/matcher.hpp"
 #include "mine/mine_manager.hpp"
+#include "mine/reducer.hpp"
 #include "mine/miner.hpp"
+#include "mine/reference_cache.hpp"
+#include "mine/seen_program_filter.hpp"
 #include "mine/stats.hpp"
+#include "seq/bfile_cache.hpp"
+#include "seq/managed_seq.hpp"
 #include "seq/seq_list.hpp"
+#include "seq/seq_loader.hpp"
 #include "sys/file.hpp"
 #include "sys/git.hpp"
 #include "sys/gzip.hpp"
@@ -60,9 +74,13 @@ void Test::all() {
 void Test::fast() {
   uid();
   sequence();
+  compactSequence();
+  sequenceSnapshot();
+  bfileCache();
   memory();
   operationMetadata();
   programUtil();
+  programArchive();
   semantics();
   config();
   steps();
@@ -71,9 +89,21 @@ void Test::fast() {
   unfold();
   virtualSeq();
   incEval();
+  matrixEval();
+  bytecode();
+  int64Interpreter();
+  batchEval();
+  parallelEval();
+  termStore();
   linearMatcher();
   deltaMatcher();
   digitMatcher();
+  fingerprintIndex();
+  referenceCache();
+  seenProgramFilter();
+  checkerComparison();
+  validationPipeline();
+  statsMerge();
   optimizer();
   checkpoint();
   knownPrograms();
@@ -262,6 +292,59 @@ void Test::number() {
   m = Number(std::numeric_limits<int64_t>::min());
   m %= Number(-1);
   check_num(m, "0");
+  // Test transitions between small, wide and big numbers
+  m = Number(std::numeric_limits<int64_t>::max());
+  m += 1;
+  check_num(m, "9223372036854775808");
+  m -= 1;
+  check_num(m, "9223372036854775807");
+  if (!m.fitsInInt64()) {
+    Log::get().error("Expected number to fit into int64", true);
+  }
+  m = Number("42535295865117307932921825928971026431");  // 2^125-1
+  auto w = m;
+  w += 1;
+  check_num(w, "42535295865117307932921825928971026432");
+  check_less(m, w);
+  w -= 1;
+  if (w != m || w.hash() != m.hash()) {
+    Log::get().error("Unexpected wide number after round-trip", true);
+  }
+  w *= m;
+  check_num(w,
+            "180925139433306555349329664076074856012227291867039919725068"
+            "1098265700597761");
+  w /= m;
+  check_num(w, m.to_string());
+  w.negate();
+  check_less(w, Number::MINUS_ONE);
+  check_less(Number(std::numeric_limits<int64_t>::min()), Number::ZERO);
+  o = Number("-9223372036854775809");
+  o %= Number(10);
+  check_num(o, "-9");
+  o = std::move(w);
+  check_num(o, "-42535295865117307932921825928971026431");
+  // Test that inline numbers use the same hash values as big numbers
+  for (const auto& n : {Number::ZERO, Number(-7), Number::MIN, o, m}) {
+    if (n.hash() != BigNumber(n.to_string()).hash()) {
+      Log::get().error("Unexpected hash value of " + n.to_string(), true);
+    }
+  }
+  // Test Karatsuba multiplication and long division with 520-digit numbers
+  std::string s1, s2;
+  for (size_t i = 0; i < 520; i++) {
+    s1 += static_cast<char>('1' + (i * 7) % 9);
+    s2 += static_cast<char>('1' + (i * 5) % 9);
+  }
+  const Number x(s1), y(s2), shift = Semantics::pow(10, 260);
+  auto p = x;
+  p *= y;
+  auto q = Semantics::mul(Semantics::mul(x, Semantics::div(y, shift)), shift);
+  q += Semantics::mul(x, Semantics::mod(y, shift));
+  check_num(p, q.to_string());
+  p -= Number(12345);
+  check_num(Semantics::div(p, y), Semantics::sub(x, 1).to_string());
+  check_num(Semantics::mod(p, x), Semantics::sub(x, 12345).to_string());
   testNumberDigits(USE_BIG_NUMBER ? (BigNumber::NUM_WORDS * 18) : 18, false);
   testNumberDigits(USE_BIG_NUMBER ? (BigNumber::NUM_WORDS * 18) : 18, true);
 }
@@ -457,6 +540,202 @@ void checkMemoryString(const std::string& in, const std::string& out) {
 
 void checkMemoryString(const std::string& s) { checkMemoryString(s, s); }
 
+void Test::compactSequence() {
+  Log::get().info("Testing compact sequence");
+  const Number big("-123456789012345678901234567890");
+  const int64_t min = std::numeric_limits<int64_t>::min();
+  const int64_t max = std::numeric_limits<int64_t>::max();
+  std::vector<Sequence> seqs = {
+      Sequence(),
+      Sequence({0, 1, 1, 2, 3, 5, 8, 13, 21, 34}),
+      Sequence({5, 7, 9, 11, 13}),
+      Sequence({6, 12, 18, 24}),
+      Sequence({3, 3, 3}),
+      Sequence({-4, 6, -8, 10}),
+      Sequence({min, 0, min}),
+      Sequence({1, max, 1, max}),
+      Sequence({-max, 0, max}),
+      Sequence({-1, max, max}),
+      Sequence({-7, -3, 5, 9, -11}),
+      Sequence({max - 1, max}),
+      Sequence({1, 4, 9, 16, 25, 36, 49, 64, 81, 100})};
+  Sequence with_big({1, 2, min});
+  with_big.push_back(big);
+  with_big.push_back(Number(4));
+  seqs.push_back(with_big);
+  for (const auto& seq : seqs) {
+    CompactSequence c(seq);
+    if (c.toSequence() != seq || c.isSmall() != (seq != with_big) ||
+        c != CompactSequence(seq) || c.hash() != CompactSequence(seq).hash()) {
+      Log::get().error("Unexpected compact sequence: " + seq.to_string(),
+                       true);
+    }
+    // the reductions must agree with the Number-based ones
+    for (int r = 0; r < 5; r++) {
+      Sequence s = seq;
+      CompactSequence t = c;
+      std::string a, b;
+      switch (r) {
+        case 0:
+          a = Reducer::truncate(s).to_string();
+          b = Reducer::truncate(t).to_string();
+          break;
+        case 1:
+          a = Reducer::shrink(s).to_string();
+          b = Reducer::shrink(t).to_string();
+          break;
+        case 2: {
+          auto d = Reducer::delta(s, 4);
+          auto e = Reducer::delta(t, 4);
+          a = std::to_string(d.delta) + "," + d.offset.to_string() + "," +
+              d.factor.to_string();
+          b = std::to_string(e.delta) + "," + e.offset.to_string() + "," +
+              e.factor.to_string();
+          break;
+        }
+        default: {
+          const int64_t num_digits = (r == 3) ? 2 : 10;
+          a = std::to_string(Reducer::digit(s, num_digits));
+          b = std::to_string(Reducer::digit(t, num_digits));
+          break;
+        }
+      }
+      if (a != b || t.toSequence() != s) {
+        Log::get().error("Unexpected reduction " + std::to_string(r) +
+                             " of " + seq.to_string() + ": " +
+                             t.toSequence().to_string() + " (" + b +
+                             ") != " + s.to_string() + " (" + a + ")",
+                         true);
+      }
+    }
+  }
+  CompactSequence c(with_big);
+  c.set(0, big);
+  c.set(3, Number(7));
+  c.truncate(4);
+  Sequence expected({1, 2, min, 7});
+  expected[0] = big;
+  if (c.toSequence() != expected || c.get(2) != Number(min) ||
+      c.get(0) != big || c.isSmall()) {
+    Log::get().error("Unexpected compact sequence update", true);
+  }
+  c.set(0, Number(1));
+  if (!c.isSmall() || c != CompactSequence(Sequence({1, 2, min, 7}))) {
+    Log::get().error("Unexpected compact sequence update", true);
+  }
+}
+
+void Test::sequenceSnapshot() {
+  Log::get().info("Testing sequence snapshot");
+  const std::string folder = getTmpDir() + "loda_snapshot_test" + FILE_SEP;
+  rmDirRecursive(folder);
+  ensureDir(folder);
+  {
+    std::ofstream stripped(folder + "stripped");
+    stripped << "# test data\n"
+             << "A000001 ,0,1,1,1,2,1,2,1,5,2,\n"
+             << "A000002 ,1,2,\n"
+             << "A000045 ,0,1,1,2,3,5,8,13,-9223372036854775808,"
+                "123456789012345678901234567890,\n";
+    std::ofstream names(folder + "names");
+    names << "A000001 Number of groups of order n.\n"
+          << "A000045 Fibonacci numbers.\n";
+    std::ofstream offsets(folder + "offsets");
+    offsets << "A000001: 1\nA000045: 0\n";
+  }
+  const std::string snapshot = folder + "stripped.bin";
+  for (int i = 0; i < 4; i++) {
+    // first round: text files; second round: snapshot; third round: shared
+    // snapshot; fourth round: text files again because the source data changed
+    if (i == 3) {
+      std::ofstream names(folder + "names", std::ios::app);
+      names << "A000002 Kolakoski sequence.\n";
+    }
+    SequenceIndex index;
+    SequenceLoader loader(index, 3, i == 2);
+    loader.load(folder, 'A');
+    if (!isFile(snapshot)) {
+      Log::get().error("Missing sequence snapshot", true);
+    }
+    if (loader.getNumLoaded() != 2 || loader.getNumTotal() != 3 ||
+        index.exists(UID('A', 2))) {
+      Log::get().error("Unexpected number of loaded sequences", true);
+    }
+    const auto& fib = index.get(UID('A', 45));
+    Sequence expected({0, 1, 1, 2, 3, 5, 8, 13});
+    expected.push_back(Number("-9223372036854775808"));
+    expected.push_back(Number("123456789012345678901234567890"));
+    if (fib.getTerms(fib.numExistingTerms()) != expected ||
+        fib.getTerms(4) != expected.subsequence(0, 4) ||
+        fib.name != "Fibonacci numbers." || fib.offset != 0 ||
+        index.get(UID('A', 1)).offset != 1) {
+      Log::get().error("Unexpected snapshot data: " + fib.string(), true);
+    }
+  }
+  rmDirRecursive(folder);
+}
+
+void Test::bfileCache() {
+  Log::get().info("Testing b-file cache");
+  auto& cache = BFileCache::get();
+  cache.clear();
+  std::vector<ManagedSequence> seqs;
+  for (int64_t i = 1; i <= 3; i++) {
+    ManagedSequence seq(UID('U', i), "test", Sequence({0, 1, i}));
+    const auto path = seq.getBFilePath();
+    ensureDir(path);
+    std::ofstream bfile(path);
+    bfile << "# comment\n\n  0 0\n1 1\r\n2  " << i << "\n";
+    if (i == 2) {
+      bfile << "3 -123456789012345678901234567890\n4 5 extra\n";
+    } else if (i == 3) {
+      bfile << "3 -0\n";  // invalid
+    }
+    seqs.push_back(seq);
+  }
+  Sequence expected({0, 1, 2});
+  expected.push_back(Number("-123456789012345678901234567890"));
+  expected.push_back(Number(5));
+  if (seqs[1].getTerms(10) != expected ||
+      seqs[1].getTerms(4) != expected.subsequence(0, 4) ||
+      seqs[1].getTerms(2) != Sequence({0, 1})) {
+    Log::get().error(
+        "Unexpected b-file terms: " + seqs[1].getTerms(10).to_string(), true);
+  }
+  if (seqs[2].getTerms(10) != Sequence({0, 1, 3})) {
+    Log::get().error("Unexpected terms for invalid b-file", true);
+  }
+  if (cache.size() != 2 || cache.numMisses() != 2 || cache.numHits() != 1) {
+    Log::get().error("Unexpected b-file cache state", true);
+  }
+
+  // least recently used sequences are evicted
+  cache.setMaxTerms(6);
+  if (cache.size() != 1 || seqs[2].getTerms(10).size() != 3 ||
+      cache.numMisses() != 2) {
+    Log::get().error("Unexpected b-file cache eviction", true);
+  }
+
+  // prefetch in the background
+  cache.prefetch(seqs[0]);
+  for (int i = 0; i < 100 && cache.size() < 2; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  if (seqs[0].getTerms(10) != Sequence({0, 1, 1}) || cache.numMisses() != 3) {
+    Log::get().error("Unexpected prefetched b-file terms", true);
+  }
+  cache.stopPrefetch();
+
+  // removed b-files are invalidated
+  cache.invalidate(seqs[0].id);
+  if (cache.size() != 1 || cache.numTerms() != 3) {
+    Log::get().error("Unexpected b-file cache invalidation", true);
+  }
+  cache.setMaxTerms(BFileCache::DEFAULT_MAX_TERMS);
+  cache.clear();
+  rmDirRecursive(Setup::getSeqsHome() + "user");
+}
+
 void Test::memory() {
   Log::get().info("Testing memory");
 
@@ -601,6 +880,30 @@ void Test::memory() {
   mem.rotateRight(5, 0);
   checkMemory(mem, 5, 100);  // unchanged
   checkMemory(mem, 6, 200);  // unchanged
+
+  // Test memory journal with nested loops
+  mem.clear();
+  mem.set(1, 1);
+  mem.set(20, 20);
+  MemoryJournal journal;
+  journal.push();
+  journal.record(mem, 1);
+  mem.set(1, 2);
+  journal.commit();  // next iteration of outer loop
+  journal.push();
+  journal.record(mem, 1);
+  mem.set(1, 3);
+  journal.record(mem, 20);
+  mem.set(20, 21);
+  journal.commit();  // next iteration of inner loop
+  journal.record(mem, 1);
+  mem.set(1, 4);
+  journal.rollback(mem);  // exit inner loop
+  checkMemory(mem, 1, 3);
+  checkMemory(mem, 20, 21);
+  journal.rollback(mem);  // exit outer loop
+  checkMemory(mem, 1, 2);
+  checkMemory(mem, 20, 20);
 }
 
 void checkEnclosingLoop(const Program& p, int64_t begin, int64_t end,
@@ -709,6 +1012,87 @@ void Test::programUtil() {
   }
 }
 
+void Test::programArchive() {
+  Log::get().info("Testing program archive");
+  Parser parser;
+  auto& archive = ProgramArchive::get();
+  const auto check = [](const Program& p, const Program& q,
+                        const std::string& name) {
+    bool equal = (p == q && p.directives == q.directives);
+    for (size_t i = 0; equal && i < p.ops.size(); i++) {
+      equal = (p.ops[i].comment == q.ops[i].comment);
+    }
+    if (!equal) {
+      Log::get().error("Unexpected archived program " + name, true);
+    }
+  };
+
+  // all test programs must be restored including comments and directives
+  archive.update();
+  const auto home = Setup::getProgramsHome();
+  size_t num_programs = 0;
+  for (const auto& dir : std::filesystem::directory_iterator(home + "oeis")) {
+    if (!dir.is_directory()) {
+      continue;
+    }
+    for (const auto& f : std::filesystem::directory_iterator(dir)) {
+      const auto name = f.path().stem().string();
+      if (f.path().extension() != ".asm" || !UID::valid(name)) {
+        continue;
+      }
+      const auto expected = parser.parse(f.path().string());
+      std::string buf;
+      ProgramArchive::serialize(expected, buf);
+      const char* pos = buf.data();
+      Program p, q;
+      if (!ProgramArchive::deserialize(pos, buf.data() + buf.size(), p) ||
+          pos != buf.data() + buf.size() || !archive.load(UID(name), q)) {
+        Log::get().error("Cannot restore program " + name, true);
+      }
+      check(p, expected, name);
+      check(q, expected, name);
+      num_programs++;
+    }
+  }
+  if (num_programs == 0) {
+    Log::get().error("No programs found in " + home, true);
+  }
+
+  // changed program files must take precedence over the archive
+  const auto tmp_home = getTmpDir() + "loda_archive_test" + FILE_SEP;
+  rmDirRecursive(tmp_home);
+  const UID id('A', 45);
+  Setup::setProgramsHome(home);
+  const auto src = ProgramUtil::getProgramPath(id);
+  ensureDir(tmp_home + "oeis" + FILE_SEP + "000" + FILE_SEP);
+  Setup::setProgramsHome(tmp_home);
+  const auto dst = ProgramUtil::getProgramPath(id);
+  std::filesystem::copy_file(src, dst);
+  auto expected = parser.parse(dst);
+  Program p;
+  archive.update();
+  if (!archive.load(id, p) || archive.load(UID('A', 46), p)) {
+    Log::get().error("Unexpected program archive lookup result", true);
+  }
+  check(p, expected, id.string());
+  {
+    std::ofstream out(dst, std::ios::app);
+    out << "add $0,1 ; changed" << std::endl;
+  }
+  expected = parser.parse(dst);
+  if (!archive.load(id, p)) {
+    Log::get().error("Cannot load changed program", true);
+  }
+  check(p, expected, id.string());
+  archive.update();
+  if (!archive.load(id, p)) {
+    Log::get().error("Cannot load updated program", true);
+  }
+  check(p, expected, id.string());
+  Setup::setProgramsHome(home);
+  rmDirRecursive(tmp_home);
+}
+
 void validateIterated(const Program& p) {
   ProgramUtil::validate(p);
   if (ProgramUtil::numOps(p, Operand::Type::INDIRECT) > 0) {
@@ -912,6 +1296,410 @@ void Test::virtualEval() {
   }
 }
 
+void Test::matrixEval() {
+  // manually written test cases
+  auto dir = std::string("tests") + FILE_SEP + "inceval" + FILE_SEP;
+  std::stringstream s;
+  size_t num_supported = 0;
+  for (size_t i = 1;; i++) {
+    s.str("");
+    s << dir << "I" << std::setw(3) << std::setfill('0') << i << ".asm";
+    if (!isFile(s.str())) {
+      break;
+    }
+    if (checkEvaluator(settings, 0, s.str(), EVAL_MATRIX, false)) {
+      num_supported++;
+    }
+  }
+  if (num_supported == 0) {
+    Log::get().error("Expected supported matrix evaluator test cases", true);
+  }
+  // OEIS sequence test cases
+  std::vector<size_t> ids = {45, 1906};
+  for (auto id : ids) {
+    checkEvaluator(settings, id, "", EVAL_MATRIX, true);
+  }
+  // large arguments
+  Parser parser;
+  auto p = parser.parse(ProgramUtil::getProgramPath(UID('A', 45)));
+  Settings unlimited(settings);
+  unlimited.max_cycles = -1;
+  MatrixEvaluator mat(unlimited);
+  if (!mat.init(p)) {
+    Log::get().error("Cannot initialize matrix evaluator", true);
+  }
+  auto r = mat.eval(Number(1000));
+  if (r.first.to_string().substr(0, 10) != "4346655768" ||
+      r.first.to_string().size() != 209) {
+    Log::get().error("Unexpected Fibonacci number: " + r.first.to_string(),
+                     true);
+  }
+}
+
+void Test::bytecode() {
+  Log::get().info("Testing bytecode interpreter");
+  std::vector<std::string> paths;
+  auto dir = std::string("tests") + FILE_SEP + "inceval" + FILE_SEP;
+  std::stringstream s;
+  for (size_t i = 1;; i++) {
+    s.str("");
+    s << dir << "I" << std::setw(3) << std::setfill('0') << i << ".asm";
+    if (!isFile(s.str())) {
+      break;
+    }
+    paths.push_back(s.str());
+  }
+  std::vector<size_t> ids = {5,    30,    40,    45,    79,    1041,  1113,
+                             1489, 1497,  1609,  2110,  2260,  3411,  7661,
+                             12866, 35856, 57552, 79309, 248765};
+  for (auto id : ids) {
+    paths.push_back(ProgramUtil::getProgramPath(UID('A', id)));
+  }
+  Settings settings_prg = settings;
+  Settings settings_bc = settings;
+  settings_prg.use_bytecode = false;
+  settings_bc.use_bytecode = true;
+  Evaluator eval_prg(settings_prg, EVAL_REGULAR, false);
+  Evaluator eval_bc(settings_bc, EVAL_REGULAR, false);
+  Parser parser;
+  for (const auto& path : paths) {
+    auto p = parser.parse(path);
+    Sequence seq_prg, seq_bc;
+    auto steps_prg = eval_prg.eval(p, seq_prg, 20, false);
+    auto steps_bc = eval_bc.eval(p, seq_bc, 20, false);
+    if (seq_prg != seq_bc) {
+      Log::get().error("Unexpected bytecode result for " + path + ": " +
+                           seq_bc.to_string() + "; expected " +
+                           seq_prg.to_string(),
+                       true);
+    }
+    if (steps_prg.total != steps_bc.total) {
+      Log::get().error("Unexpected bytecode steps for " + path, true);
+    }
+  }
+}
+
+void Test::parallelEval() {
+  Log::get().info("Testing parallel evaluation");
+  std::vector<size_t> ids = {5,    30,   40,   45,   79,    1041,
+                             1113, 1489, 1497, 1609, 12866, 248765};
+  Settings settings_par = settings;
+  settings_par.num_eval_threads = 4;
+  Evaluator eval_seq(settings, EVAL_REGULAR, false);
+  Evaluator eval_par(settings_par, EVAL_REGULAR, false);
+  Parser parser;
+  for (auto id : ids) {
+    auto p = parser.parse(ProgramUtil::getProgramPath(UID('A', id)));
+    Sequence seq_seq, seq_par;
+    auto steps_seq = eval_seq.eval(p, seq_seq, 100, false);
+    auto steps_par = eval_par.eval(p, seq_par, 100, false);
+    if (seq_seq != seq_par) {
+      Log::get().error("Unexpected parallel result for " +
+                           UID('A', id).string() + ": " + seq_par.to_string() +
+                           "; expected " + seq_seq.to_string(),
+                       true);
+    }
+    if (steps_seq.total != steps_par.total ||
+        steps_seq.runs != steps_par.runs || steps_seq.min != steps_par.min ||
+        steps_seq.max != steps_par.max) {
+      Log::get().error("Unexpected parallel steps for " + UID('A', id).string(),
+                       true);
+    }
+  }
+  // the evaluation stops at the first error
+  std::stringstream buf("mov $1,7\nsub $1,$0\ndiv $0,$1\n");
+  auto p = parser.parse(buf);
+  Sequence seq;
+  eval_par.eval(p, seq, 100, false);
+  if (seq.size() != 7) {
+    Log::get().error("Unexpected parallel result: " + seq.to_string(), true);
+  }
+  bool thrown = false;
+  try {
+    eval_par.eval(p, seq, 100, true);
+  } catch (const std::exception&) {
+    thrown = true;
+  }
+  if (!thrown) {
+    Log::get().error("Expected parallel evaluation error", true);
+  }
+  // the callback can stop the evaluation
+  eval_par.eval(p, seq, 100, false,
+                [](int64_t index, const Number&, const steps_t&) {
+                  return index < 3;
+                });
+  if (seq.size() != 4) {
+    Log::get().error("Unexpected parallel result: " + seq.to_string(), true);
+  }
+}
+
+void Test::int64Interpreter() {
+  Log::get().info("Testing int64 interpreter");
+  std::vector<std::string> paths;
+  std::vector<size_t> ids = {5,    30,   40,    45,    79,    1041,
+                             1113, 1489, 1497,  1609,  2110,  2260,
+                             3411, 7661, 12866, 35856, 57552, 248765};
+  for (auto id : ids) {
+    paths.push_back(ProgramUtil::getProgramPath(UID('A', id)));
+  }
+  // overflows, division by zero, nested loops and exceeded steps
+  std::vector<std::string> codes = {
+      "mov $1,2\npow $1,$0\nmul $1,$1\nmov $0,$1\n",
+      "mov $1,7\nsub $1,$0\ndiv $0,$1\n",
+      "mov $1,$0\nlpb $1\nsub $1,1\nmov $3,$1\nlpb $3\nadd $2,$3\n"
+      "sub $3,2\nlpe\nlpe\nmov $0,$2\n",
+      "mov $1,-9223372036854775807\nsub $1,$0\ngcd $1,6\ndir $1,2\n"
+      "mod $1,-1\nmov $0,$1\n",
+      "add $0,1\nlpb $0\nmul $1,3\nadd $1,1\nadd $0,1\nlpe\n"};
+  Parser parser;
+  std::vector<Program> programs;
+  for (const auto& path : paths) {
+    programs.push_back(parser.parse(path));
+  }
+  for (const auto& code : codes) {
+    std::stringstream buf(code);
+    programs.push_back(parser.parse(buf));
+  }
+  Settings settings_small = settings;
+  settings_small.max_cycles = 10000;
+  Interpreter interpreter(settings_small);
+  Int64Interpreter int64_interpreter(settings_small);
+  size_t num_supported = 0, num_deopts = 0;
+  for (const auto& p : programs) {
+    Bytecode bc;
+    if (!interpreter.compile(p, bc) || !int64_interpreter.init(bc)) {
+      continue;
+    }
+    num_supported++;
+    for (int64_t n = 0; n < 70; n++) {
+      Memory expected, mem;
+      expected.set(Program::INPUT_CELL, n);
+      mem.set(Program::INPUT_CELL, n);
+      size_t expected_steps = 0, steps = 0;
+      std::string expected_error, error;
+      try {
+        expected_steps = interpreter.run(bc, expected);
+      } catch (const std::exception& e) {
+        expected_error = e.what();
+      }
+      bool ok = false;
+      try {
+        ok = int64_interpreter.run(mem, steps);
+      } catch (const std::exception& e) {
+        error = e.what();
+      }
+      if (!ok && error.empty()) {
+        num_deopts++;
+        continue;
+      }
+      if (error != expected_error ||
+          (error.empty() && (mem != expected || steps != expected_steps))) {
+        Log::get().error("Unexpected int64 interpreter result for program:\n" +
+                             ProgramUtil::operationToString(p.ops.front()) +
+                             "...; n=" + std::to_string(n),
+                         true);
+      }
+    }
+  }
+  if (num_supported < programs.size() / 2 || num_deopts == 0) {
+    Log::get().error("Unexpected number of int64 interpreter runs", true);
+  }
+  // the evaluator falls back to the regular interpreter
+  Settings settings_prg = settings;
+  settings_prg.use_bytecode = false;
+  Evaluator eval_prg(settings_prg, EVAL_REGULAR, false);
+  Evaluator eval_int64(settings, EVAL_REGULAR, false);
+  Sequence seq_prg, seq_int64;
+  auto steps_prg = eval_prg.eval(programs[paths.size()], seq_prg, 70);
+  auto steps_int64 = eval_int64.eval(programs[paths.size()], seq_int64, 70);
+  if (seq_prg != seq_int64 || steps_prg.total != steps_int64.total ||
+      eval_int64.getNumDeopts() == 0 || eval_prg.getNumDeopts() != 0) {
+    Log::get().error("Unexpected int64 evaluation result: " +
+                         seq_int64.to_string(),
+                     true);
+  }
+}
+
+void Test::batchEval() {
+  Log::get().info("Testing batch evaluation");
+  std::vector<std::string> paths;
+  auto dir = std::string("tests") + FILE_SEP + "inceval" + FILE_SEP;
+  std::stringstream s;
+  for (size_t i = 1;; i++) {
+    s.str("");
+    s << dir << "I" << std::setw(3) << std::setfill('0') << i << ".asm";
+    if (!isFile(s.str())) {
+      break;
+    }
+    paths.push_back(s.str());
+  }
+  std::vector<size_t> ids = {5,    30,    40,    45,    79,    1041,  1113,
+                             1489, 1497,  1609,  2110,  2260,  3411,  7661,
+                             12866, 35856, 57552, 79309, 248765};
+  for (auto id : ids) {
+    paths.push_back(ProgramUtil::getProgramPath(UID('A', id)));
+  }
+  // lanes leaving nested loops at different iterations, int64 overflow and
+  // evaluation errors
+  std::vector<std::string> codes = {
+      "mov $1,$0\nlpb $1\nsub $1,1\nmov $3,$1\nlpb $3\nadd $2,$3\n"
+      "sub $3,2\nlpe\nlpe\nmov $0,$2\n",
+      "mov $1,2\npow $1,$0\nmul $1,$1\nmov $0,$1\n",
+      "mov $1,7\nsub $1,$0\ndiv $0,$1\n",
+      "mov $1,$0\nlpb $1\nmul $2,3\nadd $2,$1\ndiv $1,2\nlpe\n"
+      "min $0,$2\nequ $2,$0\nbxo $2,5\n"};
+  Settings settings_prg = settings;
+  Settings settings_bc = settings;
+  settings_prg.use_bytecode = false;
+  settings_bc.use_bytecode = true;
+  Evaluator eval_prg(settings_prg, EVAL_REGULAR, false);
+  Evaluator eval_bc(settings_bc, EVAL_REGULAR, false);
+  Parser parser;
+  std::vector<Program> programs;
+  for (const auto& path : paths) {
+    programs.push_back(parser.parse(path));
+  }
+  for (const auto& code : codes) {
+    std::stringstream buf(code);
+    programs.push_back(parser.parse(buf));
+  }
+  for (size_t i = 0; i < programs.size(); i++) {
+    const auto& p = programs[i];
+    const auto name = i < paths.size() ? paths[i] : codes[i - paths.size()];
+    std::vector<Sequence> seqs_prg(3), seqs_bc(3);
+    steps_t steps_prg, steps_bc;
+    std::string error_prg, error_bc;
+    try {
+      steps_prg = eval_prg.eval(p, seqs_prg, 20);
+    } catch (const std::exception& e) {
+      error_prg = e.what();
+    }
+    try {
+      steps_bc = eval_bc.eval(p, seqs_bc, 20);
+    } catch (const std::exception& e) {
+      error_bc = e.what();
+    }
+    if (error_prg != error_bc) {
+      Log::get().error("Unexpected batch evaluation error for " + name +
+                           ": \"" + error_bc + "\"; expected \"" +
+                           error_prg + "\"",
+                       true);
+    }
+    if (!error_prg.empty()) {
+      continue;
+    }
+    for (size_t j = 0; j < seqs_prg.size(); j++) {
+      if (seqs_prg[j] != seqs_bc[j]) {
+        Log::get().error("Unexpected batch evaluation result for " + name +
+                             ": " + seqs_bc[j].to_string() + "; expected " +
+                             seqs_prg[j].to_string(),
+                         true);
+      }
+    }
+    if (steps_prg.total != steps_bc.total || steps_prg.min != steps_bc.min ||
+        steps_prg.max != steps_bc.max || steps_prg.runs != steps_bc.runs) {
+      Log::get().error("Unexpected batch evaluation steps for " + name, true);
+    }
+  }
+}
+
+void Test::termStore() {
+  Log::get().info("Testing term store");
+  const std::string folder = getTmpDir() + "loda_terms_test" + FILE_SEP;
+  rmDirRecursive(folder);
+  auto& store = TermStore::get();
+  std::stringstream buf("mov $1,$0\nseq $1,45\nmul $0,$1\n");
+  Parser parser;
+  auto p = parser.parse(buf);
+  Sequence expected_seq;
+  steps_t expected_steps;
+  store.open(folder);
+  for (int i = 0; i < 3; i++) {
+    // first round: evaluate and store; second round: in-memory lookup; third
+    // round: load the terms written by the "previous process"
+    if (i == 2) {
+      store.open(folder);
+    }
+    store.resetCounters();
+    Sequence seq;
+    Evaluator evaluator(settings, EVAL_REGULAR, false);
+    auto steps = evaluator.eval(p, seq, 20);
+    if (i == 0) {
+      expected_seq = seq;
+      expected_steps = steps;
+    } else if (seq != expected_seq || steps.total != expected_steps.total) {
+      Log::get().error("Unexpected result using term store: " +
+                           seq.to_string() + "; expected " +
+                           expected_seq.to_string(),
+                       true);
+    }
+    const size_t expected_hits = (i == 0) ? 0 : 20;
+    if (store.getNumHits() != expected_hits) {
+      Log::get().error("Unexpected number of term store hits: " +
+                           std::to_string(store.getNumHits()),
+                       true);
+    }
+  }
+  // stored terms must not hide recursive calls
+  std::stringstream rec_buf("seq $0,45\n");
+  auto rec = parser.parse(rec_buf);
+  std::string rec_error;
+  try {
+    Interpreter interpreter(settings);
+    Memory mem;
+    mem.set(Program::INPUT_CELL, 5);
+    interpreter.run(rec, mem, UID('A', 45));
+  } catch (const std::exception& e) {
+    rec_error = e.what();
+  }
+  if (rec_error.rfind("Recursion detected", 0) != 0) {
+    Log::get().error("Expected recursion error using term store", true);
+  }
+  {
+    TermStore::Bypass bypass;
+    if (store.isEnabled()) {
+      Log::get().error("Unexpected enabled term store during bypass", true);
+    }
+  }
+  if (!store.isEnabled()) {
+    Log::get().error("Unexpected disabled term store after bypass", true);
+  }
+  // terms of a different program version must be ignored
+  int64_t value;
+  size_t steps;
+  const UID id('A', 45);
+  store.insert(id, 1, 100, 7, 3);
+  if (!store.lookup(id, 1, 100, value, steps) || value != 7 || steps != 3 ||
+      store.lookup(id, 2, 100, value, steps)) {
+    Log::get().error("Unexpected term store lookup result", true);
+  }
+  // terms of different program versions must not overwrite each other
+  store.insert(id, 2, 100, 8, 4);
+  store.open(folder);
+  if (!store.lookup(id, 1, 100, value, steps) || value != 7 ||
+      !store.lookup(id, 2, 100, value, steps) || value != 8) {
+    Log::get().error("Unexpected term store lookup after reopening", true);
+  }
+  // outdated files must be deleted only if there is a newer file
+  store.close();
+  const auto old_time = std::filesystem::file_time_type::clock::now() -
+                        std::chrono::hours(24 * 30);
+  const UID other_id('A', 46);
+  const std::string outdated = folder + id.string() + "_outdated.bin";
+  const std::string single = folder + other_id.string() + "_single.bin";
+  for (const auto& path : {outdated, single}) {
+    std::ofstream(path).close();
+    std::filesystem::last_write_time(path, old_time);
+  }
+  store.open(folder);
+  if (isFile(outdated) || !isFile(single) ||
+      !store.lookup(id, 1, 100, value, steps) || value != 7) {
+    Log::get().error("Unexpected term store files after pruning", true);
+  }
+  store.close();
+  rmDirRecursive(folder);
+}
+
 bool Test::checkEvaluator(const Settings& settings, size_t id, std::string path,
                           eval_mode_t evalMode, bool mustSupportEvalMode) {
   auto name = path;
@@ -937,6 +1725,8 @@ bool Test::checkEvaluator(const Settings& settings, size_t id, std::string path,
     msg = "incremental " + msg;
   } else if (evalMode == EVAL_VIRTUAL) {
     msg = "virtual " + msg;
+  } else if (evalMode == EVAL_MATRIX) {
+    msg = "matrix " + msg;
   } else {
     Log::get().error("Unknown eval mode", true);
   }
@@ -1252,6 +2042,60 @@ void Test::formula() {
   checkFormulas("pari-function.txt", FormulaType::PARI_FUNCTION);
   checkFormulas("pari-vector.txt", FormulaType::PARI_VECTOR);
   checkFormulas("lean.txt", FormulaType::LEAN);
+  checkFormulas("formula.txt", FormulaType::NATIVE);
+
+  // mutually recursive functions are evaluated bottom-up
+  Log::get().info("Testing bottom-up formula evaluation");
+  Formula f;
+  FormulaParser parser;
+  if (!parser.parse("a(n) = (b(n-1)+2*a(n-2))%1000, a(1) = 1, a(0) = 0, "
+                    "b(n) = (a(n-1)+b(n-1)+b(n-2))%1000, b(1) = 1, b(0) = 1",
+                    f)) {
+    Log::get().error("Cannot parse formula", true);
+  }
+  NativeFormula native;
+  NativeFormula::convert(f, native);
+  Sequence all, tail;
+  if (!native.evalNative(0, 5000, 10, all) ||
+      !native.evalNative(4990, 10, 10, tail)) {
+    Log::get().error("Native evaluation timeout", true);
+  }
+  if (all.subsequence(4990, 10) != tail) {
+    Log::get().error("Unexpected bottom-up evaluation: " + tail.to_string(),
+                     true);
+  }
+  PariFormula pari;
+  PariFormula::convert(f, 0, false, pari);
+  const std::string expected_code =
+      "a_m = Map()\n"
+      "a_f(n) = if(n==1,1,if(n==0,0,(b(n-1)+2*a(n-2))%1000))\n"
+      "a(n) = my(r); if(!mapisdefined(a_m,n,&r),r=a_f(n); mapput(a_m,n,r)); "
+      "r\n"
+      "b_m = Map()\n"
+      "b_f(n) = if(n==1,1,if(n==0,1,(a(n-1)+b(n-1)+b(n-2))%1000))\n"
+      "b(n) = my(r); if(!mapisdefined(b_m,n,&r),r=b_f(n); mapput(b_m,n,r)); "
+      "r\n"
+      "for(n=0,9,print(a(n)))\n"
+      "quit\n";
+  if (pari.printEvalCode(0, 10) != expected_code) {
+    Log::get().error("Unexpected PARI/GP code:\n" + pari.printEvalCode(0, 10),
+                     true);
+  }
+  // run the generated code if PARI/GP is available
+  if (std::getenv("LODA_TEST_WITH_EXTERNAL_TOOLS")) {
+    Sequence gp_seq;
+    if (!pari.evalWithGP(0, 100, 60, gp_seq) ||
+        gp_seq != all.subsequence(0, 100)) {
+      Log::get().error("Unexpected PARI/GP result: " + gp_seq.to_string(),
+                       true);
+    }
+  }
+  // supported PARI/GP formulas are evaluated in process
+  Sequence pari_seq;
+  if (!pari.eval(0, 10, 10, pari_seq) || pari_seq != all.subsequence(0, 10)) {
+    Log::get().error("Unexpected PARI/GP evaluation: " + pari_seq.to_string(),
+                     true);
+  }
 }
 
 void Test::checkFormulas(const std::string& testFile, FormulaType type) {
@@ -1264,6 +2108,8 @@ void Test::checkFormulas(const std::string& testFile, FormulaType type) {
   }
   Parser parser;
   FormulaGenerator generator;
+  Evaluator evaluator(settings, EVAL_ALL, false);
+  size_t num_native = 0;
   for (const auto& e : map) {
     auto id = e.first;
     Log::get().info("Testing formula for " + id.string() + ": " + e.second);
@@ -1296,6 +2142,33 @@ void Test::checkFormulas(const std::string& testFile, FormulaType type) {
       if (lean.toString() != e.second) {
         Log::get().error("Unexpected LEAN code: " + lean.toString(), true);
       }
+    } else if (type == FormulaType::NATIVE) {
+      NativeFormula native;
+      NativeFormula::convert(f, native);
+      if (!native.isSupported()) {
+        continue;
+      }
+      Sequence expSeq, genSeq;
+      try {
+        evaluator.eval(p, expSeq, 10);
+      } catch (const std::exception&) {
+        continue;
+      }
+      try {
+        if (!native.evalNative(offset, expSeq.size(), 10, genSeq)) {
+          Log::get().error("Native evaluation timeout", true);
+        }
+      } catch (const std::exception& e) {
+        // evaluated using PARI/GP
+        Log::get().info(e.what());
+        continue;
+      }
+      if (genSeq != expSeq) {
+        Log::get().info("Generated sequence: " + genSeq.to_string());
+        Log::get().info("Expected sequence:  " + expSeq.to_string());
+        Log::get().error("Unexpected native sequence", true);
+      }
+      num_native++;
     } else {
       PariFormula pari;
       if (!PariFormula::convert(f, offset, type == FormulaType::PARI_VECTOR,
@@ -1307,6 +2180,23 @@ void Test::checkFormulas(const std::string& testFile, FormulaType type) {
       }
     }
   }
+  if (type == FormulaType::NATIVE && 2 * num_native < map.size()) {
+    Log::get().error("Unexpected number of native formula checks: " +
+                         std::to_string(num_native),
+                     true);
+  }
+}
+
+// Evaluate the generated code using the external tool.
+template <typename FormulaTypeClass>
+bool evalWithExternalTool(const FormulaTypeClass& formula, int64_t offset,
+                          int64_t numTerms, Sequence& result) {
+  return formula.eval(offset, numTerms, 60, result);
+}
+
+bool evalWithExternalTool(const PariFormula& formula, int64_t offset,
+                          int64_t numTerms, Sequence& result) {
+  return formula.evalWithGP(offset, numTerms, 60, result);
 }
 
 template <typename FormulaTypeClass>
@@ -1348,7 +2238,7 @@ void Test::checkFormulasWithExternalTools(const std::string& testFile,
     }
     // evaluate formula
     Sequence genSeq;
-    if (!formula_obj.eval(offset, numTerms, 60, genSeq)) {
+    if (!evalWithExternalTool(formula_obj, offset, numTerms, genSeq)) {
       Log::get().error(
           formula_obj.getName() + " evaluation timeout for " + idStr, true);
     }
@@ -1428,6 +2318,80 @@ void Test::virtualSeq() {
   }
 }
 
+void Test::statsMerge() {
+  Log::get().info("Testing stats merging");
+  const auto home = Setup::getProgramsHome();
+  std::vector<UID> ids;
+  for (const auto& dir : std::filesystem::directory_iterator(home + "oeis")) {
+    if (!dir.is_directory()) {
+      continue;
+    }
+    for (const auto& f : std::filesystem::directory_iterator(dir)) {
+      const auto name = f.path().stem().string();
+      if (f.path().extension() == ".asm" && UID::valid(name)) {
+        ids.push_back(UID(name));
+      }
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.push_back(UID('A', 999999));  // sequence without program
+
+  // update serial and sharded stats
+  Parser parser;
+  Stats serial;
+  std::vector<Stats> shards(3);
+  for (size_t i = 0; i < ids.size(); i++) {
+    auto& shard = shards[i * shards.size() / ids.size()];
+    for (auto s : {&serial, &shard}) {
+      const auto path = ProgramUtil::getProgramPath(ids[i]);
+      if (!isFile(path)) {
+        s->updateSequenceStats(ids[i], false, false);
+        continue;
+      }
+      auto program = parser.parse(path);
+      const auto formula =
+          Comments::getCommentField(program, Comments::PREFIX_FORMULA);
+      const auto submitter = Comments::getSubmitter(program);
+      const auto offset = ProgramUtil::getOffset(program);
+      ProgramUtil::removeOps(program, Operation::Type::NOP);
+      s->updateProgramStats(ids[i], program, submitter, formula, offset);
+      s->updateSequenceStats(ids[i], true, !formula.empty());
+    }
+  }
+  Stats merged;
+  for (auto& shard : shards) {
+    merged.merge(shard);
+  }
+
+  // the saved files must be identical
+  const std::string dir1 = getTmpDir() + "stats_serial" + FILE_SEP;
+  const std::string dir2 = getTmpDir() + "stats_merged" + FILE_SEP;
+  for (auto e : {std::make_pair(&serial, dir1), std::make_pair(&merged, dir2)}) {
+    rmDirRecursive(e.second);
+    ensureDir(e.second);
+    e.first->latest_program_ids.insert(ids.front());
+    e.first->finalize();
+    e.first->save(e.second);
+  }
+  size_t num_files = 0;
+  for (const auto& f : std::filesystem::directory_iterator(dir1)) {
+    const auto name = f.path().filename().string();
+    std::ifstream in1(dir1 + name), in2(dir2 + name);
+    std::stringstream buf1, buf2;
+    buf1 << in1.rdbuf();
+    buf2 << in2.rdbuf();
+    if (!in2 || buf1.str() != buf2.str()) {
+      Log::get().error("Unexpected merged stats file: " + name, true);
+    }
+    num_files++;
+  }
+  if (num_files < 10) {
+    Log::get().error("Unexpected number of stats files", true);
+  }
+  rmDirRecursive(dir1);
+  rmDirRecursive(dir2);
+}
+
 void Test::stats() {
   Log::get().info("Testing stats loading and saving");
 
@@ -1667,6 +2631,13 @@ void Test::miner() {
 
 void Test::linearMatcher() {
   LinearMatcher matcher(false);
+  const CompactSequence seq(Sequence({1, 2, 3, 4, 5}));
+  matcher.insert(seq, UID('A', 27));
+  if (!matcher.mayMatch(CompactSequence(Sequence({5, 7, 9}))) ||
+      matcher.mayMatch(CompactSequence(Sequence({1, 4, 5})))) {
+    Log::get().error("Unexpected prefix filter result", true);
+  }
+  matcher.remove(seq, UID('A', 27));
   testMatcherSet(matcher, {27, 5843, 8585, 16789});
   testMatcherSet(matcher, {290, 1105, 117950});
 }
@@ -1689,6 +2660,240 @@ void Test::digitMatcher() {
   // testMatcherPair( decimal, 11557, 7 );
 }
 
+void Test::referenceCache() {
+  Log::get().info("Testing reference cache");
+  const std::string folder = getTmpDir() + "loda_references_test" + FILE_SEP;
+  rmDirRecursive(folder);
+  ReferenceCache cache(folder);
+  const UID id('A', 45);
+  Sequence seq({0, 1, 1, 2, 3, 5, -8});
+  seq.push_back(Number("123456789012345678901234567890"));
+  steps_t steps;
+  steps.add(10);
+  steps.add(20);
+  Sequence s;
+  steps_t t;
+  if (cache.lookup(id, 42, s, t)) {
+    Log::get().error("Unexpected reference cache hit", true);
+  }
+  cache.insert(id, 42, seq, steps);
+  if (!cache.lookup(id, 42, s, t) || s != seq || t.total != steps.total ||
+      t.min != steps.min || t.max != steps.max || t.runs != steps.runs) {
+    Log::get().error("Unexpected reference cache entry: " + s.to_string(),
+                     true);
+  }
+  if (cache.lookup(id, 43, s, t)) {
+    Log::get().error("Unexpected reference cache hit for outdated key", true);
+  }
+  cache.remove(id);
+  if (cache.lookup(id, 42, s, t)) {
+    Log::get().error("Unexpected reference cache hit after removal", true);
+  }
+  rmDirRecursive(folder);
+}
+
+void Test::seenProgramFilter() {
+  Log::get().info("Testing seen-program filter");
+  Parser parser;
+  auto parse = [&](const std::string& code) {
+    std::stringstream buf(code);
+    return parser.parse(buf);
+  };
+  SeenProgramFilter filter(10);
+  auto p = parse("mov $1,$0\nadd $1,3\nmul $0,$1\n");
+  if (filter.checkAndInsert(p)) {
+    Log::get().error("Unexpected seen program", true);
+  }
+  // nops and comments are ignored
+  auto q = parse("mov $1,$0 ; copy\nadd $1,3\nmul $0,$1\n; done\n");
+  if (!filter.checkAndInsert(q)) {
+    Log::get().error("Expected seen program", true);
+  }
+  // programs with swapped operands are different
+  for (const auto& code : {"mov $3,$0\nadd $3,1\nmul $0,$3\n",
+                           "mov $1,$0\nadd $1,1\nmul $0,$1\n",
+                           "mov $1,$0\nmul $0,$1\nadd $1,3\n"}) {
+    if (filter.checkAndInsert(parse(code))) {
+      Log::get().error("Unexpected seen program: " + std::string(code), true);
+    }
+  }
+  // old programs are forgotten after two generations
+  for (int64_t i = 0; i < 20; i++) {
+    Program r;
+    r.push_back(Operation::Type::ADD, Operand::Type::DIRECT, 0,
+                Operand::Type::CONSTANT, i + 100);
+    if (filter.checkAndInsert(r)) {
+      Log::get().error("Unexpected seen program", true);
+    }
+  }
+  if (filter.checkAndInsert(p)) {
+    Log::get().error("Expected forgotten program", true);
+  }
+}
+
+void Test::checkerComparison() {
+  Log::get().info("Testing checker comparison");
+  const std::vector<std::string> codes = {
+      "mov $1,$0\nmov $2,0\nlpb $1\n  sub $1,1\n  add $2,$0\nlpe\nmov $0,$2\n",
+      "mov $1,$0\nmov $2,0\nlpb $1\n  sub $1,1\n  add $2,$0\n  add $3,1\nlpe\n"
+      "mov $0,$2\n",
+      "pow $0,2\n", "mul $0,$0\n", "mul $0,3\n"};
+  Parser parser;
+  std::vector<Program> programs;
+  for (const auto& code : codes) {
+    std::stringstream buf(code);
+    programs.push_back(parser.parse(buf));
+  }
+  Sequence terms;
+  for (int64_t n = 0; n < 1000; n++) {
+    terms.push_back(Number(n * n));
+  }
+  ManagedSequence seq(UID('A', 290), "The squares", terms);
+  Evaluator evaluator(settings, EVAL_REGULAR, false);
+  Minimizer minimizer(settings);
+  InvalidMatches invalid_matches;
+  const std::string folder = getTmpDir() + "loda_checker_test" + FILE_SEP;
+  rmDirRecursive(folder);
+  Checker checker(settings, evaluator, minimizer, invalid_matches,
+                  ReferenceCache(folder));
+  for (size_t i = 0; i < programs.size(); i++) {
+    for (size_t j = 0; j < programs.size(); j++) {
+      if (i == j) {
+        continue;
+      }
+      // the streaming comparison must yield the same result
+      checker.setStreamingComparison(false);
+      auto expected = checker.isOptimizedBetter(programs[i], programs[j], seq,
+                                                false, 100);
+      checker.setStreamingComparison(true);
+      auto result = checker.isOptimizedBetter(programs[i], programs[j], seq,
+                                              false, 100);
+      if (result != expected) {
+        Log::get().error("Unexpected comparison result for programs " +
+                             std::to_string(i) + " and " + std::to_string(j) +
+                             ": " + result + "; expected " + expected,
+                         true);
+      }
+    }
+  }
+  if (checker.isOptimizedBetter(programs[0], programs[2], seq, false, 100) !=
+          "Faster" ||
+      !checker.isOptimizedBetter(programs[0], programs[1], seq, false, 100)
+           .empty() ||
+      !checker.isOptimizedBetter(programs[0], programs[4], seq, false, 100)
+           .empty()) {
+    Log::get().error("Unexpected checker comparison result", true);
+  }
+  rmDirRecursive(folder);
+}
+
+void Test::validationPipeline() {
+  Log::get().info("Testing validation pipeline");
+
+  // submissions are taken in order although they are validated out of order
+  ValidatedQueue queue;
+  std::vector<int64_t> taken;
+  std::vector<size_t> num_taken;
+  for (int64_t index : {2, 0, 3, 1}) {
+    std::vector<validated_program_t> validated(1);
+    validated[0].id = UID('A', index + 1);
+    queue.push(index, std::move(validated));
+    while (queue.pop(validated)) {
+      taken.push_back(validated[0].id.number() - 1);
+    }
+    num_taken.push_back(taken.size());
+  }
+  if (taken != std::vector<int64_t>({0, 1, 2, 3}) ||
+      num_taken != std::vector<size_t>({0, 1, 1, 4}) || queue.size() != 0 ||
+      queue.getNumTaken() != 4) {
+    Log::get().error("Unexpected order of validated submissions", true);
+  }
+
+  // programs are validated again if the existing program has changed
+  const std::string programs_home = Setup::getProgramsHome();
+  const std::string folder = getTmpDir() + "loda_commit_test" + FILE_SEP;
+  rmDirRecursive(folder);
+  ensureDir(folder + "local" + FILE_SEP);
+  Setup::setProgramsHome(folder);
+  const UID id('A', 45);
+  Parser parser;
+  std::stringstream existing_buf("mul $0,2\n");
+  std::stringstream submitted_buf("add $0,$0\n");
+  std::stringstream changed_buf("mov $1,$0\nadd $0,$1\n");
+  validated_program_t validated;
+  validated.id = id;
+  validated.is_new = false;
+  validated.existing = parser.parse(existing_buf);
+  validated.program = parser.parse(submitted_buf);
+  const auto changed = parser.parse(changed_buf);
+  std::ofstream(ProgramUtil::getProgramPath(id, true)) << changed_buf.str();
+  // the sequences are not loaded, so only the validation rejects the program
+  auto& manager = getManager();
+  auto result = manager.commitProgram(validated, ValidationMode::BASIC);
+  if (result.updated || manager.getExistingProgram(id) != changed) {
+    Log::get().error("Program committed without validating it again", true);
+  }
+  Setup::setProgramsHome(programs_home);
+  rmDirRecursive(folder);
+}
+
+void Test::fingerprintIndex() {
+  Log::get().info("Testing fingerprint index");
+  FingerprintIndex index;
+  std::vector<CompactSequence> seqs;
+  for (int64_t i = 0; i < 1000; i++) {
+    Sequence s({i, -i, i * i, 0, std::numeric_limits<int64_t>::min()});
+    if (i % 100 == 0) {
+      Number big("123456789012345678901234567890");
+      big += Number(i);
+      s.push_back(big);
+    }
+    seqs.emplace_back(s);
+    index.insert(seqs.back(), UID('A', i + 1));
+  }
+  index.insert(seqs[5], UID('A', 5000));  // duplicate sequence
+  std::vector<UID> found;
+  auto check = [&](size_t i, std::vector<UID> expected) {
+    found.clear();
+    bool result = index.find(seqs[i], found);
+    std::sort(found.begin(), found.end());
+    if (result != !expected.empty() || found != expected) {
+      Log::get().error("Unexpected fingerprint index result for " +
+                           seqs[i].toSequence().to_string(),
+                       true);
+    }
+  };
+  for (size_t i = 0; i < seqs.size(); i++) {
+    if (i != 5) {
+      check(i, {UID('A', i + 1)});
+    }
+  }
+  check(5, {UID('A', 6), UID('A', 5000)});
+  index.remove(seqs[5], UID('A', 6));
+  check(5, {UID('A', 5000)});
+  index.remove(seqs[5], UID('A', 5000));
+  index.remove(seqs[100], UID('A', 101));
+  check(5, {});
+  check(100, {});
+  index.insert(seqs[100], UID('A', 7000));
+  check(100, {UID('A', 7000)});
+  // duplicate IDs must be returned in insertion order
+  index.insert(seqs[7], UID('A', 3000));
+  index.insert(seqs[7], UID('A', 2000));
+  found.clear();
+  index.find(seqs[7], found);
+  const std::vector<UID> expected = {UID('A', 8), UID('A', 3000),
+                                     UID('A', 2000)};
+  if (found != expected) {
+    Log::get().error("Unexpected order of fingerprint index result", true);
+  }
+  found.clear();
+  CompactSequence other(Sequence({1, 2, 3}));
+  if (index.find(other, found) || index.size() != 999) {
+    Log::get().error("Unexpected fingerprint index size", true);
+  }
+}
+
 void Test::testBinary(const std::string& func, const std::string& file,
                       const std::vector<std::vector<int64_t>>& values) {
   Log::get().info("Testing " + file);
@@ -1792,10 +2997,15 @@ void Test::testMatcherPair(Matcher& matcher, size_t id1, size_t id2) {
   Sequence s1, s2, s3;
   eval(p1, evaluator, s1);
   eval(p2, evaluator, s2);
-  matcher.insert(s2, uid2);
+  matcher.insert(CompactSequence(s2), uid2);
+  CompactSequence prefix(s1.subsequence(0, Matcher::PREFIX_LENGTH));
+  if (!matcher.mayMatch(prefix)) {
+    Log::get().error(matcher.getName() + " matcher rejected matching prefix",
+                     true);
+  }
   Matcher::seq_programs_t result;
-  matcher.match(p1, s1, result);
-  matcher.remove(s2, uid2);
+  matcher.match(p1, CompactSequence(s1), result);
+  matcher.remove(CompactSequence(s2), uid2);
   if (result.size() != 1) {
     Log::get().error(matcher.getName() + " matcher unable to match sequence",
                      true);
@@ -26,12 +26,20 @@ class Test {
 
   void sequence();
 
+  void compactSequence();
+
+  void sequenceSnapshot();
+
+  void bfileCache();
+
   void memory();
 
   void operationMetadata();
 
   void programUtil();
 
+  void programArchive();
+
   void iterator(size_t tests);
 
   void knownPrograms();
@@ -44,6 +52,18 @@ class Test {
 
   void virtualEval();
 
+  void matrixEval();
+
+  void bytecode();
+
+  void int64Interpreter();
+
+  void batchEval();
+
+  void parallelEval();
+
+  void termStore();
+
   static bool checkEvaluator(const Settings& settings, size_t id,
                              std::string path, eval_mode_t evalMode,
                              bool mustSupportEvalMode);
@@ -76,6 +96,18 @@ class Test {
 
   void digitMatcher();
 
+  void fingerprintIndex();
+
+  void referenceCache();
+
+  void seenProgramFilter();
+
+  void checkerComparison();
+
+  void validationPipeline();
+
+  void statsMerge();
+
   void stats();
 
   void config();
@@ -92,7 +124,7 @@ class Test {
 
   void virtualSeq();
 
-  enum class FormulaType { FORMULA, PARI_FUNCTION, PARI_VECTOR, LEAN };
+  enum class FormulaType { FORMULA, PARI_FUNCTION, PARI_VECTOR, LEAN, NATIVE };
 
   void checkFormulas(const std::string& testFile, FormulaType type);
 
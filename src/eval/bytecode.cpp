@@ -0,0 +1,106 @@
+#include "eval/bytecode.hpp"
+
+#include <stack>
+
+#include "lang/program_util.hpp"
+
+bool compileOperand(const Operand &o, Bytecode &bc, int64_t &arg) {
+  if (o.type == Operand::Type::CONSTANT) {
+    arg = bc.constants.size();
+    bc.constants.push_back(o.value);
+    return true;
+  }
+  if (!o.value.fitsInInt64()) {
+    return false;
+  }
+  arg = o.value.asInt();
+  return true;
+}
+
+Bytecode::Opcode arithOpcode(const Operation &op) {
+  if (op.target.type != Operand::Type::DIRECT) {
+    return Bytecode::Opcode::ARITH;
+  }
+  const bool dc = (op.source.type == Operand::Type::CONSTANT);
+  const bool dd = (op.source.type == Operand::Type::DIRECT);
+  if (!dc && !dd) {
+    return Bytecode::Opcode::ARITH;
+  }
+  switch (op.type) {
+    case Operation::Type::MOV:
+      return dc ? Bytecode::Opcode::MOV_DC : Bytecode::Opcode::MOV_DD;
+#define BYTECODE_ARITH_CASE(T, f) \
+  case Operation::Type::T:        \
+    return dc ? Bytecode::Opcode::T##_DC : Bytecode::Opcode::T##_DD;
+      BYTECODE_ARITH_OPS(BYTECODE_ARITH_CASE)
+#undef BYTECODE_ARITH_CASE
+    default:
+      return Bytecode::Opcode::ARITH;
+  }
+}
+
+bool Bytecode::compile(const Program &p, Bytecode &bc) {
+  bc = Bytecode();
+  std::stack<size_t> loops;
+  bc.has_region_ops = ProgramUtil::hasRegionOperation(p);
+  for (const auto &op : p.ops) {
+    if (op.type == Operation::Type::NOP) {
+      continue;
+    }
+    Instruction ins;
+    ins.type = op.type;
+    ins.target_type = op.target.type;
+    ins.source_type = op.source.type;
+    ins.target = 0;
+    ins.source = 0;
+    ins.jump = 0;
+    if (!compileOperand(op.target, bc, ins.target) ||
+        !compileOperand(op.source, bc, ins.source)) {
+      return false;
+    }
+    switch (op.type) {
+      case Operation::Type::LPB:
+        ins.opcode = Opcode::LPB;
+        loops.push(bc.code.size());
+        if (op.source != Operand(Operand::Type::CONSTANT, Number::ONE)) {
+          bc.needs_fragments = true;
+        }
+        break;
+      case Operation::Type::LPE:
+        if (loops.empty()) {
+          return false;
+        }
+        ins.opcode = Opcode::LPE;
+        ins.jump = loops.top();
+        loops.pop();
+        break;
+      case Operation::Type::CLR:
+        ins.opcode = Opcode::CLR;
+        break;
+      case Operation::Type::FIL:
+        ins.opcode = Opcode::FIL;
+        break;
+      case Operation::Type::ROL:
+        ins.opcode = Opcode::ROL;
+        break;
+      case Operation::Type::ROR:
+        ins.opcode = Opcode::ROR;
+        break;
+      case Operation::Type::SEQ:
+        ins.opcode = Opcode::SEQ;
+        break;
+      case Operation::Type::PRG:
+        ins.opcode = Opcode::PRG;
+        break;
+      case Operation::Type::DBG:
+        ins.opcode = Opcode::DBG;
+        break;
+      default:
+        ins.opcode = arithOpcode(op);
+        break;
+    }
+    bc.code.push_back(ins);
+    bc.ops.push_back(op);
+  }
+  return loops.empty();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "lang/program.hpp"
+
+// Arithmetic operations that have specialized opcodes in the bytecode. The
+// first argument is the operation type, the second one the function name in
+// the Semantics class.
+#define BYTECODE_ARITH_OPS(X) \
+  X(ADD, add)                 \
+  X(SUB, sub)                 \
+  X(TRN, trn)                 \
+  X(MUL, mul)                 \
+  X(DIV, div)                 \
+  X(DIF, dif)                 \
+  X(DIR, dir)                 \
+  X(MOD, mod)                 \
+  X(POW, pow)                 \
+  X(GCD, gcd)                 \
+  X(LEX, lex)                 \
+  X(BIN, bin)                 \
+  X(FAC, fac)                 \
+  X(LOG, log)                 \
+  X(NRT, nrt)                 \
+  X(DGS, dgs)                 \
+  X(DGR, dgr)                 \
+  X(EQU, equ)                 \
+  X(NEQ, neq)                 \
+  X(LEQ, leq)                 \
+  X(GEQ, geq)                 \
+  X(MIN, min)                 \
+  X(MAX, max)                 \
+  X(BAN, ban)                 \
+  X(BOR, bor)                 \
+  X(BXO, bxo)
+
+// Pre-decoded representation of a program for fast execution in the
+// interpreter. Operand values are resolved to plain cell indices or indices
+// into a constant pool, nops are removed and loop jump targets are
+// precomputed. The original operations are kept for error messages.
+class Bytecode {
+ public:
+  // Opcodes with the operand kinds folded in: the suffix _DC stands for a
+  // direct target and a constant source, _DD for a direct target and a direct
+  // source. All other operand combinations use the generic ARITH opcode.
+#define BYTECODE_ARITH_ENUM(T, f) T##_DC, T##_DD,
+  enum class Opcode : uint8_t {
+    MOV_DC,
+    MOV_DD,
+    BYTECODE_ARITH_OPS(BYTECODE_ARITH_ENUM) ARITH,
+    LPB,
+    LPE,
+    CLR,
+    FIL,
+    ROL,
+    ROR,
+    SEQ,
+    PRG,
+    DBG,
+    __COUNT
+  };
+#undef BYTECODE_ARITH_ENUM
+
+  class Instruction {
+   public:
+    Opcode opcode;
+    Operation::Type type;
+    Operand::Type target_type;
+    Operand::Type source_type;
+    int64_t target;  // cell index or constant pool index
+    int64_t source;  // cell index or constant pool index
+    size_t jump;     // for lpe: index of the matching lpb
+  };
+
+  // Compile a program to bytecode. Returns false if the program cannot be
+  // represented, e.g. because of unbalanced loops or cell indices that do not
+  // fit into 64 bits. Such programs must be run using the program interpreter.
+  static bool compile(const Program &p, Bytecode &bc);
+
+  std::vector<Instruction> code;
+  std::vector<Operation> ops;
+  std::vector<Number> constants;
+  bool needs_fragments = false;
+  bool has_region_ops = false;
+};
@@ -1,7 +1,11 @@
 #include "eval/evaluator.hpp"
 
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
+#include "eval/term_store.hpp"
 #include "lang/program_util.hpp"
 #include "sys/log.hpp"
 
@@ -25,16 +29,27 @@ Evaluator::Evaluator(const Settings &settings, eval_mode_t eval_modes,
                      bool check_range)
     : settings(settings),
       interpreter(settings),
+      int64_interpreter(settings),
+      batch_evaluator(settings),
       inc_evaluator(interpreter),
       vir_evaluator(settings),
+      mat_evaluator(settings),
       use_inc_eval(eval_modes & EVAL_INCREMENTAL),
       use_vir_eval(eval_modes & EVAL_VIRTUAL),
+      use_mat_eval(eval_modes & EVAL_MATRIX),
       check_range(check_range),
       check_eval_time(settings.max_eval_secs >= 0),
-      is_debug(Log::get().level == Log::Level::DEBUG) {}
+      is_debug(Log::get().level == Log::Level::DEBUG),
+      num_deopts(0) {}
 
 steps_t Evaluator::eval(const Program &p, Sequence &seq, int64_t num_terms,
                         const bool throw_on_error) {
+  return eval(p, seq, num_terms, throw_on_error, nullptr);
+}
+
+steps_t Evaluator::eval(const Program &p, Sequence &seq, int64_t num_terms,
+                        const bool throw_on_error,
+                        const term_callback_t &on_term) {
   if (num_terms < 0) {
     num_terms = settings.num_terms;
   }
@@ -42,11 +57,22 @@ steps_t Evaluator::eval(const Program &p, Sequence &seq, int64_t num_terms,
   if (check_eval_time) {
     start_time = std::chrono::steady_clock::now();
   }
+  num_deopts = 0;
   Memory mem;
   steps_t steps;
   size_t s;
   const bool use_inc = use_inc_eval && inc_evaluator.init(p);
-  const bool use_vir = !use_inc && use_vir_eval && vir_evaluator.init(p);
+  const bool use_mat = !use_inc && use_mat_eval && mat_evaluator.init(p);
+  const bool use_vir =
+      !use_inc && !use_mat && use_vir_eval && vir_evaluator.init(p);
+  if (!use_inc && !use_mat && !use_vir && settings.num_eval_threads > 1 &&
+      num_terms > 1) {
+    // the terms are independent in the regular mode
+    return evalParallel(p, seq, num_terms, throw_on_error, on_term);
+  }
+  const bool use_bc =
+      !use_inc && !use_mat && !use_vir && interpreter.compile(p, bytecode);
+  const bool use_int64 = use_bc && int64_interpreter.init(bytecode);
   std::pair<Number, size_t> tmp_result;
   const int64_t offset = ProgramUtil::getOffset(p);
   for (int64_t i = 0; i < num_terms; i++) {
@@ -56,6 +82,10 @@ steps_t Evaluator::eval(const Program &p, Sequence &seq, int64_t num_terms,
         tmp_result = inc_evaluator.next();
         seq[i] = tmp_result.first;
         s = tmp_result.second;
+      } else if (use_mat) {
+        tmp_result = mat_evaluator.eval(index);
+        seq[i] = tmp_result.first;
+        s = tmp_result.second;
       } else if (use_vir) {
         tmp_result = vir_evaluator.eval(index);
         seq[i] = tmp_result.first;
@@ -63,7 +93,11 @@ steps_t Evaluator::eval(const Program &p, Sequence &seq, int64_t num_terms,
       } else {
         mem.clear();
         mem.set(Program::INPUT_CELL, index);
-        s = interpreter.run(p, mem);
+        if (!use_int64 || !int64_interpreter.run(mem, s)) {
+          num_deopts += use_int64;
+          s = use_bc ? interpreter.run(bytecode, mem)
+                     : interpreter.run(p, mem);
+        }
         seq[i] = mem.get(Program::OUTPUT_CELL);
       }
       if (check_eval_time) {
@@ -84,17 +118,165 @@ steps_t Evaluator::eval(const Program &p, Sequence &seq, int64_t num_terms,
     if (settings.print_as_b_file) {
       std::cout << index << " " << seq[i] << std::endl;
     }
+    if (on_term && !on_term(i, seq[i], steps)) {
+      seq.resize(i + 1);
+      return steps;
+    }
+  }
+  if (is_debug) {
+    std::stringstream buf;
+    buf << "Evaluated program to sequence " << seq;
+    if (num_deopts > 0) {
+      buf << " (" << num_deopts << " deoptimized terms)";
+    }
+    Log::get().debug(buf.str());
+  }
+  return steps;
+}
+
+steps_t Evaluator::evalParallel(const Program &p, Sequence &seq,
+                                int64_t num_terms, const bool throw_on_error,
+                                const term_callback_t &on_term) {
+  class Slot {
+   public:
+    Number value;
+    size_t steps = 0;
+    std::exception_ptr error;
+    bool done = false;
+  };
+  std::vector<Slot> slots(num_terms);
+  std::mutex mutex;
+  std::condition_variable cond;
+  const int64_t num_threads =
+      std::min<int64_t>(settings.num_eval_threads, num_terms);
+  // maximum number of evaluated terms that are not passed to the output yet
+  const int64_t window = 64 * num_threads;
+  const int64_t offset = ProgramUtil::getOffset(p);
+  int64_t next = 0;           // next index to evaluate
+  int64_t streamed = 0;       // number of terms passed to the output
+  int64_t limit = num_terms;  // terms from this index on are not needed
+
+  auto worker = [&]() {
+    Interpreter worker_interpreter(settings);
+    Int64Interpreter worker_int64_interpreter(settings);
+    Bytecode worker_bytecode;
+    const bool use_bc = worker_interpreter.compile(p, worker_bytecode);
+    const bool use_int64 =
+        use_bc && worker_int64_interpreter.init(worker_bytecode);
+    size_t worker_deopts = 0;
+    Memory mem;
+    while (true) {
+      int64_t i;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock,
+                  [&] { return next >= limit || next < streamed + window; });
+        if (next >= limit) {
+          num_deopts += worker_deopts;
+          return;
+        }
+        i = next++;
+      }
+      Slot result;
+      try {
+        mem.clear();
+        mem.set(Program::INPUT_CELL, i + offset);
+        if (!use_int64 || !worker_int64_interpreter.run(mem, result.steps)) {
+          worker_deopts += use_int64;
+          result.steps = use_bc ? worker_interpreter.run(worker_bytecode, mem)
+                                : worker_interpreter.run(p, mem);
+        }
+        result.value = mem.get(Program::OUTPUT_CELL);
+      } catch (const std::exception &) {
+        result.error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result.error) {
+          // stop at the first error
+          limit = std::min(limit, i + 1);
+        }
+        slots[i] = std::move(result);
+        slots[i].done = true;
+      }
+      cond.notify_all();
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < num_threads; t++) {
+    threads.emplace_back(worker);
+  }
+
+  // pass the terms to the output in order
+  steps_t steps;
+  std::exception_ptr error;
+  bool stopped = false;
+  int64_t i = 0;
+  for (; i < num_terms; i++) {
+    Slot slot;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&] { return slots[i].done; });
+      slot = std::move(slots[i]);
+      streamed = i + 1;
+    }
+    cond.notify_all();
+    if (!slot.error && check_eval_time) {
+      try {
+        checkEvalTime();
+      } catch (const std::exception &) {
+        slot.error = std::current_exception();
+      }
+    }
+    if (slot.error) {
+      error = slot.error;
+      break;
+    }
+    seq[i] = slot.value;
+    steps.add(slot.steps);
+    if (settings.use_steps) {
+      seq[i] = slot.steps;
+    }
+    if (settings.print_as_b_file) {
+      std::cout << i + offset << " " << seq[i] << std::endl;
+    }
+    if (on_term && !on_term(i, seq[i], steps)) {
+      stopped = true;
+      break;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = 0;
+  }
+  cond.notify_all();
+  for (auto &t : threads) {
+    t.join();
+  }
+  if (error) {
+    seq.resize(i);
+    if (throw_on_error) {
+      std::rethrow_exception(error);
+    }
+    return steps;
+  }
+  if (stopped) {
+    seq.resize(i + 1);
+    return steps;
   }
   if (is_debug) {
     std::stringstream buf;
     buf << "Evaluated program to sequence " << seq;
+    if (num_deopts > 0) {
+      buf << " (" << num_deopts << " deoptimized terms)";
+    }
     Log::get().debug(buf.str());
   }
   return steps;
 }
 
 steps_t Evaluator::eval(const Program &p, std::vector<Sequence> &seqs,
-                        int64_t num_terms) {
+                        int64_t num_terms, int64_t first_term) {
   if (num_terms < 0) {
     num_terms = settings.num_terms;
   }
@@ -107,11 +289,26 @@ steps_t Evaluator::eval(const Program &p, std::vector<Sequence> &seqs,
   Memory mem;
   steps_t steps;
   // note: we can't use the incremental evaluator here
+  const bool use_bc = interpreter.compile(p, bytecode);
   const int64_t offset = ProgramUtil::getOffset(p);
-  for (int64_t i = 0; i < num_terms; i++) {
+  // try to evaluate all terms in one pass
+  if (use_bc && first_term < num_terms &&
+      batch_evaluator.eval(bytecode, offset + first_term,
+                           num_terms - first_term, seqs, first_term,
+                           interpreter.getMaxCycles())) {
+    for (auto c : batch_evaluator.getCycles()) {
+      steps.add(c);
+    }
+    if (check_eval_time) {
+      checkEvalTime();
+    }
+    return steps;
+  }
+  for (int64_t i = first_term; i < num_terms; i++) {
     mem.clear();
     mem.set(Program::INPUT_CELL, i + offset);
-    steps.add(interpreter.run(p, mem));
+    steps.add(use_bc ? interpreter.run(bytecode, mem)
+                     : interpreter.run(p, mem));
     for (size_t s = 0; s < seqs.size(); s++) {
       seqs[s][i] = mem.get(s);
     }
@@ -169,12 +366,19 @@ std::pair<status_t, steps_t> Evaluator::check(const Program &p,
       return result;
     }
   }
-  // clear cache to correctly detect recursion errors
+  // clear cache and bypass the term store to correctly detect recursion errors
   interpreter.clearCaches();
+  TermStore::Bypass term_store_bypass;
   const bool use_inc = use_inc_eval && inc_evaluator.init(p);
-  const bool use_vir = !use_inc && use_vir_eval && vir_evaluator.init(p);
+  const bool use_mat = !use_inc && use_mat_eval && mat_evaluator.init(p);
+  const bool use_vir =
+      !use_inc && !use_mat && use_vir_eval && vir_evaluator.init(p);
+  const bool use_bc =
+      !use_inc && !use_mat && !use_vir && interpreter.compile(p, bytecode);
+  const bool use_int64 = use_bc && int64_interpreter.init(bytecode);
   std::pair<Number, size_t> tmp_result;
   result.first = status_t::OK;
+  num_deopts = 0;
   Memory mem;
   Number out;
   for (size_t i = 0; i < expected_seq.size(); i++) {
@@ -185,13 +389,22 @@ std::pair<status_t, steps_t> Evaluator::check(const Program &p,
         if (use_inc) {
           tmp_result = inc_evaluator.next();
           out = tmp_result.first;
+        } else if (use_mat) {
+          tmp_result = mat_evaluator.eval(index);
+          out = tmp_result.first;
         } else if (use_vir) {
           tmp_result = vir_evaluator.eval(index);
           out = tmp_result.first;
         } else {
           mem.clear();
           mem.set(Program::INPUT_CELL, index);
-          result.second.add(interpreter.run(p, mem, id));
+          size_t s;
+          if (!use_int64 || !int64_interpreter.run(mem, s)) {
+            num_deopts += use_int64;
+            s = use_bc ? interpreter.run(bytecode, mem, id)
+                       : interpreter.run(p, mem, id);
+          }
+          result.second.add(s);
           out = mem.get(Program::OUTPUT_CELL);
         }
         if (check_eval_time) {
@@ -249,6 +462,10 @@ bool Evaluator::supportsEvalModes(const Program &p, eval_mode_t eval_modes) {
     result = result && vir_evaluator.init(p);
     vir_evaluator.reset();
   }
+  if (eval_modes & EVAL_MATRIX) {
+    result = result && mat_evaluator.init(p);
+    mat_evaluator.reset();
+  }
   return result;
 }
 
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 
+#include "eval/evaluator_batch.hpp"
 #include "eval/evaluator_inc.hpp"
+#include "eval/evaluator_mat.hpp"
 #include "eval/evaluator_vir.hpp"
 #include "eval/interpreter.hpp"
+#include "eval/interpreter_int64.hpp"
 #include "eval/range_generator.hpp"
 #include "math/sequence.hpp"
 
@@ -25,6 +29,7 @@ typedef int64_t eval_mode_t;
 constexpr eval_mode_t EVAL_REGULAR = 1;
 constexpr eval_mode_t EVAL_INCREMENTAL = 2;
 constexpr eval_mode_t EVAL_VIRTUAL = 4;
+constexpr eval_mode_t EVAL_MATRIX = 8;  // opt-in, not included in EVAL_ALL
 constexpr eval_mode_t EVAL_ALL = EVAL_REGULAR | EVAL_INCREMENTAL | EVAL_VIRTUAL;
 
 class Evaluator {
@@ -35,8 +40,21 @@ class Evaluator {
   steps_t eval(const Program &p, Sequence &seq, int64_t num_terms = -1,
                const bool throw_on_error = true);
 
+  // Callback for evaluated terms. Returning false stops the evaluation.
+  using term_callback_t =
+      std::function<bool(int64_t index, const Number &term, const steps_t &)>;
+
+  // Evaluate a program and pass every term and the accumulated steps to the
+  // callback. If the evaluation is stopped, the sequence ends with the last
+  // evaluated term.
+  steps_t eval(const Program &p, Sequence &seq, int64_t num_terms,
+               const bool throw_on_error, const term_callback_t &on_term);
+
+  // Evaluate a program and store the values of the first memory cells in the
+  // given sequences. If first_term is positive, the previous terms are kept
+  // and only the remaining terms are computed.
   steps_t eval(const Program &p, std::vector<Sequence> &seqs,
-               int64_t num_terms = -1);
+               int64_t num_terms = -1, int64_t first_term = 0);
 
   std::pair<status_t, steps_t> check(const Program &p,
                                      const Sequence &expected_seq,
@@ -47,22 +65,39 @@ class Evaluator {
 
   IncrementalEvaluator &getIncEvaluator() { return inc_evaluator; }
 
+  // Number of terms of the last evaluated program that were evaluated using
+  // the int64 fast path first and then again using the regular interpreter.
+  size_t getNumDeopts() const { return num_deopts; }
+
   void clearCaches();
 
  private:
   const Settings &settings;
   Interpreter interpreter;
+  Bytecode bytecode;
+  Int64Interpreter int64_interpreter;
+  BatchEvaluator batch_evaluator;
   IncrementalEvaluator inc_evaluator;
   VirtualEvaluator vir_evaluator;
+  MatrixEvaluator mat_evaluator;
   RangeGenerator range_generator;
   const bool use_inc_eval;
   const bool use_vir_eval;
+  const bool use_mat_eval;
   const bool check_range;
   const bool check_eval_time;
   const bool is_debug;
+  size_t num_deopts;
   std::chrono::time_point<std::chrono::steady_clock> start_time;
 
   Range generateRange(const Program &p, int64_t inputUpperBound);
 
+  // Evaluate the terms in parallel using settings.num_eval_threads workers,
+  // each with its own interpreter. The terms are passed to the output and
+  // the callback in order.
+  steps_t evalParallel(const Program &p, Sequence &seq, int64_t num_terms,
+                       const bool throw_on_error,
+                       const term_callback_t &on_term);
+
   void checkEvalTime() const;
 };
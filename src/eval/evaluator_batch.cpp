@@ -0,0 +1,306 @@
+#include "eval/evaluator_batch.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "eval/interpreter.hpp"
+
+// Maximum number of memory cells per lane (magic number)
+constexpr int64_t MAX_BATCH_CELLS = 1024;
+
+// Apply a binary int64 operation to all lanes. Inactive lanes are not
+// modified. The operation sets the sign bit of its last argument in case of
+// an overflow. The loop is written in a branch-free way such that it can be
+// vectorized by the compiler.
+template <bool DIRECT, class F>
+inline bool applyLanes(int64_t* target, const int64_t* source,
+                       const int64_t* mask, size_t num_lanes, F f) {
+  int64_t overflow = 0;
+  for (size_t l = 0; l < num_lanes; l++) {
+    int64_t o;
+    const int64_t r = f(target[l], source[DIRECT ? l : 0], o);
+    overflow |= o & mask[l];
+    target[l] = (r & mask[l]) | (target[l] & ~mask[l]);
+  }
+  return overflow >= 0;
+}
+
+inline int64_t movLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return b;
+}
+
+inline int64_t addLane(int64_t a, int64_t b, int64_t& o) {
+  const int64_t r = static_cast<int64_t>(static_cast<uint64_t>(a) +
+                                         static_cast<uint64_t>(b));
+  o = (a ^ r) & (b ^ r);
+  return r;
+}
+
+inline int64_t subLane(int64_t a, int64_t b, int64_t& o) {
+  const int64_t r = static_cast<int64_t>(static_cast<uint64_t>(a) -
+                                         static_cast<uint64_t>(b));
+  o = (a ^ b) & (a ^ r);
+  return r;
+}
+
+inline int64_t trnLane(int64_t a, int64_t b, int64_t& o) {
+  const int64_t r = subLane(a, b, o);
+  return r < 0 ? 0 : r;
+}
+
+inline int64_t mulLane(int64_t a, int64_t b, int64_t& o) {
+#if defined(__GNUC__) || defined(__clang__)
+  int64_t r;
+  o = __builtin_mul_overflow(a, b, &r) ? -1 : 0;
+  return r;
+#else
+  // conservative check: the product fits if both factors fit into 31 bits
+  const bool small = (a >= -0x7fffffff && a <= 0x7fffffff &&
+                      b >= -0x7fffffff && b <= 0x7fffffff);
+  o = small ? 0 : -1;
+  return small ? a * b : 0;
+#endif
+}
+
+inline int64_t minLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return a < b ? a : b;
+}
+
+inline int64_t maxLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return a < b ? b : a;
+}
+
+inline int64_t equLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return a == b;
+}
+
+inline int64_t neqLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return a != b;
+}
+
+inline int64_t leqLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return a <= b;
+}
+
+inline int64_t geqLane(int64_t a, int64_t b, int64_t& o) {
+  o = 0;
+  return a >= b;
+}
+
+BatchEvaluator::BatchEvaluator(const Settings& settings)
+    : settings(settings), num_lanes(0), num_cells(0) {}
+
+bool BatchEvaluator::eval(const Bytecode& bc, int64_t offset,
+                          size_t num_lanes, std::vector<Sequence>& seqs,
+                          size_t index, size_t max_cycles) {
+  this->num_lanes = num_lanes;
+  if (num_lanes == 0 || !prepare(bc, seqs.size())) {
+    return false;
+  }
+  for (size_t l = 0; l < num_lanes; l++) {
+    cells[Program::INPUT_CELL * num_lanes + l] = offset + l;
+  }
+  try {
+    if (!run(bc, max_cycles)) {
+      return false;
+    }
+  } catch (const std::exception&) {
+    return false;  // let the interpreter report the error
+  }
+  for (size_t s = 0; s < seqs.size(); s++) {
+    for (size_t l = 0; l < num_lanes; l++) {
+      seqs[s][index + l] = cells[s * num_lanes + l];
+    }
+  }
+  return true;
+}
+
+bool BatchEvaluator::prepare(const Bytecode& bc, size_t num_outputs) {
+  if (bc.needs_fragments || bc.has_region_ops) {
+    return false;
+  }
+  constants.clear();
+  for (const auto& c : bc.constants) {
+    if (!c.fitsInInt64()) {
+      return false;
+    }
+    constants.push_back(c.asInt());
+  }
+  int64_t max_index = std::max<int64_t>(num_outputs, 1) - 1;
+  for (const auto& ins : bc.code) {
+    switch (ins.opcode) {
+      case Bytecode::Opcode::LPE:
+        continue;
+      case Bytecode::Opcode::LPB:
+        if (ins.target_type != Operand::Type::DIRECT) {
+          return false;
+        }
+        break;
+      case Bytecode::Opcode::ARITH:
+      case Bytecode::Opcode::CLR:
+      case Bytecode::Opcode::FIL:
+      case Bytecode::Opcode::ROL:
+      case Bytecode::Opcode::ROR:
+      case Bytecode::Opcode::SEQ:
+      case Bytecode::Opcode::PRG:
+      case Bytecode::Opcode::DBG:
+      case Bytecode::Opcode::__COUNT:
+        return false;
+      default:
+        if (ins.source_type == Operand::Type::DIRECT) {
+          if (ins.source < 0) {
+            return false;
+          }
+          max_index = std::max(max_index, ins.source);
+        }
+        break;
+    }
+    if (ins.target < 0) {
+      return false;
+    }
+    max_index = std::max(max_index, ins.target);
+  }
+  // the interpreter checks the memory limit based on the approximate size
+  const int64_t max_size = MEMORY_CACHE_SIZE +
+                           std::max<int64_t>(max_index + 1 - MEMORY_CACHE_SIZE,
+                                             0);
+  if (max_index >= MAX_BATCH_CELLS ||
+      (settings.max_memory >= 0 &&
+       (max_index > settings.max_memory || max_size > settings.max_memory))) {
+    return false;
+  }
+  num_cells = max_index + 1;
+  cells.assign(num_cells * num_lanes, 0);
+  mask.assign(num_lanes, -1);
+  cycles.assign(num_lanes, 0);
+  active_since.assign(num_lanes, 0);
+  return true;
+}
+
+bool BatchEvaluator::applyNumber(const Bytecode::Instruction& ins,
+                                 int64_t* target, const int64_t* source,
+                                 size_t step) {
+  for (size_t l = 0; l < num_lanes; l++) {
+    if (!mask[l]) {
+      continue;
+    }
+    const auto r =
+        Interpreter::calc(ins.type, Number(target[l]), Number(source[l * step]));
+    if (r == Number::INF || !r.fitsInInt64()) {
+      return false;
+    }
+    target[l] = r.asInt();
+  }
+  return true;
+}
+
+bool BatchEvaluator::run(const Bytecode& bc, size_t max_cycles) {
+  const size_t num_ins = bc.code.size();
+  const Bytecode::Instruction* code = bc.code.data();
+  const int64_t* m = mask.data();
+  const size_t n = num_lanes;
+  size_t depth = 0;
+  size_t steps = 0;
+  size_t pc = 0;
+  while (pc < num_ins) {
+    const auto& ins = code[pc];
+    size_t pc_next = pc + 1;
+    int64_t* target = (ins.target_type == Operand::Type::DIRECT)
+                          ? cells.data() + ins.target * n
+                          : nullptr;
+    const bool dd = (ins.source_type == Operand::Type::DIRECT);
+    const int64_t* source =
+        dd ? cells.data() + ins.source * n : constants.data() + ins.source;
+    bool ok = true;
+    switch (ins.opcode) {
+#define BATCH_LANES(T, F)                                        \
+  case Bytecode::Opcode::T##_DC:                                 \
+    ok = applyLanes<false>(target, source, m, n, F);             \
+    break;                                                       \
+  case Bytecode::Opcode::T##_DD:                                 \
+    ok = applyLanes<true>(target, source, m, n, F);              \
+    break;
+      BATCH_LANES(MOV, movLane)
+      BATCH_LANES(ADD, addLane)
+      BATCH_LANES(SUB, subLane)
+      BATCH_LANES(TRN, trnLane)
+      BATCH_LANES(MUL, mulLane)
+      BATCH_LANES(MIN, minLane)
+      BATCH_LANES(MAX, maxLane)
+      BATCH_LANES(EQU, equLane)
+      BATCH_LANES(NEQ, neqLane)
+      BATCH_LANES(LEQ, leqLane)
+      BATCH_LANES(GEQ, geqLane)
+#undef BATCH_LANES
+      case Bytecode::Opcode::LPB: {
+        if (depth >= 100) {  // magic number
+          return false;
+        }
+        if (frames.size() <= depth) {
+          frames.emplace_back();
+        }
+        auto& frame = frames[depth++];
+        frame.snapshot = cells;
+        frame.entry_mask = mask;
+        frame.counters.assign(target, target + n);
+        break;
+      }
+      case Bytecode::Opcode::LPE: {
+        auto& frame = frames[depth - 1];
+        const int64_t* counter = cells.data() + code[ins.jump].target * n;
+        bool repeat = false;
+        for (size_t l = 0; l < n; l++) {
+          if (!mask[l]) {
+            continue;
+          }
+          if (counter[l] >= 0 && counter[l] < frame.counters[l]) {
+            // next iteration: update snapshot of this lane
+            frame.counters[l] = counter[l];
+            for (size_t c = 0; c < num_cells; c++) {
+              frame.snapshot[c * n + l] = cells[c * n + l];
+            }
+            repeat = true;
+          } else {
+            // leave the loop: restore memory and deactivate this lane
+            for (size_t c = 0; c < num_cells; c++) {
+              cells[c * n + l] = frame.snapshot[c * n + l];
+            }
+            mask[l] = 0;
+            cycles[l] += steps + 1 - active_since[l];
+          }
+        }
+        if (repeat) {
+          pc_next = ins.jump + 1;
+        } else {
+          // all lanes left the loop: reactivate them
+          mask = frame.entry_mask;
+          m = mask.data();
+          for (size_t l = 0; l < n; l++) {
+            if (mask[l]) {
+              active_since[l] = steps + 1;
+            }
+          }
+          depth--;
+        }
+        break;
+      }
+      default:
+        ok = applyNumber(ins, target, source, dd ? 1 : 0);
+        break;
+    }
+    if (!ok || ++steps > max_cycles || Signals::HALT) {
+      return false;
+    }
+    pc = pc_next;
+  }
+  for (size_t l = 0; l < n; l++) {
+    cycles[l] += steps - active_since[l];
+  }
+  return true;
+}
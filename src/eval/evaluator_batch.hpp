@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "eval/bytecode.hpp"
+#include "math/sequence.hpp"
+#include "sys/util.hpp"
+
+// Evaluates a program on a batch of consecutive inputs in lockstep. Every
+// input is processed in its own lane. The memory is stored as int64 values in
+// structure-of-arrays layout, i.e., the lanes of a cell are stored next to each
+// other, and each instruction is dispatched once for all lanes. Lanes that
+// leave a loop earlier than others are masked out until all lanes have left
+// the loop. If a program uses operations that are not supported or if a value
+// does not fit into int64, the evaluation is aborted and the results must be
+// computed using the interpreter.
+class BatchEvaluator {
+ public:
+  explicit BatchEvaluator(const Settings &settings);
+
+  // Evaluate a compiled program for the inputs offset,...,offset+num_lanes-1
+  // and store the values of the first memory cells in the given sequences
+  // starting at the given index. Returns false if the batch evaluation was
+  // aborted.
+  bool eval(const Bytecode &bc, int64_t offset, size_t num_lanes,
+            std::vector<Sequence> &seqs, size_t index, size_t max_cycles);
+
+  // Number of execution steps per lane of the last successful evaluation.
+  const std::vector<size_t> &getCycles() const { return cycles; }
+
+ private:
+  // Loop state. The snapshot contains the memory at the beginning of the
+  // current iteration, which is restored for lanes that leave the loop.
+  class Frame {
+   public:
+    std::vector<int64_t> snapshot;
+    std::vector<int64_t> counters;
+    std::vector<int64_t> entry_mask;
+  };
+
+  bool prepare(const Bytecode &bc, size_t num_outputs);
+
+  bool run(const Bytecode &bc, size_t max_cycles);
+
+  bool applyNumber(const Bytecode::Instruction &ins, int64_t *target,
+                   const int64_t *source, size_t step);
+
+  const Settings &settings;
+  size_t num_lanes;
+  size_t num_cells;
+  std::vector<int64_t> cells;       // value of lane l in cell c: c*lanes+l
+  std::vector<int64_t> constants;   // constant pool as int64
+  std::vector<int64_t> mask;        // -1 for active lanes, 0 otherwise
+  std::vector<Frame> frames;        // loop frames (reused across runs)
+  std::vector<size_t> cycles;       // execution steps per lane
+  std::vector<size_t> active_since; // step count at lane activation
+};
@@ -0,0 +1,219 @@
+#include "eval/evaluator_mat.hpp"
+
+#include <stdexcept>
+
+MatrixEvaluator::MatrixEvaluator(const Settings &settings)
+    : interpreter(settings) {
+  reset();
+}
+
+void MatrixEvaluator::reset() {
+  simple_loop = {};
+  program.ops.clear();
+  cells.clear();
+  transfer.clear();
+  dim = 0;
+  body_steps = 0;
+  counter_decrement = 0;
+  initialized = false;
+}
+
+bool MatrixEvaluator::init(const Program &p) {
+  reset();
+  simple_loop = Analyzer::extractSimpleLoop(p);
+  if (!simple_loop.is_simple_loop) {
+    return false;
+  }
+  // collect the memory cells used in the loop body
+  cells[simple_loop.counter] = 0;
+  for (const auto &op : simple_loop.body.ops) {
+    if (op.type == Operation::Type::NOP) {
+      continue;
+    }
+    if (op.type != Operation::Type::MOV && op.type != Operation::Type::ADD &&
+        op.type != Operation::Type::SUB && op.type != Operation::Type::MUL) {
+      return false;
+    }
+    cells[op.target.value.asInt()] = 0;
+    if (op.source.type == Operand::Type::DIRECT) {
+      cells[op.source.value.asInt()] = 0;
+    }
+    body_steps++;
+  }
+  dim = cells.size() + 1;
+  size_t index = 0;
+  for (auto &c : cells) {
+    c.second = index++;
+  }
+  // compose the affine maps of the operations by transforming the rows of
+  // the transfer matrix
+  const size_t one = dim - 1;
+  transfer.assign(dim * dim, Number::ZERO);
+  for (size_t i = 0; i < dim; i++) {
+    transfer[i * dim + i] = Number::ONE;
+  }
+  std::vector<Number> row(dim);
+  for (const auto &op : simple_loop.body.ops) {
+    if (op.type == Operation::Type::NOP) {
+      continue;
+    }
+    const size_t t = cells[op.target.value.asInt()] * dim;
+    if (op.source.type == Operand::Type::CONSTANT) {
+      row.assign(dim, Number::ZERO);
+      row[one] = op.source.value;
+    } else {
+      const size_t s = cells[op.source.value.asInt()] * dim;
+      row.assign(transfer.begin() + s, transfer.begin() + s + dim);
+    }
+    switch (op.type) {
+      case Operation::Type::MOV:
+        std::copy(row.begin(), row.end(), transfer.begin() + t);
+        break;
+      case Operation::Type::ADD:
+        for (size_t j = 0; j < dim; j++) {
+          transfer[t + j] += row[j];
+        }
+        break;
+      case Operation::Type::SUB:
+        for (size_t j = 0; j < dim; j++) {
+          transfer[t + j] -= row[j];
+        }
+        break;
+      case Operation::Type::MUL: {
+        // multiplication is affine only if the factor is a constant
+        for (size_t j = 0; j < one; j++) {
+          if (row[j] != Number::ZERO) {
+            return false;
+          }
+        }
+        for (size_t j = 0; j < dim; j++) {
+          transfer[t + j] *= row[one];
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  // the loop counter must be decremented by a constant
+  const size_t c = cells[simple_loop.counter];
+  for (size_t j = 0; j < one; j++) {
+    if (transfer[c * dim + j] != (j == c ? Number::ONE : Number::ZERO)) {
+      return false;
+    }
+  }
+  const auto &decrement = transfer[c * dim + one];
+  if (!(decrement < Number::ZERO) || !decrement.fitsInInt64()) {
+    return false;
+  }
+  counter_decrement = -decrement.asInt();
+  for (const auto &n : transfer) {
+    if (n == Number::INF) {
+      return false;
+    }
+  }
+  program = p;
+  initialized = true;
+  return true;
+}
+
+MatrixEvaluator::Matrix MatrixEvaluator::multiply(const Matrix &a,
+                                                  const Matrix &b) const {
+  Matrix r(dim * dim, Number::ZERO);
+  for (size_t i = 0; i < dim; i++) {
+    for (size_t k = 0; k < dim; k++) {
+      const auto &f = a[i * dim + k];
+      if (f == Number::ZERO) {
+        continue;
+      }
+      for (size_t j = 0; j < dim; j++) {
+        const auto &g = b[k * dim + j];
+        if (g != Number::ZERO) {
+          auto p = f;
+          p *= g;
+          r[i * dim + j] += p;
+        }
+      }
+    }
+  }
+  return r;
+}
+
+std::vector<Number> MatrixEvaluator::apply(const Matrix &a,
+                                           const std::vector<Number> &x) const {
+  std::vector<Number> r(dim, Number::ZERO);
+  for (size_t i = 0; i < dim; i++) {
+    for (size_t j = 0; j < dim; j++) {
+      if (a[i * dim + j] != Number::ZERO && x[j] != Number::ZERO) {
+        auto p = a[i * dim + j];
+        p *= x[j];
+        r[i] += p;
+      }
+    }
+  }
+  return r;
+}
+
+std::pair<Number, size_t> MatrixEvaluator::eval(const Number &input) {
+  if (!initialized) {
+    throw std::runtime_error("matrix evaluator not initialized");
+  }
+  Memory mem;
+  mem.set(Program::INPUT_CELL, input);
+  size_t steps = interpreter.run(simple_loop.pre_loop, mem);
+
+  // number of iterations that are not discarded
+  const auto counter = mem.get(simple_loop.counter);
+  if (!counter.fitsInInt64()) {
+    throw std::runtime_error("loop counter out of range: " +
+                             counter.to_string());
+  }
+  uint64_t iterations = 0;
+  if (!(counter < Number::ZERO)) {
+    iterations = counter.asInt() / counter_decrement;
+  }
+  // lpb, all iterations including the discarded one, and lpe of each
+  const size_t max_cycles = interpreter.getMaxCycles();
+  if (steps >= max_cycles ||
+      iterations + 1 > (max_cycles - steps - 1) / (body_steps + 1)) {
+    throw std::runtime_error("Exceeded maximum number of steps (" +
+                             std::to_string(max_cycles) + ")");
+  }
+  steps += 1 + (iterations + 1) * (body_steps + 1);
+
+  // apply the transfer matrix using binary exponentiation
+  std::vector<Number> x(dim, Number::ONE);
+  for (const auto &c : cells) {
+    x[c.second] = mem.get(c.first);
+  }
+  Matrix power = transfer;
+  for (uint64_t m = iterations; m > 0; m >>= 1) {
+    if (m & 1) {
+      x = apply(power, x);
+    }
+    if (m > 1) {
+      power = multiply(power, power);
+    }
+  }
+  for (const auto &c : cells) {
+    if (x[c.second] == Number::INF) {
+      // coefficients can overflow although the terms do not
+      mem.clear();
+      mem.set(Program::INPUT_CELL, input);
+      steps = interpreter.run(program, mem);
+      return std::pair<Number, size_t>(mem.get(Program::OUTPUT_CELL), steps);
+    }
+    mem.set(c.first, x[c.second]);
+  }
+
+  // the last iteration is discarded, but it can fail
+  Memory tmp = mem;
+  interpreter.run(simple_loop.body, tmp);
+
+  steps += interpreter.run(simple_loop.post_loop, mem);
+  if (steps > max_cycles) {
+    throw std::runtime_error("Exceeded maximum number of steps (" +
+                             std::to_string(max_cycles) + ")");
+  }
+  return std::pair<Number, size_t>(mem.get(Program::OUTPUT_CELL), steps);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+
+#include "eval/interpreter.hpp"
+#include "lang/analyzer.hpp"
+
+// Matrix Evaluator (ME) for simple loop programs with affine loop bodies. If
+// the loop body consists only of mov, add and sub operations and of mul
+// operations by constants, one iteration of the loop is an affine map of the
+// memory cells used in the body. The loop counter must be decremented by a
+// constant. Then the effect of all but the last iteration is computed by
+// exponentiation of the transfer matrix using O(log n) matrix products. The
+// last iteration, which is discarded by the loop semantics, and the pre- and
+// post-loop fragments are executed using the interpreter. The number of
+// execution steps is the same as for the regular evaluation.
+class MatrixEvaluator {
+ public:
+  explicit MatrixEvaluator(const Settings &settings);
+
+  // Initialize the ME using a program. ME can be applied only if this function
+  // returns true.
+  bool init(const Program &p);
+
+  std::pair<Number, size_t> eval(const Number &input);
+
+  void reset();
+
+ private:
+  using Matrix = std::vector<Number>;  // square matrix in row-major order
+
+  Matrix multiply(const Matrix &a, const Matrix &b) const;
+
+  std::vector<Number> apply(const Matrix &a,
+                            const std::vector<Number> &x) const;
+
+  Interpreter interpreter;
+  SimpleLoopProgram simple_loop;
+  Program program;
+  std::map<int64_t, size_t> cells;  // memory cell => matrix index
+  Matrix transfer;  // affine map of one iteration, last index is constant 1
+  size_t dim;
+  size_t body_steps;
+  int64_t counter_decrement;
+  bool initialized;
+};
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <stack>
 
+#include "eval/term_store.hpp"
 #include "lang/parser.hpp"
 #include "lang/program.hpp"
 #include "lang/program_util.hpp"
@@ -32,6 +33,7 @@ using SizeStack = std::stack<size_t>;
 Interpreter::Interpreter(const Settings& settings)
     : settings(settings),
       is_debug(Log::get().level == Log::Level::DEBUG),
+      use_bytecode(settings.use_bytecode && !is_debug),
       has_memory(true),
       num_memory_checks(0) {}
 
@@ -357,6 +359,289 @@ size_t Interpreter::run(const Program& p, Memory& mem, UID id) {
   return result;
 }
 
+bool Interpreter::compile(const Program& p, Bytecode& bc) const {
+  return use_bytecode && Bytecode::compile(p, bc);
+}
+
+// Use computed gotos for threaded dispatch if the compiler supports it.
+#if defined(__GNUC__) || defined(__clang__)
+#define BYTECODE_THREADED_DISPATCH
+#endif
+
+inline Number getValue(Operand::Type type, int64_t arg, const Number* constants,
+                       const Memory& mem) {
+  switch (type) {
+    case Operand::Type::CONSTANT:
+      return constants[arg];
+    case Operand::Type::DIRECT:
+      return mem.get(arg);
+    case Operand::Type::INDIRECT:
+      return mem.get(mem.get(arg).asInt());
+  }
+  return {};
+}
+
+inline int64_t getAddress(Operand::Type type, int64_t arg, const Memory& mem) {
+  switch (type) {
+    case Operand::Type::CONSTANT:
+      throw std::runtime_error("Cannot get address of a constant");
+    case Operand::Type::DIRECT:
+      return arg;
+    case Operand::Type::INDIRECT:
+      return mem.get(arg).asInt();
+  }
+  return 0;
+}
+
+size_t Interpreter::run(const Bytecode& bc, Memory& mem) {
+  // check for empty program
+  const size_t num_ins = bc.code.size();
+  if (num_ins == 0) {
+    return 0;
+  }
+
+  // define stacks
+  NumStack counter_stack;
+  IntStack frag_length_stack;
+  MemStack mem_stack;
+  MemStack frag_stack;
+
+  size_t cycles = 0;
+  const size_t max_cycles = getMaxCycles();
+  const bool needs_frags = bc.needs_fragments;
+  // use an undo log instead of memory snapshots if possible
+  const bool use_journal =
+      settings.use_memory_journal && !needs_frags && !bc.has_region_ops;
+  MemoryJournal journal_log;
+  MemoryJournal* journal = use_journal ? &journal_log : nullptr;
+  const Bytecode::Instruction* code = bc.code.data();
+  const Number* constants = bc.constants.data();
+  const Bytecode::Instruction* ins;
+  Memory frag;
+  size_t pc, pc_next;
+  Number source, target, counter;
+  int64_t start, length, length2;
+
+#ifdef BYTECODE_THREADED_DISPATCH
+#define BYTECODE_ARITH_LABELS(T, f) &&L_##T##_DC, &&L_##T##_DD,
+  // must be in the same order as Bytecode::Opcode
+  static const void* const dispatch_table[] = {
+      &&L_MOV_DC, &&L_MOV_DD, BYTECODE_ARITH_OPS(BYTECODE_ARITH_LABELS)
+      &&L_ARITH, &&L_LPB, &&L_LPE, &&L_CLR, &&L_FIL, &&L_ROL, &&L_ROR,
+      &&L_SEQ, &&L_PRG, &&L_DBG, &&L___COUNT};
+#undef BYTECODE_ARITH_LABELS
+#define BYTECODE_DISPATCH \
+  goto* dispatch_table[static_cast<size_t>(ins->opcode)];
+#define BYTECODE_HANDLER(name) L_##name
+#else
+#define BYTECODE_DISPATCH switch (ins->opcode)
+#define BYTECODE_HANDLER(name) case Bytecode::Opcode::name
+#endif
+
+  // start program execution
+  pc = 0;
+  while (pc < num_ins) {
+    ins = code + pc;
+    pc_next = pc + 1;
+
+    BYTECODE_DISPATCH {
+      BYTECODE_HANDLER(MOV_DC) : {
+        set(ins->target, constants[ins->source], mem, bc.ops[pc], journal);
+        goto next;
+      }
+      BYTECODE_HANDLER(MOV_DD) : {
+        set(ins->target, mem.get(ins->source), mem, bc.ops[pc], journal);
+        goto next;
+      }
+#define BYTECODE_ARITH_HANDLERS(T, f)                                       \
+  BYTECODE_HANDLER(T##_DC) : {                                              \
+    set(ins->target,                                                        \
+        Semantics::f(mem.get(ins->target), constants[ins->source]), mem,    \
+        bc.ops[pc], journal);                                               \
+    goto next;                                                              \
+  }                                                                         \
+  BYTECODE_HANDLER(T##_DD) : {                                              \
+    set(ins->target, Semantics::f(mem.get(ins->target), mem.get(ins->source)), \
+        mem, bc.ops[pc], journal);                                          \
+    goto next;                                                              \
+  }
+      BYTECODE_ARITH_OPS(BYTECODE_ARITH_HANDLERS)
+#undef BYTECODE_ARITH_HANDLERS
+      BYTECODE_HANDLER(ARITH) : {
+        target = getValue(ins->target_type, ins->target, constants, mem);
+        source = getValue(ins->source_type, ins->source, constants, mem);
+        set(bc.ops[pc].target, calc(ins->type, target, source), mem,
+            bc.ops[pc], journal);
+        goto next;
+      }
+      BYTECODE_HANDLER(LPB) : {
+        const size_t depth =
+            use_journal ? journal_log.depth() : mem_stack.size();
+        if (depth >= 100) {  // magic number
+          throw std::runtime_error("Maximum stack size exceeded: " +
+                                   std::to_string(depth));
+        }
+        if (use_journal) {
+          journal_log.push();
+        } else {
+          mem_stack.push(mem);
+        }
+        if (needs_frags) {
+          length = getValue(ins->source_type, ins->source, constants, mem)
+                       .asInt();
+          start = getAddress(ins->target_type, ins->target, mem);
+          checkMaxMemory(length);
+          frag = mem.fragment(start, length);
+          frag_stack.push(frag);
+          frag_length_stack.push(length);
+        } else {
+          counter = getValue(ins->target_type, ins->target, constants, mem);
+          counter_stack.push(counter);
+        }
+        goto next;
+      }
+      BYTECODE_HANDLER(LPE) : {
+        const auto& lpb = code[ins->jump];
+        if (needs_frags) {
+          start = getAddress(lpb.target_type, lpb.target, mem);
+          length2 =
+              getValue(lpb.source_type, lpb.source, constants, mem).asInt();
+          length = std::min(frag_length_stack.top(), length2);
+          frag = mem.fragment(start, length);
+          if (frag.is_less(frag_stack.top(), length, true)) {
+            pc_next = ins->jump + 1;  // jump back to begin
+            mem_stack.top() = mem;
+            frag_stack.top() = frag;
+            frag_length_stack.top() = length;
+          } else {
+            mem = mem_stack.top();
+            mem_stack.pop();
+            frag_stack.pop();
+            frag_length_stack.pop();
+          }
+        } else {
+          counter = getValue(lpb.target_type, lpb.target, constants, mem);
+          if (Number::MINUS_ONE < counter && counter < counter_stack.top()) {
+            pc_next = ins->jump + 1;  // jump back to begin
+            if (use_journal) {
+              journal_log.commit();
+            } else {
+              mem_stack.top() = mem;
+            }
+            counter_stack.top() = counter;
+          } else {
+            if (use_journal) {
+              journal_log.rollback(mem);
+            } else {
+              mem = mem_stack.top();
+              mem_stack.pop();
+            }
+            counter_stack.pop();
+          }
+        }
+        goto next;
+      }
+      BYTECODE_HANDLER(CLR) : {
+        length =
+            getValue(ins->source_type, ins->source, constants, mem).asInt();
+        start = getAddress(ins->target_type, ins->target, mem);
+        mem.clear(start, length);
+        goto next;
+      }
+      BYTECODE_HANDLER(FIL) : {
+        length =
+            getValue(ins->source_type, ins->source, constants, mem).asInt();
+        start = getAddress(ins->target_type, ins->target, mem);
+        checkMaxMemory(length);
+        mem.fill(start, length);
+        goto next;
+      }
+      BYTECODE_HANDLER(ROL) : {
+        length =
+            getValue(ins->source_type, ins->source, constants, mem).asInt();
+        start = getAddress(ins->target_type, ins->target, mem);
+        checkMaxMemory(length);
+        mem.rotateLeft(start, length);
+        goto next;
+      }
+      BYTECODE_HANDLER(ROR) : {
+        length =
+            getValue(ins->source_type, ins->source, constants, mem).asInt();
+        start = getAddress(ins->target_type, ins->target, mem);
+        checkMaxMemory(length);
+        mem.rotateRight(start, length);
+        goto next;
+      }
+      BYTECODE_HANDLER(SEQ) : {
+        target = getValue(ins->target_type, ins->target, constants, mem);
+        source = getValue(ins->source_type, ins->source, constants, mem);
+        auto result = callSeq(UID::castFromInt(source.asInt()), target);
+        set(bc.ops[pc].target, result.first, mem, bc.ops[pc], journal);
+        cycles += result.second;
+        goto next;
+      }
+      BYTECODE_HANDLER(PRG) : {
+        start = getAddress(ins->target_type, ins->target, mem);
+        source = getValue(ins->source_type, ins->source, constants, mem);
+        cycles += callPrg(UID::castFromInt(source.asInt()), start, mem);
+        goto next;
+      }
+      BYTECODE_HANDLER(DBG) : {
+        std::cout << mem << std::endl;
+        goto next;
+      }
+      BYTECODE_HANDLER(__COUNT) : {
+        throw std::runtime_error("invalid opcode");
+      }
+    }
+#undef BYTECODE_DISPATCH
+#undef BYTECODE_HANDLER
+
+  next:
+    // count execution steps
+    ++cycles;
+
+    // check resource constraints
+    if (cycles > max_cycles) {
+      throw std::runtime_error("Exceeded maximum number of steps (" +
+                               std::to_string(max_cycles) +
+                               "); last operation: " +
+                               ProgramUtil::operationToString(bc.ops[pc]));
+    }
+    if (static_cast<int64_t>(mem.approximate_size()) > settings.max_memory &&
+        settings.max_memory >= 0) {
+      throw std::runtime_error(
+          "Maximum memory exceeded: " + std::to_string(mem.approximate_size()) +
+          "; last operation: " + ProgramUtil::operationToString(bc.ops[pc]));
+    }
+
+    // check for external interrupt
+    if (Signals::HALT) {
+      throw std::runtime_error("interpreter interrupted by halt signal");
+    }
+    pc = pc_next;
+  }
+
+  if (counter_stack.size() + mem_stack.size() + frag_stack.size() +
+      frag_length_stack.size() + journal_log.depth()) {
+    throw std::runtime_error("execution error");
+  }
+  return cycles;
+}
+
+size_t Interpreter::run(const Bytecode& bc, Memory& mem, UID id) {
+  size_t result;
+  running_programs.insert(id);
+  try {
+    result = run(bc, mem);
+  } catch (...) {
+    running_programs.erase(id);
+    std::rethrow_exception(std::current_exception());
+  }
+  running_programs.erase(id);
+  return result;
+}
+
 Number Interpreter::get(const Operand& a, const Memory& mem,
                         bool get_address) const {
   switch (a.type) {
@@ -378,7 +663,7 @@ Number Interpreter::get(const Operand& a, const Memory& mem,
 }
 
 void Interpreter::set(const Operand& a, const Number& v, Memory& mem,
-                      const Operation& last_op) const {
+                      const Operation& last_op, MemoryJournal* journal) const {
   int64_t index = 0;
   switch (a.type) {
     case Operand::Type::CONSTANT:
@@ -391,6 +676,11 @@ void Interpreter::set(const Operand& a, const Number& v, Memory& mem,
       index = mem.get(a.value.asInt()).asInt();
       break;
   }
+  set(index, v, mem, last_op, journal);
+}
+
+void Interpreter::set(int64_t index, const Number& v, Memory& mem,
+                      const Operation& last_op, MemoryJournal* journal) const {
   if (index > settings.max_memory && settings.max_memory >= 0) {
     throw std::runtime_error(
         "Maximum memory exceeded: " + std::to_string(index) +
@@ -401,6 +691,9 @@ void Interpreter::set(const Operand& a, const Number& v, Memory& mem,
         "Overflow in cell $" + std::to_string(index) +
         "; last operation: " + ProgramUtil::operationToString(last_op));
   }
+  if (journal) {
+    journal->record(mem, index);
+  }
   mem.set(index, v);
 }
 
@@ -412,6 +705,11 @@ void Interpreter::checkMaxMemory(int64_t length) {
 }
 
 std::pair<Number, size_t> Interpreter::callSeq(UID id, const Number& arg) {
+  // check for recursive calls before using any cached terms
+  if (running_programs.find(id) != running_programs.end()) {
+    throw std::runtime_error("Recursion detected: " + id.string());
+  }
+
   // check if already cached
   std::pair<UID, Number> key(id, arg);
   auto it = terms_cache.find(key);
@@ -428,9 +726,22 @@ std::pair<Number, size_t> Interpreter::callSeq(UID id, const Number& arg) {
     throw std::runtime_error(ERROR_SEQ_USING_INVALID_ARG);
   }
 
-  // check for recursive calls
-  if (running_programs.find(id) != running_programs.end()) {
-    throw std::runtime_error("Recursion detected: " + id.string());
+  // check if stored by this or another process
+  auto& term_store = TermStore::get();
+  const uint64_t store_key = (term_store.isEnabled() && arg.fitsInInt64())
+                                 ? getTermStoreKey(id)
+                                 : 0;
+  if (store_key) {
+    int64_t value;
+    size_t steps;
+    if (term_store.lookup(id, store_key, arg.asInt(), value, steps)) {
+      std::pair<Number, size_t> result(Number(value),
+                                       steps + program_cache.getOverhead(id));
+      if (has_memory || terms_cache.size() < 10000) {  // magic number
+        terms_cache[key] = result;
+      }
+      return result;
+    }
   }
 
   // evaluate program
@@ -439,7 +750,8 @@ std::pair<Number, size_t> Interpreter::callSeq(UID id, const Number& arg) {
   Memory tmp;
   tmp.set(Program::INPUT_CELL, arg);
   try {
-    result.second = run(call_program, tmp) + program_cache.getOverhead(id);
+    result.second =
+        runCallee(id, call_program, tmp) + program_cache.getOverhead(id);
     result.first = tmp.get(Program::OUTPUT_CELL);
     running_programs.erase(id);
   } catch (...) {
@@ -454,6 +766,10 @@ std::pair<Number, size_t> Interpreter::callSeq(UID id, const Number& arg) {
   if (has_memory || terms_cache.size() < 10000) {  // magic number
     terms_cache[key] = result;
   }
+  if (store_key && result.first.fitsInInt64()) {
+    term_store.insert(id, store_key, arg.asInt(), result.first.asInt(),
+                      result.second - program_cache.getOverhead(id));
+  }
   return result;
 }
 
@@ -465,11 +781,6 @@ size_t Interpreter::callPrg(UID id, int64_t start, Memory& mem) {
   }
   auto& call_program = program_cache.getProgram(id);
 
-  // check for recursive calls
-  if (running_programs.find(id) != running_programs.end()) {
-    throw std::runtime_error("Recursion detected: " + id.string());
-  }
-
   // get number of inputs and outputs
   auto inputs = call_program.getDirective("inputs");
   auto outputs = call_program.getDirective("outputs");
@@ -484,7 +795,7 @@ size_t Interpreter::callPrg(UID id, int64_t start, Memory& mem) {
   size_t steps = 0;
   running_programs.insert(id);
   try {
-    steps = run(call_program, tmp);
+    steps = runCallee(id, call_program, tmp);
     running_programs.erase(id);
   } catch (...) {
     running_programs.erase(id);
@@ -498,6 +809,57 @@ size_t Interpreter::callPrg(UID id, int64_t start, Memory& mem) {
   return steps;
 }
 
+size_t Interpreter::runCallee(UID id, const Program& p, Memory& mem) {
+  if (!use_bytecode) {
+    return run(p, mem);
+  }
+  auto it = bytecode_cache.find(id);
+  if (it == bytecode_cache.end()) {
+    auto& entry = bytecode_cache[id];
+    entry.first = Bytecode::compile(p, entry.second);
+    it = bytecode_cache.find(id);
+  }
+  return it->second.first ? run(it->second.second, mem) : run(p, mem);
+}
+
+uint64_t Interpreter::getTermStoreKey(UID id) {
+  auto it = term_store_keys.find(id);
+  if (it != term_store_keys.end()) {
+    return it->second;
+  }
+  uint64_t key = 0;
+  try {
+    for (const auto& entry : program_cache.collect(id)) {
+      // only programs from the programs folder with known dependencies
+      if (entry.first.domain() != 'A') {
+        key = 0;
+        break;
+      }
+      bool has_indirect_call = false;
+      for (const auto& op : entry.second.ops) {
+        if ((op.type == Operation::Type::SEQ ||
+             op.type == Operation::Type::PRG) &&
+            op.source.type != Operand::Type::CONSTANT) {
+          has_indirect_call = true;
+        }
+      }
+      if (has_indirect_call) {
+        key = 0;
+        break;
+      }
+      // order-independent combination of the program hashes
+      key += (ProgramUtil::hash(entry.second) ^
+              static_cast<uint64_t>(entry.first.castToInt())) *
+             0x9e3779b97f4a7c15ULL;
+      key = key ? key : 1;
+    }
+  } catch (const std::exception&) {
+    key = 0;  // error is reported when running the program
+  }
+  term_store_keys[id] = key;
+  return key;
+}
+
 size_t Interpreter::getMaxCycles() const {
   return (settings.max_cycles >= 0) ? settings.max_cycles
                                     : std::numeric_limits<size_t>::max();
@@ -505,5 +867,7 @@ size_t Interpreter::getMaxCycles() const {
 
 void Interpreter::clearCaches() {
   program_cache.clear();
+  bytecode_cache.clear();
   terms_cache.clear();
+  term_store_keys.clear();
 }
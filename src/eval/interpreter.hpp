@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "eval/bytecode.hpp"
 #include "eval/memory.hpp"
 #include "lang/program_cache.hpp"
 #include "sys/util.hpp"
@@ -20,6 +21,14 @@ class Interpreter {
 
   size_t run(const Program &p, Memory &mem, UID id);
 
+  // Compile a program to bytecode if the bytecode interpreter is enabled and
+  // supports the program. Returns false if the program must be run directly.
+  bool compile(const Program &p, Bytecode &bc) const;
+
+  size_t run(const Bytecode &bc, Memory &mem);
+
+  size_t run(const Bytecode &bc, Memory &mem, UID id);
+
   size_t getMaxCycles() const;
 
   void clearCaches();
@@ -33,7 +42,10 @@ class Interpreter {
              bool get_address = false) const;
 
   void set(const Operand &a, const Number &v, Memory &mem,
-           const Operation &last_op) const;
+           const Operation &last_op, MemoryJournal *journal = nullptr) const;
+
+  void set(int64_t index, const Number &v, Memory &mem,
+           const Operation &last_op, MemoryJournal *journal = nullptr) const;
 
   void checkMaxMemory(int64_t length);
 
@@ -41,7 +53,14 @@ class Interpreter {
 
   size_t callPrg(UID id, int64_t start, Memory &mem);
 
+  size_t runCallee(UID id, const Program &p, Memory &mem);
+
+  // Key of a sequence program in the term store. It is derived from the
+  // program and its dependencies. Returns zero if the terms cannot be stored.
+  uint64_t getTermStoreKey(UID id);
+
   const bool is_debug;
+  const bool use_bytecode;
   bool has_memory;
   size_t num_memory_checks;
 
@@ -52,6 +71,8 @@ class Interpreter {
   };
 
   std::unordered_set<UID> running_programs;
+  std::unordered_map<UID, std::pair<bool, Bytecode>> bytecode_cache;
+  std::unordered_map<UID, uint64_t> term_store_keys;
   std::unordered_map<std::pair<UID, Number>, std::pair<Number, size_t>,
                      UIDNumberPairHasher>
       terms_cache;
@@ -0,0 +1,349 @@
+#include "eval/interpreter_int64.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+#include "lang/program_util.hpp"
+
+constexpr int64_t MIN_INT = std::numeric_limits<int64_t>::min();
+
+// The following functions implement the semantics of the operations for
+// machine integers. They return false if the result does not fit into 64 bits
+// or if the operation fails, e.g. because of a division by zero.
+
+inline bool addInt(int64_t a, int64_t b, int64_t &r) {
+  r = static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+  return ((a ^ r) & (b ^ r)) >= 0;
+}
+
+inline bool subInt(int64_t a, int64_t b, int64_t &r) {
+  r = static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+  return ((a ^ b) & (a ^ r)) >= 0;
+}
+
+inline bool mulInt(int64_t a, int64_t b, int64_t &r) {
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_mul_overflow(a, b, &r);
+#else
+  if (a == 0 || b == 0) {
+    r = 0;
+    return true;
+  }
+  if ((a == -1 && b == MIN_INT) || (b == -1 && a == MIN_INT)) {
+    return false;
+  }
+  r = static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+  return r / b == a;
+#endif
+}
+
+inline bool absInt(int64_t a, int64_t &r) {
+  if (a == MIN_INT) {
+    return false;
+  }
+  r = (a < 0) ? -a : a;
+  return true;
+}
+
+inline bool difInt(int64_t a, int64_t b, int64_t &r) {
+  if (b == 0) {
+    r = a;
+    return true;
+  }
+  if (a == MIN_INT && b == -1) {
+    return false;
+  }
+  const int64_t d = a / b;
+  r = (a == b * d) ? d : a;
+  return true;
+}
+
+inline bool dirInt(int64_t a, int64_t b, int64_t &r) {
+  int64_t aa = a, d, abs_d, abs_aa;
+  while (true) {
+    if (!difInt(aa, b, d) || !absInt(d, abs_d) || !absInt(aa, abs_aa)) {
+      return false;
+    }
+    if (abs_d == abs_aa) {
+      break;
+    }
+    aa = d;
+  }
+  r = aa;
+  return true;
+}
+
+inline bool powInt(int64_t base, int64_t exp, int64_t &r) {
+  if (base == 1) {
+    r = 1;
+    return true;
+  }
+  if (base == -1) {
+    r = (exp & 1) ? -1 : 1;
+    return true;
+  }
+  if (base == 0) {
+    if (exp < 0) {
+      return false;  // infinity
+    }
+    r = (exp == 0) ? 1 : 0;
+    return true;
+  }
+  if (exp < 0) {
+    r = 0;
+    return true;
+  }
+  int64_t res = 1, b = base, e = exp;
+  while (e != 0) {
+    if ((e & 1) && !mulInt(res, b, res)) {
+      return false;
+    }
+    e /= 2;
+    if (e != 0 && !mulInt(b, b, b)) {
+      return false;
+    }
+  }
+  r = res;
+  return true;
+}
+
+inline bool gcdInt(int64_t a, int64_t b, int64_t &r) {
+  int64_t aa, bb;
+  if (!absInt(a, aa) || !absInt(b, bb)) {
+    return false;
+  }
+  while (bb != 0) {
+    const int64_t m = aa % bb;
+    aa = bb;
+    bb = m;
+  }
+  r = aa;
+  return true;
+}
+
+inline bool calcInt(Operation::Type type, int64_t a, int64_t b, int64_t &r) {
+  switch (type) {
+    case Operation::Type::MOV:
+      r = b;
+      return true;
+    case Operation::Type::ADD:
+      return addInt(a, b, r);
+    case Operation::Type::SUB:
+      return subInt(a, b, r);
+    case Operation::Type::TRN:
+      if (!subInt(a, b, r)) {
+        return false;
+      }
+      r = (r < 0) ? 0 : r;
+      return true;
+    case Operation::Type::MUL:
+      return mulInt(a, b, r);
+    case Operation::Type::DIV:
+      if (b == 0 || (a == MIN_INT && b == -1)) {
+        return false;
+      }
+      r = a / b;
+      return true;
+    case Operation::Type::DIF:
+      return difInt(a, b, r);
+    case Operation::Type::DIR:
+      return dirInt(a, b, r);
+    case Operation::Type::MOD:
+      if (b == 0) {
+        return false;
+      }
+      r = (b == -1) ? 0 : a % b;
+      return true;
+    case Operation::Type::POW:
+      return powInt(a, b, r);
+    case Operation::Type::GCD:
+      return gcdInt(a, b, r);
+    case Operation::Type::EQU:
+      r = (a == b) ? 1 : 0;
+      return true;
+    case Operation::Type::NEQ:
+      r = (a != b) ? 1 : 0;
+      return true;
+    case Operation::Type::LEQ:
+      r = (a <= b) ? 1 : 0;
+      return true;
+    case Operation::Type::GEQ:
+      r = (a >= b) ? 1 : 0;
+      return true;
+    case Operation::Type::MIN:
+      r = (a < b) ? a : b;
+      return true;
+    case Operation::Type::MAX:
+      r = (a < b) ? b : a;
+      return true;
+    case Operation::Type::BAN:
+      r = a & b;
+      return true;
+    case Operation::Type::BOR:
+      r = a | b;
+      return true;
+    case Operation::Type::BXO:
+      r = a ^ b;
+      return true;
+    default:
+      return false;
+  }
+}
+
+inline bool isSupportedType(Operation::Type type) {
+  switch (type) {
+    case Operation::Type::MOV:
+    case Operation::Type::ADD:
+    case Operation::Type::SUB:
+    case Operation::Type::TRN:
+    case Operation::Type::MUL:
+    case Operation::Type::DIV:
+    case Operation::Type::DIF:
+    case Operation::Type::DIR:
+    case Operation::Type::MOD:
+    case Operation::Type::POW:
+    case Operation::Type::GCD:
+    case Operation::Type::EQU:
+    case Operation::Type::NEQ:
+    case Operation::Type::LEQ:
+    case Operation::Type::GEQ:
+    case Operation::Type::MIN:
+    case Operation::Type::MAX:
+    case Operation::Type::BAN:
+    case Operation::Type::BOR:
+    case Operation::Type::BXO:
+    case Operation::Type::LPB:
+    case Operation::Type::LPE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+Int64Interpreter::Int64Interpreter(const Settings &settings)
+    : settings(settings), initialized(false) {}
+
+bool Int64Interpreter::init(const Bytecode &bc) {
+  initialized = false;
+  code.clear();
+  ops.clear();
+  // the memory usage of the regular interpreter must not exceed the limit
+  if (bc.needs_fragments || bc.has_region_ops ||
+      (settings.max_memory >= 0 && settings.max_memory < MEMORY_CACHE_SIZE)) {
+    return false;
+  }
+  auto isCell = [](int64_t index) {
+    return index >= 0 && index < MEMORY_CACHE_SIZE;
+  };
+  for (size_t i = 0; i < bc.code.size(); i++) {
+    const auto &in = bc.code[i];
+    if (!isSupportedType(in.type) ||
+        (in.type != Operation::Type::LPE &&
+         (in.target_type != Operand::Type::DIRECT || !isCell(in.target)))) {
+      return false;
+    }
+    Instruction ins;
+    ins.type = in.type;
+    ins.target = in.target;
+    ins.jump = in.jump;
+    ins.constant_source = (in.source_type == Operand::Type::CONSTANT);
+    if (in.type == Operation::Type::LPB || in.type == Operation::Type::LPE) {
+      ins.source = 0;
+    } else if (ins.constant_source) {
+      const auto &c = bc.constants[in.source];
+      if (!c.fitsInInt64()) {
+        return false;
+      }
+      ins.source = c.asInt();
+    } else if (in.source_type == Operand::Type::DIRECT && isCell(in.source)) {
+      ins.source = in.source;
+    } else {
+      return false;
+    }
+    code.push_back(ins);
+  }
+  ops = bc.ops;
+  initialized = true;
+  return true;
+}
+
+bool Int64Interpreter::run(Memory &mem, size_t &steps) {
+  if (!initialized) {
+    throw std::runtime_error("int64 interpreter not initialized");
+  }
+  bool ok = mem.approximate_size() == MEMORY_CACHE_SIZE;
+  for (int64_t i = 0; ok && i < MEMORY_CACHE_SIZE; i++) {
+    const auto v = mem.get(i);
+    if (v.fitsInInt64()) {
+      cells[i] = v.asInt();
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok || !exec(steps)) {
+    return false;
+  }
+  for (int64_t i = 0; i < MEMORY_CACHE_SIZE; i++) {
+    mem.set(i, cells[i]);
+  }
+  return true;
+}
+
+bool Int64Interpreter::exec(size_t &steps) {
+  mem_stack.clear();
+  counter_stack.clear();
+  size_t cycles = 0;
+  const size_t max_cycles =
+      (settings.max_cycles >= 0) ? settings.max_cycles
+                                 : std::numeric_limits<size_t>::max();
+  const size_t num_ins = code.size();
+  size_t pc = 0, pc_next;
+  int64_t source;
+  while (pc < num_ins) {
+    const auto &ins = code[pc];
+    pc_next = pc + 1;
+    switch (ins.type) {
+      case Operation::Type::LPB:
+        if (mem_stack.size() >= 100) {  // magic number
+          return false;
+        }
+        mem_stack.push_back(cells);
+        counter_stack.push_back(cells[ins.target]);
+        break;
+      case Operation::Type::LPE: {
+        const int64_t counter = cells[code[ins.jump].target];
+        if (-1 < counter && counter < counter_stack.back()) {
+          pc_next = ins.jump + 1;  // jump back to begin
+          mem_stack.back() = cells;
+          counter_stack.back() = counter;
+        } else {
+          cells = mem_stack.back();
+          mem_stack.pop_back();
+          counter_stack.pop_back();
+        }
+        break;
+      }
+      default:
+        source = ins.constant_source ? ins.source : cells[ins.source];
+        if (!calcInt(ins.type, cells[ins.target], source,
+                     cells[ins.target])) {
+          return false;
+        }
+        break;
+    }
+    // count execution steps
+    if (++cycles > max_cycles) {
+      throw std::runtime_error("Exceeded maximum number of steps (" +
+                               std::to_string(max_cycles) +
+                               "); last operation: " +
+                               ProgramUtil::operationToString(ops[pc]));
+    }
+    // check for external interrupt
+    if (Signals::HALT) {
+      throw std::runtime_error("interpreter interrupted by halt signal");
+    }
+    pc = pc_next;
+  }
+  steps = cycles;
+  return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "eval/bytecode.hpp"
+#include "eval/memory.hpp"
+#include "sys/util.hpp"
+
+// Fast-path interpreter for programs that run on machine integers. The memory
+// cells are kept as raw 64-bit integers and every operation uses checked
+// arithmetic. If a result does not fit into 64 bits, or if an operation would
+// fail, the execution is aborted and the term must be evaluated again using
+// the regular interpreter ("deoptimization"). Only programs with direct
+// operands in the first memory cells, simple loops and arithmetic operations
+// are supported. The results and the number of execution steps are the same
+// as for the regular interpreter.
+class Int64Interpreter {
+ public:
+  explicit Int64Interpreter(const Settings &settings);
+
+  // Initialize the interpreter using a compiled program. The fast path can be
+  // used only if this function returns true.
+  bool init(const Bytecode &bc);
+
+  // Run the program. Returns false if the program must be run using the
+  // regular interpreter; in this case the memory is not changed. Throws an
+  // exception if the maximum number of steps is exceeded.
+  bool run(Memory &mem, size_t &steps);
+
+ private:
+  using Cells = std::array<int64_t, MEMORY_CACHE_SIZE>;
+
+  class Instruction {
+   public:
+    Operation::Type type;
+    bool constant_source;
+    int64_t target;  // cell index
+    int64_t source;  // cell index or constant value
+    size_t jump;     // for lpe: index of the matching lpb
+  };
+
+  bool exec(size_t &steps);
+
+  const Settings &settings;
+  std::vector<Instruction> code;
+  std::vector<Operation> ops;  // original operations for error messages
+  Cells cells;
+  std::vector<Cells> mem_stack;
+  std::vector<int64_t> counter_stack;
+  bool initialized;
+};
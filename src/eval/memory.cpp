@@ -234,3 +234,52 @@ std::ostream &operator<<(std::ostream &out, const Memory &m) {
   }
   return out;
 }
+
+void MemoryJournal::push() { levels.push_back(entries.size()); }
+
+bool MemoryJournal::contains(int64_t index, size_t begin, size_t end) const {
+  for (size_t i = begin; i < end; i++) {
+    if (entries[i].first == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void MemoryJournal::recordCell(const Memory &mem, int64_t index) {
+  // only the first write per iteration needs to be recorded
+  if (!contains(index, levels.back(), entries.size())) {
+    entries.emplace_back(index, mem.get(index));
+  }
+}
+
+void MemoryJournal::commit() {
+  const size_t start = levels.back();
+  if (levels.size() == 1) {
+    entries.resize(start);
+    return;
+  }
+  // merge the entries into the parent level unless the parent level already
+  // contains an older value of the same cell
+  const size_t parent_start = levels[levels.size() - 2];
+  size_t pos = start;
+  for (size_t i = start; i < entries.size(); i++) {
+    if (!contains(entries[i].first, parent_start, start)) {
+      if (pos != i) {
+        entries[pos] = std::move(entries[i]);
+      }
+      pos++;
+    }
+  }
+  entries.resize(pos);
+  levels.back() = pos;
+}
+
+void MemoryJournal::rollback(Memory &mem) {
+  const size_t start = levels.back();
+  for (size_t i = start; i < entries.size(); i++) {
+    mem.set(entries[i].first, entries[i].second);
+  }
+  entries.resize(start);
+  levels.pop_back();
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "math/number.hpp"
 
@@ -45,3 +46,39 @@ class Memory {
   std::array<Number, MEMORY_CACHE_SIZE> cache;
   std::unordered_map<int64_t, Number> full;
 };
+
+// Undo log of memory cells written inside of loops. Instead of copying the
+// full memory at every loop iteration, only the original values of the cells
+// written during the current iteration are recorded. This allows restoring
+// the memory state when the loop terminates. Each nested loop has its own
+// level in the journal. It can be used only if all memory writes are recorded,
+// i.e., not for region operations.
+class MemoryJournal {
+ public:
+  // Begin a new (nested) loop level.
+  void push();
+
+  // Record the current value of a cell before it is written.
+  inline void record(const Memory &mem, int64_t index) {
+    if (!levels.empty()) {
+      recordCell(mem, index);
+    }
+  }
+
+  // Finish the current iteration of the innermost loop and keep its changes.
+  void commit();
+
+  // Restore the cells written in the current iteration of the innermost loop
+  // and remove its level from the journal.
+  void rollback(Memory &mem);
+
+  size_t depth() const { return levels.size(); }
+
+ private:
+  void recordCell(const Memory &mem, int64_t index);
+
+  bool contains(int64_t index, size_t begin, size_t end) const;
+
+  std::vector<std::pair<int64_t, Number>> entries;
+  std::vector<size_t> levels;  // start positions of the levels in entries
+};
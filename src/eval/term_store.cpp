@@ -0,0 +1,245 @@
+#include "eval/term_store.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "sys/file.hpp"
+#include "sys/log.hpp"
+
+// Number of buffered terms per sequence before they are written (magic number)
+constexpr size_t MAX_PENDING_TERMS = 100;
+
+// Maximum number of terms per sequence kept in memory (magic number)
+constexpr size_t MAX_LOADED_TERMS = 1000000;
+
+// Minimum time between two checks for terms of other processes
+constexpr int64_t REFRESH_INTERVAL_MS = 1000;
+
+// Minimum age of files of outdated program versions before they are deleted
+constexpr int64_t OUTDATED_FILE_HOURS = 7 * 24;
+
+// Records are stored together with the key to detect outdated entries.
+constexpr size_t RECORD_SIZE = 4 * sizeof(int64_t);
+
+// Number of active bypasses in the current thread
+thread_local size_t num_bypasses = 0;
+
+TermStore& TermStore::get() {
+  static TermStore store;
+  return store;
+}
+
+TermStore::TermStore() : is_open(false), num_hits(0), num_misses(0) {}
+
+TermStore::~TermStore() { close(); }
+
+void TermStore::open(const std::string& folder) {
+  close();
+  std::lock_guard<std::mutex> guard(mutex);
+  this->folder = folder;
+  ensureTrailingFileSep(this->folder);
+  ensureDir(this->folder);
+  tables.clear();
+  prune();
+  is_open = true;
+  Log::get().debug("Using term store in \"" + this->folder + "\"");
+}
+
+void TermStore::close() {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (!is_open) {
+    return;
+  }
+  for (auto& it : tables) {
+    flush(it.first, it.second);
+  }
+  tables.clear();
+  is_open = false;
+}
+
+bool TermStore::isEnabled() const { return is_open && num_bypasses == 0; }
+
+TermStore::Bypass::Bypass() { num_bypasses++; }
+
+TermStore::Bypass::~Bypass() { num_bypasses--; }
+
+std::string TermStore::getPath(UID id, uint64_t key) const {
+  std::stringstream buf;
+  buf << folder << id.string() << "_" << std::hex << std::setw(16)
+      << std::setfill('0') << key << ".bin";
+  return buf.str();
+}
+
+bool TermStore::lookup(UID id, uint64_t key, int64_t arg, int64_t& value,
+                       size_t& steps) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (!is_open) {
+    return false;
+  }
+  auto& table = getTable(id, key);
+  auto it = table.terms.find(arg);
+  if (it == table.terms.end()) {
+    // check for new terms of other processes
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - table.last_refresh)
+            .count() >= REFRESH_INTERVAL_MS) {
+      refresh(id, table);
+      it = table.terms.find(arg);
+    }
+  }
+  if (it == table.terms.end()) {
+    num_misses++;
+    return false;
+  }
+  value = it->second.first;
+  steps = it->second.second;
+  num_hits++;
+  return true;
+}
+
+void TermStore::insert(UID id, uint64_t key, int64_t arg, int64_t value,
+                       size_t steps) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (!is_open) {
+    return;
+  }
+  auto& table = getTable(id, key);
+  if (table.terms.size() >= MAX_LOADED_TERMS ||
+      !table.terms.emplace(arg, std::make_pair(value, steps)).second) {
+    return;
+  }
+  table.pending.push_back({arg, value, static_cast<uint64_t>(steps)});
+  if (table.pending.size() >= MAX_PENDING_TERMS) {
+    flush(id, table);
+  }
+}
+
+void TermStore::flush() {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (!is_open) {
+    return;
+  }
+  for (auto& it : tables) {
+    flush(it.first, it.second);
+  }
+}
+
+void TermStore::resetCounters() {
+  num_hits = 0;
+  num_misses = 0;
+}
+
+void TermStore::prune() {
+  // find the most recently modified file of every sequence
+  using file_time = std::filesystem::file_time_type;
+  std::vector<std::pair<std::filesystem::path, file_time>> files;
+  std::unordered_map<std::string, file_time> latest;
+  std::error_code ec;
+  for (const auto& f : std::filesystem::directory_iterator(folder, ec)) {
+    const auto name = f.path().filename().string();
+    const auto pos = name.find('_');
+    if (pos == std::string::npos || f.path().extension() != ".bin") {
+      continue;
+    }
+    const auto time = std::filesystem::last_write_time(f.path(), ec);
+    if (ec) {
+      continue;
+    }
+    files.emplace_back(f.path(), time);
+    auto it = latest.emplace(name.substr(0, pos), time).first;
+    it->second = std::max(it->second, time);
+  }
+  // delete the other files if they have not been modified for a while
+  const auto min_time =
+      file_time::clock::now() - std::chrono::hours(OUTDATED_FILE_HOURS);
+  size_t num_deleted = 0;
+  for (const auto& f : files) {
+    const auto name = f.first.filename().string();
+    const auto& t = latest[name.substr(0, name.find('_'))];
+    if (f.second < t && f.second < min_time &&
+        std::filesystem::remove(f.first, ec)) {
+      num_deleted++;
+    }
+  }
+  if (num_deleted) {
+    Log::get().debug("Deleted " + std::to_string(num_deleted) +
+                     " outdated term store files");
+  }
+}
+
+TermStore::Table& TermStore::getTable(UID id, uint64_t key) {
+  auto& table = tables[id];
+  if (!table.loaded || table.key != key) {
+    // new table or program has changed
+    flush(id, table);
+    table.loaded = true;
+    table.key = key;
+    table.loaded_size = 0;
+    table.terms.clear();
+    table.pending.clear();
+    refresh(id, table);
+  }
+  return table;
+}
+
+void TermStore::refresh(UID id, Table& table) {
+  table.last_refresh = std::chrono::steady_clock::now();
+  const auto path = getPath(id, table.key);
+  if (!isFile(path)) {
+    table.loaded_size = 0;
+    return;
+  }
+  try {
+    MappedFile file(path);
+    const size_t size = file.size() - (file.size() % RECORD_SIZE);
+    if (size < table.loaded_size) {
+      table.loaded_size = 0;  // file was reset by another process
+    }
+    int64_t record[4];
+    for (size_t pos = table.loaded_size; pos < size; pos += RECORD_SIZE) {
+      std::memcpy(record, file.data() + pos, RECORD_SIZE);
+      if (static_cast<uint64_t>(record[0]) != table.key) {
+        continue;  // corrupt record
+      }
+      if (table.terms.size() < MAX_LOADED_TERMS) {
+        table.terms.emplace(record[1],
+                            std::make_pair(record[2],
+                                           static_cast<size_t>(record[3])));
+      }
+    }
+    table.loaded_size = size;
+  } catch (const std::exception& e) {
+    Log::get().warn("Cannot read term store file " + path + ": " + e.what());
+  }
+}
+
+void TermStore::flush(UID id, Table& table) {
+  if (table.pending.empty()) {
+    return;
+  }
+  const auto path = getPath(id, table.key);
+  std::ofstream out(path, std::ios::binary | std::ios::app);
+  if (!out) {
+    // try again later, but don't buffer too many terms
+    if (table.pending.size() >= 10 * MAX_PENDING_TERMS) {
+      table.pending.clear();
+    }
+    return;
+  }
+  std::vector<int64_t> buf;
+  buf.reserve(4 * table.pending.size());
+  for (const auto& r : table.pending) {
+    buf.push_back(static_cast<int64_t>(table.key));
+    buf.push_back(r.arg);
+    buf.push_back(r.value);
+    buf.push_back(static_cast<int64_t>(r.steps));
+  }
+  out.write(reinterpret_cast<const char*>(buf.data()),
+            buf.size() * sizeof(int64_t));
+  table.pending.clear();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/uid.hpp"
+
+// Persistent store of evaluated sequence terms that is shared between
+// processes. For every sequence and key, there is an append-only file of
+// fixed-size records (key, argument, value, steps) in the store folder. The
+// key is derived from the hash of the sequence program and its dependencies,
+// so processes using different program versions write to different files.
+// New terms are buffered and appended in batches. Terms written by other
+// processes are picked up by re-mapping the file when it has grown. Files of
+// outdated program versions are deleted when the store is opened.
+class TermStore {
+ public:
+  static TermStore &get();
+
+  // Open the store in the given folder. The store is disabled until opened.
+  void open(const std::string &folder);
+
+  // Flush pending terms and disable the store.
+  void close();
+
+  bool isOpen() const { return is_open; }
+
+  // Returns true if the store is open and not bypassed by the current thread.
+  bool isEnabled() const;
+
+  // Bypass the store in the current thread while in scope. Used when
+  // validating programs, because stored terms could hide recursive calls.
+  class Bypass {
+   public:
+    Bypass();
+    ~Bypass();
+  };
+
+  // Look up the value and the number of steps of a term. The key must be the
+  // same as the one used for inserting the term.
+  bool lookup(UID id, uint64_t key, int64_t arg, int64_t &value,
+              size_t &steps);
+
+  void insert(UID id, uint64_t key, int64_t arg, int64_t value, size_t steps);
+
+  // Append all pending terms to the files.
+  void flush();
+
+  size_t getNumHits() const { return num_hits; }
+
+  size_t getNumMisses() const { return num_misses; }
+
+  void resetCounters();
+
+  ~TermStore();
+
+ private:
+  class Record {
+   public:
+    int64_t arg;
+    int64_t value;
+    uint64_t steps;
+  };
+
+  class Table {
+   public:
+    bool loaded = false;
+    uint64_t key = 0;
+    size_t loaded_size = 0;
+    std::chrono::time_point<std::chrono::steady_clock> last_refresh;
+    std::unordered_map<int64_t, std::pair<int64_t, size_t>> terms;
+    std::vector<Record> pending;
+  };
+
+  TermStore();
+
+  std::string getPath(UID id, uint64_t key) const;
+
+  // Delete files of outdated program versions that have not been modified
+  // recently. The most recent file of every sequence is always kept.
+  void prune();
+
+  Table &getTable(UID id, uint64_t key);
+
+  void refresh(UID id, Table &table);
+
+  void flush(UID id, Table &table);
+
+  std::string folder;
+  bool is_open;
+  std::mutex mutex;
+  std::unordered_map<UID, Table> tables;
+  std::atomic<size_t> num_hits;
+  std::atomic<size_t> num_misses;
+};
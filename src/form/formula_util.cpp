@@ -97,6 +97,18 @@ std::multimap<std::string, std::string> FormulaUtil::getDependencies(
   return deps;
 }
 
+std::vector<std::string> FormulaUtil::getRecursiveDefinitions(
+    const Formula& formula, const Expression::Type type) {
+  auto deps = getDependencies(formula, type, true, false);
+  std::vector<std::string> result;
+  for (const auto& name : getDefinitions(formula, type)) {
+    if (containsPair(deps, name, name)) {
+      result.push_back(name);
+    }
+  }
+  return result;
+}
+
 void FormulaUtil::removeFunctionEntries(Formula& formula,
                                         const std::string& funcName) {
   auto entryIt = formula.entries.begin();
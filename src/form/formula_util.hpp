@@ -14,6 +14,12 @@ class FormulaUtil {
       const Expression::Type type = Expression::Type::FUNCTION,
       bool transitive = false, bool ignoreSelf = false);
 
+  // Get the definitions that depend on themselves, directly or via other
+  // definitions (mutual recursion).
+  static std::vector<std::string> getRecursiveDefinitions(
+      const Formula& formula,
+      const Expression::Type type = Expression::Type::FUNCTION);
+
   static void removeFunctionEntries(Formula& formula,
                                     const std::string& funcName);
 };
@@ -0,0 +1,451 @@
+#include "form/native.hpp"
+
+#include <stdexcept>
+
+#include "form/expression_util.hpp"
+#include "form/formula_util.hpp"
+#include "form/pari.hpp"
+#include "math/semantics.hpp"
+#include "sys/log.hpp"
+
+// Maximum number of evaluated expressions per call of evalNative()
+const int64_t NATIVE_MAX_STEPS = 100000000;
+
+// Maximum nesting depth of function calls
+const int64_t NATIVE_MAX_DEPTH = 1000;
+
+// Number of arguments of supported built-in functions (-1 for 1 or 2)
+const std::map<std::string, int64_t> NATIVE_BUILTINS = {
+    {"abs", 1},       {"sign", 1},      {"floor", 1},     {"truncate", 1},
+    {"sqrtint", 1},   {"min", 2},       {"max", 2},       {"gcd", 2},
+    {"binomial", 2},  {"sqrtnint", 2},  {"logint", 2},    {"bitand", 2},
+    {"bitor", 2},     {"bitxor", 2},    {"valuation", 2}, {"sumdigits", -1}};
+
+void throwNativeError(const std::string& msg) {
+  throw std::runtime_error("native evaluation error: " + msg);
+}
+
+inline const Number& checkNative(const Number& n) {
+  if (n == Number::INF) {
+    throwNativeError("overflow");
+  }
+  return n;
+}
+
+inline bool isComparison(const Expression& e) {
+  return e.type == Expression::Type::EQUAL ||
+         e.type == Expression::Type::NOT_EQUAL ||
+         e.type == Expression::Type::LESS_EQUAL ||
+         e.type == Expression::Type::GREATER_EQUAL;
+}
+
+bool NativeFormula::convert(const Formula& formula,
+                            NativeFormula& native_formula) {
+  native_formula = {};
+  native_formula.main_formula = formula;
+  auto& functions = native_formula.functions;
+  auto& index = native_formula.function_index;
+  bool supported = true;
+  // functions are indexed in the order of their dependencies
+  for (const auto& name : FormulaUtil::getDefinitions(
+           formula, Expression::Type::FUNCTION, true)) {
+    index[name] = functions.size();
+    functions.emplace_back();
+  }
+  for (const auto& entry : formula.entries) {
+    const auto& left = entry.first;
+    if (left.type != Expression::Type::FUNCTION || left.children.size() != 1) {
+      supported = false;
+      continue;
+    }
+    auto& f = functions[index.at(left.name)];
+    const auto& arg = left.children.front();
+    if (arg.type == Expression::Type::PARAMETER && !f.has_general) {
+      f.param = arg.name;
+      f.general = entry.second;
+      f.has_general = true;
+    } else if (arg.type == Expression::Type::CONSTANT &&
+               arg.value.fitsInInt64()) {
+      f.initial_terms[arg.value.asInt()] = entry.second;
+    } else {
+      supported = false;
+    }
+  }
+  if (index.find("a") == index.end()) {
+    supported = false;
+  }
+  const auto defs = FormulaUtil::getDefinitions(formula);
+  for (const auto& name : FormulaUtil::getRecursiveDefinitions(formula)) {
+    auto& f = functions[index.at(name)];
+    if (f.has_general && !f.initial_terms.empty() &&
+        !ExpressionUtil::hasNonRecursiveFunctionReference(f.general, defs,
+                                                          0)) {
+      f.bottom_up = true;
+      f.start = f.initial_terms.begin()->first;
+    }
+  }
+  for (const auto& entry : formula.entries) {
+    if (!native_formula.isSupported(entry.second)) {
+      supported = false;
+    }
+  }
+  native_formula.supported = supported;
+  return true;
+}
+
+std::string NativeFormula::toString() const { return main_formula.toString(); }
+
+bool NativeFormula::isSupported(const Expression& e) const {
+  size_t min_args = 0, max_args = SIZE_MAX;
+  switch (e.type) {
+    case Expression::Type::CONSTANT:
+    case Expression::Type::PARAMETER:
+      break;
+    case Expression::Type::FUNCTION: {
+      if (function_index.find(e.name) != function_index.end()) {
+        min_args = max_args = 1;
+        break;
+      }
+      auto it = NATIVE_BUILTINS.find(e.name);
+      if (it == NATIVE_BUILTINS.end()) {
+        return false;  // e.g. references to other sequences
+      }
+      min_args = (it->second < 0) ? 1 : it->second;
+      max_args = (it->second < 0) ? 2 : it->second;
+      break;
+    }
+    case Expression::Type::VECTOR:
+      return false;
+    case Expression::Type::SUM:
+    case Expression::Type::PRODUCT:
+      min_args = 1;
+      break;
+    case Expression::Type::LOCAL:
+    case Expression::Type::FRACTION:
+    case Expression::Type::POWER:
+    case Expression::Type::MODULUS:
+    case Expression::Type::EQUAL:
+    case Expression::Type::NOT_EQUAL:
+    case Expression::Type::LESS_EQUAL:
+    case Expression::Type::GREATER_EQUAL:
+      min_args = max_args = 2;
+      break;
+    case Expression::Type::IF:
+      min_args = max_args = 3;
+      break;
+    case Expression::Type::FACTORIAL:
+      min_args = max_args = 1;
+      break;
+  }
+  if (e.children.size() < min_args || e.children.size() > max_args) {
+    return false;
+  }
+  for (const auto& c : e.children) {
+    if (!isSupported(c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NativeFormula::checkLimits(Context& ctx) const {
+  if (ctx.steps > NATIVE_MAX_STEPS ||
+      std::chrono::steady_clock::now() > ctx.deadline) {
+    ctx.aborted = true;
+    throwNativeError("limit reached");
+  }
+}
+
+Number floorDiv(const Number& a, const Number& b, bool round_down) {
+  if (b == Number::ZERO) {
+    throwNativeError("division by zero");
+  }
+  auto q = Semantics::div(a, b);
+  if (round_down && Semantics::mod(a, b) != Number::ZERO &&
+      ((a < Number::ZERO) != (b < Number::ZERO))) {
+    q -= Number::ONE;
+  }
+  return checkNative(q);
+}
+
+Number NativeFormula::evalExpr(const Expression& e, Context& ctx) const {
+  if ((++ctx.steps & 4095) == 0) {
+    checkLimits(ctx);
+  }
+  switch (e.type) {
+    case Expression::Type::CONSTANT:
+      return e.value;
+    case Expression::Type::PARAMETER: {
+      for (auto it = ctx.vars.rbegin(); it != ctx.vars.rend(); ++it) {
+        if (it->first == e.name) {
+          return it->second;
+        }
+      }
+      throwNativeError("unbound parameter " + e.name);
+      break;
+    }
+    case Expression::Type::FUNCTION: {
+      auto it = function_index.find(e.name);
+      if (it != function_index.end()) {
+        return evalCall(it->second, evalExpr(e.children.front(), ctx), ctx);
+      }
+      return evalBuiltin(e, ctx);
+    }
+    case Expression::Type::LOCAL: {
+      auto value = evalExpr(e.children[0], ctx);
+      ctx.vars.emplace_back(e.name, value);
+      auto r = evalExpr(e.children[1], ctx);
+      ctx.vars.pop_back();
+      return r;
+    }
+    case Expression::Type::SUM: {
+      auto r = evalExpr(e.children.front(), ctx);
+      for (size_t i = 1; i < e.children.size(); i++) {
+        r += evalExpr(e.children[i], ctx);
+      }
+      return checkNative(r);
+    }
+    case Expression::Type::PRODUCT: {
+      auto r = evalExpr(e.children.front(), ctx);
+      for (size_t i = 1; i < e.children.size(); i++) {
+        r *= evalExpr(e.children[i], ctx);
+      }
+      return checkNative(r);
+    }
+    case Expression::Type::FRACTION: {
+      // only exact divisions yield integers
+      auto a = evalExpr(e.children[0], ctx);
+      auto b = evalExpr(e.children[1], ctx);
+      if (b == Number::ZERO || Semantics::mod(a, b) != Number::ZERO) {
+        throwNativeError("non-integer fraction");
+      }
+      return checkNative(Semantics::div(a, b));
+    }
+    case Expression::Type::POWER: {
+      auto base = evalExpr(e.children[0], ctx);
+      auto exp = evalExpr(e.children[1], ctx);
+      if (exp < Number::ZERO && base != Number::ONE &&
+          base != Number::MINUS_ONE) {
+        throwNativeError("negative exponent");
+      }
+      return checkNative(Semantics::pow(base, exp));
+    }
+    case Expression::Type::MODULUS: {
+      auto a = evalExpr(e.children[0], ctx);
+      auto b = evalExpr(e.children[1], ctx);
+      if (b == Number::ZERO) {
+        throwNativeError("division by zero");
+      }
+      auto r = Semantics::mod(a, b);
+      if (r < Number::ZERO) {
+        r += Semantics::abs(b);
+      }
+      return checkNative(r);
+    }
+    case Expression::Type::IF: {
+      bool cond;
+      if (isComparison(e.children[0])) {
+        cond = evalExpr(e.children[0], ctx) != Number::ZERO;
+      } else {
+        // legacy form: if(n==value,...)
+        Expression n(Expression::Type::PARAMETER, "n");
+        cond = evalExpr(n, ctx) == evalExpr(e.children[0], ctx);
+      }
+      return evalExpr(e.children[cond ? 1 : 2], ctx);
+    }
+    case Expression::Type::EQUAL:
+      return evalExpr(e.children[0], ctx) == evalExpr(e.children[1], ctx);
+    case Expression::Type::NOT_EQUAL:
+      return evalExpr(e.children[0], ctx) != evalExpr(e.children[1], ctx);
+    case Expression::Type::LESS_EQUAL:
+      return evalExpr(e.children[0], ctx) <= evalExpr(e.children[1], ctx);
+    case Expression::Type::GREATER_EQUAL:
+      return evalExpr(e.children[0], ctx) >= evalExpr(e.children[1], ctx);
+    case Expression::Type::FACTORIAL: {
+      auto n = evalExpr(e.children[0], ctx);
+      if (n < Number::ZERO) {
+        throwNativeError("negative factorial");
+      }
+      return checkNative(Semantics::fac(Number::ONE, n));
+    }
+    case Expression::Type::VECTOR:
+      break;
+  }
+  throwNativeError("unsupported expression " + e.toString());
+  return Number::ZERO;  // unreachable
+}
+
+Number NativeFormula::evalCall(size_t index, const Number& arg,
+                               Context& ctx) const {
+  if (!arg.fitsInInt64()) {
+    throwNativeError("argument out of range");
+  }
+  const int64_t n = arg.asInt();
+  const auto& f = functions[index];
+  if (f.bottom_up && n >= f.start && !ctx.in_progress[index]) {
+    // compute all terms up to n; the recursive calls refer only to terms
+    // that were already computed
+    auto& values = ctx.values[index];
+    ctx.in_progress[index] = true;
+    while (f.start + static_cast<int64_t>(values.size()) <= n) {
+      const int64_t k = f.start + static_cast<int64_t>(values.size());
+      values.push_back(evalTerm(index, k, ctx));
+    }
+    ctx.in_progress[index] = false;
+    return values[n - f.start];
+  }
+  if (f.bottom_up && n >= f.start &&
+      n < f.start + static_cast<int64_t>(ctx.values[index].size())) {
+    return ctx.values[index][n - f.start];
+  }
+  auto& memo = ctx.memo[index];
+  auto it = memo.find(n);
+  if (it != memo.end()) {
+    return it->second;
+  }
+  auto result = evalTerm(index, n, ctx);
+  memo[n] = result;
+  return result;
+}
+
+Number NativeFormula::evalTerm(size_t index, int64_t n, Context& ctx) const {
+  const auto& f = functions[index];
+  auto init = f.initial_terms.find(n);
+  Number result;
+  if (++ctx.depth > NATIVE_MAX_DEPTH) {
+    throwNativeError("recursion too deep");
+  }
+  if (init != f.initial_terms.end()) {
+    result = evalExpr(init->second, ctx);
+  } else if (f.has_general) {
+    ctx.vars.emplace_back(f.param, n);
+    result = evalExpr(f.general, ctx);
+    ctx.vars.pop_back();
+  } else {
+    throwNativeError("undefined function value");
+  }
+  ctx.depth--;
+  return result;
+}
+
+Number NativeFormula::evalBuiltin(const Expression& e, Context& ctx) const {
+  const auto& name = e.name;
+  if (name == "floor" || name == "truncate") {
+    const auto& c = e.children.front();
+    if (c.type == Expression::Type::FRACTION) {
+      return floorDiv(evalExpr(c.children[0], ctx),
+                      evalExpr(c.children[1], ctx), name == "floor");
+    }
+    return evalExpr(c, ctx);
+  }
+  std::vector<Number> args;
+  for (const auto& c : e.children) {
+    args.push_back(evalExpr(c, ctx));
+  }
+  const auto& x = args[0];
+  if (name == "abs") {
+    return Semantics::abs(x);
+  } else if (name == "sign") {
+    return (x < Number::ZERO) ? -1 : (x == Number::ZERO ? 0 : 1);
+  } else if (name == "sqrtint") {
+    if (x < Number::ZERO) {
+      throwNativeError("negative sqrtint argument");
+    }
+    return checkNative(Semantics::nrt(x, 2));
+  } else if (name == "sumdigits") {
+    const Number b = (args.size() > 1) ? args[1] : Number(10);
+    if (b < Number::TWO) {
+      throwNativeError("invalid sumdigits base");
+    }
+    return checkNative(Semantics::dgs(Semantics::abs(x), b));
+  }
+  const auto& y = args[1];
+  if (name == "min") {
+    return Semantics::min(x, y);
+  } else if (name == "max") {
+    return Semantics::max(x, y);
+  } else if (name == "gcd") {
+    return checkNative(Semantics::gcd(x, y));
+  } else if (name == "binomial") {
+    if (y < Number::ZERO) {
+      return Number::ZERO;
+    }
+    return checkNative(Semantics::bin(x, y));
+  } else if (name == "sqrtnint") {
+    if (x < Number::ZERO || y < Number::ONE) {
+      throwNativeError("invalid sqrtnint arguments");
+    }
+    return checkNative(Semantics::nrt(x, y));
+  } else if (name == "logint") {
+    if (x < Number::ONE || y < Number::TWO) {
+      throwNativeError("invalid logint arguments");
+    }
+    return checkNative(Semantics::log(x, y));
+  } else if (name == "valuation") {
+    if (x == Number::ZERO || y < Number::TWO) {
+      throwNativeError("invalid valuation arguments");
+    }
+    auto v = x;
+    int64_t r = 0;
+    while (Semantics::mod(v, y) == Number::ZERO) {
+      v = Semantics::div(v, y);
+      r++;
+    }
+    return r;
+  }
+  // bitwise operations on two's complement numbers are left to PARI/GP
+  if (x < Number::ZERO || y < Number::ZERO) {
+    throwNativeError("negative bitwise argument");
+  }
+  if (name == "bitand") {
+    return Semantics::ban(x, y);
+  } else if (name == "bitor") {
+    return Semantics::bor(x, y);
+  } else if (name == "bitxor") {
+    return Semantics::bxo(x, y);
+  }
+  throwNativeError("unsupported function " + name);
+  return Number::ZERO;  // unreachable
+}
+
+bool NativeFormula::evalNative(int64_t offset, int64_t numTerms,
+                               int timeoutSeconds, Sequence& result) const {
+  if (!supported) {
+    throwNativeError("unsupported formula " + toString());
+  }
+  Context ctx;
+  ctx.memo.resize(functions.size());
+  ctx.values.resize(functions.size());
+  ctx.in_progress.resize(functions.size(), false);
+  ctx.deadline = std::chrono::steady_clock::now() +
+                 std::chrono::seconds(timeoutSeconds);
+  const size_t main_index = function_index.at("a");
+  result.clear();
+  try {
+    for (int64_t n = offset; n < offset + numTerms; n++) {
+      result.push_back(evalCall(main_index, n, ctx));
+    }
+  } catch (const std::exception&) {
+    if (ctx.aborted) {
+      return false;
+    }
+    throw;
+  }
+  return true;
+}
+
+bool NativeFormula::eval(int64_t offset, int64_t numTerms, int timeoutSeconds,
+                         Sequence& result) const {
+  if (supported) {
+    try {
+      return evalNative(offset, numTerms, timeoutSeconds, result);
+    } catch (const std::exception& e) {
+      Log::get().debug(std::string(e.what()) + "; using PARI/GP");
+    }
+  }
+  PariFormula pari;
+  if (!PariFormula::convert(main_formula, offset, false, pari)) {
+    throwNativeError("cannot convert formula to PARI/GP");
+  }
+  return pari.evalWithGP(offset, numTerms, timeoutSeconds, result);
+}
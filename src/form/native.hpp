@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <unordered_map>
+
+#include "form/formula.hpp"
+#include "math/sequence.hpp"
+
+/**
+ * In-process formula evaluator. Evaluates formulas directly on their
+ * expression trees using big-integer arithmetic with the semantics of
+ * PARI/GP. Calls of recursive functions are memoized and the evaluation is
+ * bounded by a step limit and a timeout. Recursive functions which refer only
+ * to preceding terms are computed bottom-up into arrays starting at their
+ * first initial term, so that mutually recursive functions evaluate in linear
+ * time without deep recursion. Formulas with constructs that are not
+ * supported natively are evaluated using PARI/GP.
+ *
+ * Example input formula:
+ * a(n) = a(n-1)+a(n-2), a(1) = 1, a(0) = 0
+ */
+class NativeFormula {
+ public:
+  NativeFormula() : supported(false) {}
+
+  static bool convert(const Formula& formula, NativeFormula& native_formula);
+
+  std::string toString() const;
+
+  // Returns true if the formula can be evaluated without external tools.
+  bool isSupported() const { return supported; }
+
+  // Evaluates the formula in process. Returns false if the timeout or the
+  // step limit was reached. Throws an exception if the formula is not
+  // supported or if a term cannot be evaluated.
+  bool evalNative(int64_t offset, int64_t numTerms, int timeoutSeconds,
+                  Sequence& result) const;
+
+  // Evaluates the formula for the given offset and number of terms, with a
+  // timeout in seconds. Returns true if successful, false if a timeout
+  // occurred. The result sequence is written to 'result'. Falls back to
+  // PARI/GP if the formula cannot be evaluated natively.
+  bool eval(int64_t offset, int64_t numTerms, int timeoutSeconds,
+            Sequence& result) const;
+
+  std::string getName() const { return "native"; }
+
+ private:
+  class Function {
+   public:
+    std::string param;
+    Expression general;
+    bool has_general = false;
+    bool bottom_up = false;
+    int64_t start = 0;  // first index of bottom-up evaluation
+    std::map<int64_t, Expression> initial_terms;
+  };
+
+  class Context {
+   public:
+    std::vector<std::unordered_map<int64_t, Number>> memo;
+    std::vector<std::vector<Number>> values;  // bottom-up computed terms
+    std::vector<bool> in_progress;
+    std::vector<std::pair<std::string, Number>> vars;
+    std::chrono::steady_clock::time_point deadline;
+    int64_t steps = 0;
+    int64_t depth = 0;
+    bool aborted = false;
+  };
+
+  bool isSupported(const Expression& e) const;
+
+  Number evalExpr(const Expression& e, Context& ctx) const;
+
+  Number evalCall(size_t index, const Number& arg, Context& ctx) const;
+
+  Number evalTerm(size_t index, int64_t n, Context& ctx) const;
+
+  Number evalBuiltin(const Expression& e, Context& ctx) const;
+
+  void checkLimits(Context& ctx) const;
+
+  Formula main_formula;
+  std::map<std::string, size_t> function_index;
+  std::vector<Function> functions;
+  bool supported;
+};
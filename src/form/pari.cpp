@@ -1,5 +1,6 @@
 #include "form/pari.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
@@ -91,6 +92,7 @@ bool PariFormula::convert(const Formula& formula, int64_t offset,
                           bool as_vector, PariFormula& pari_formula) {
   pari_formula = {};
   pari_formula.as_vector = as_vector;
+  NativeFormula::convert(formula, pari_formula.native_formula);
   auto defs = FormulaUtil::getDefinitions(formula, Expression::Type::FUNCTION);
   for (const auto& entry : formula.entries) {
     auto left = entry.first;
@@ -157,8 +159,28 @@ std::string PariFormula::printEvalCode(int64_t offset, int64_t numTerms) const {
       out << f << " = vector(" << numTerms << ")" << std::endl;
     }
   } else {
-    // main function
-    out << toString() << std::endl;
+    // recursive functions are memoized in maps, so that their terms are
+    // computed only once when evaluating the terms in increasing order
+    auto recursive = FormulaUtil::getRecursiveDefinitions(main_formula);
+    for (auto it = main_formula.entries.rbegin();
+         it != main_formula.entries.rend(); it++) {
+      const auto& left = it->first;
+      if (left.type != Expression::Type::FUNCTION ||
+          left.children.size() != 1 ||
+          left.children.front().type != Expression::Type::PARAMETER ||
+          std::find(recursive.begin(), recursive.end(), left.name) ==
+              recursive.end()) {
+        out << left << " = " << it->second << std::endl;
+        continue;
+      }
+      const auto& f = left.name;
+      const auto& p = left.children.front().name;
+      out << f << "_m = Map()" << std::endl;
+      out << f << "_f(" << p << ") = " << it->second << std::endl;
+      out << f << "(" << p << ") = my(r); if(!mapisdefined(" << f << "_m,"
+          << p << ",&r),r=" << f << "_f(" << p << "); mapput(" << f << "_m,"
+          << p << ",r)); r" << std::endl;
+    }
   }
   const int64_t end = offset + numTerms - 1;
   out << "for(n=" << offset << "," << end << ",";
@@ -175,6 +197,19 @@ std::string PariFormula::printEvalCode(int64_t offset, int64_t numTerms) const {
 
 bool PariFormula::eval(int64_t offset, int64_t numTerms, int timeoutSeconds,
                        Sequence& result) const {
+  if (native_formula.isSupported()) {
+    try {
+      return native_formula.evalNative(offset, numTerms, timeoutSeconds,
+                                       result);
+    } catch (const std::exception& e) {
+      Log::get().debug(std::string(e.what()) + "; using PARI/GP");
+    }
+  }
+  return evalWithGP(offset, numTerms, timeoutSeconds, result);
+}
+
+bool PariFormula::evalWithGP(int64_t offset, int64_t numTerms,
+                             int timeoutSeconds, Sequence& result) const {
   const std::string tmpFileId = std::to_string(Random::get().gen() % 1000);
   const std::string gpPath("pari-loda-" + tmpFileId + ".gp");
   const std::string gpResult("pari-result-" + tmpFileId + ".txt");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "form/formula.hpp"
+#include "form/native.hpp"
 #include "math/sequence.hpp"
 
 /**
@@ -27,13 +28,19 @@ class PariFormula {
 
   // Evaluates the formula for the given offset and number of terms, with a
   // timeout in seconds. Returns true if successful, false if a timeout
-  // occurred. The result sequence is written to 'result'.
+  // occurred. The result sequence is written to 'result'. The formula is
+  // evaluated in process if possible, otherwise using PARI/GP.
   bool eval(int64_t offset, int64_t numTerms, int timeoutSeconds,
             Sequence& result) const;
 
+  // Evaluates the generated code using PARI/GP.
+  bool evalWithGP(int64_t offset, int64_t numTerms, int timeoutSeconds,
+                  Sequence& result) const;
+
   std::string getName() const { return "PARI"; }
 
  private:
   Formula main_formula;
+  NativeFormula native_formula;
   bool as_vector = false;
 };
@@ -96,6 +96,13 @@ void Blocks::Collector::add(const Program& p) {
   }
 }
 
+void Blocks::Collector::merge(Collector& other) {
+  for (const auto& it : other.blocks) {
+    blocks[it.first] += it.second;
+  }
+  other.blocks.clear();
+}
+
 Blocks Blocks::Collector::finalize() {
   Blocks result;
   for (auto it : blocks) {
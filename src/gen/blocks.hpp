@@ -26,6 +26,9 @@ class Blocks {
    public:
     void add(const Program& p);
 
+    // Merge the blocks collected by another collector into this one.
+    void merge(Collector& other);
+
     Blocks finalize();
 
     bool empty() const;
@@ -1,6 +1,8 @@
 #include "gen/generator_v6.hpp"
 
-#include "lang/parser.hpp"
+#include <stdexcept>
+
+#include "lang/program_archive.hpp"
 #include "lang/program_util.hpp"
 #include "seq/managed_seq.hpp"
 #include "sys/log.hpp"
@@ -24,12 +26,13 @@ Program GeneratorV6::generateProgram() {
 }
 
 void GeneratorV6::nextProgram() {
-  Parser parser;
   for (int64_t i = 0; i < 10; i++) {
     const auto id = random_program_ids.get();
     const std::string path = ProgramUtil::getProgramPath(id);
     try {
-      program = parser.parse(path);
+      if (!ProgramArchive::get().load(id, program)) {
+        throw std::runtime_error("Program not found: " + id.string());
+      }
       ProgramUtil::removeOps(program, Operation::Type::NOP);
       // Log::get().info("Loaded template: " + path);
       return;
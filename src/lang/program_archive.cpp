@@ -0,0 +1,391 @@
+#include "lang/program_archive.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "lang/parser.hpp"
+#include "lang/program_util.hpp"
+#include "sys/file.hpp"
+#include "sys/git.hpp"
+#include "sys/log.hpp"
+#include "sys/setup.hpp"
+#include "sys/util.hpp"
+
+const std::string ARCHIVE_MAGIC = "LODAPRG1";
+
+// Domains of the archived programs
+const std::string ARCHIVE_DOMAINS = "AP";
+
+inline void writeInt(std::string& out, int64_t value) {
+  char buf[sizeof(int64_t)];
+  std::memcpy(buf, &value, sizeof(int64_t));
+  out.append(buf, sizeof(int64_t));
+}
+
+inline void writeString(std::string& out, const std::string& s) {
+  writeInt(out, static_cast<int64_t>(s.size()));
+  out.append(s);
+}
+
+inline void writeNumber(std::string& out, const Number& n) {
+  if (n.fitsInInt64()) {
+    out.push_back(0);
+    writeInt(out, n.asInt());
+  } else {
+    out.push_back(1);
+    writeString(out, n.to_string());
+  }
+}
+
+inline bool readInt(const char*& pos, const char* end, int64_t& value) {
+  if (end - pos < static_cast<int64_t>(sizeof(int64_t))) {
+    return false;
+  }
+  std::memcpy(&value, pos, sizeof(int64_t));
+  pos += sizeof(int64_t);
+  return true;
+}
+
+inline bool readString(const char*& pos, const char* end, std::string& s) {
+  int64_t length;
+  if (!readInt(pos, end, length) || length < 0 || end - pos < length) {
+    return false;
+  }
+  s.assign(pos, length);
+  pos += length;
+  return true;
+}
+
+inline bool readNumber(const char*& pos, const char* end, Number& n) {
+  if (pos == end) {
+    return false;
+  }
+  const char tag = *pos++;
+  if (tag == 0) {
+    int64_t value;
+    if (!readInt(pos, end, value)) {
+      return false;
+    }
+    n = Number(value);
+    return true;
+  }
+  std::string s;
+  if (tag != 1 || !readString(pos, end, s)) {
+    return false;
+  }
+  n = Number(s);
+  return true;
+}
+
+ProgramArchive& ProgramArchive::get() {
+  static ProgramArchive archive;
+  return archive;
+}
+
+ProgramArchive::ProgramArchive() : data(nullptr), is_open(false) {}
+
+ProgramArchive::~ProgramArchive() { close(); }
+
+std::string ProgramArchive::getPath() {
+  return Setup::getCacheHome() + "programs.bin";
+}
+
+void ProgramArchive::serialize(const Program& program, std::string& out) {
+  writeInt(out, static_cast<int64_t>(program.directives.size()));
+  for (const auto& d : program.directives) {
+    writeString(out, d.first);
+    writeInt(out, d.second);
+  }
+  writeInt(out, static_cast<int64_t>(program.ops.size()));
+  for (const auto& op : program.ops) {
+    writeInt(out, static_cast<int64_t>(op.type) |
+                      (static_cast<int64_t>(op.target.type) << 8) |
+                      (static_cast<int64_t>(op.source.type) << 16));
+    writeNumber(out, op.target.value);
+    writeNumber(out, op.source.value);
+    writeString(out, op.comment);
+  }
+}
+
+bool ProgramArchive::deserialize(const char*& pos, const char* end,
+                                 Program& program) {
+  program.ops.clear();
+  program.directives.clear();
+  int64_t count, value;
+  std::string name;
+  if (!readInt(pos, end, count) || count < 0) {
+    return false;
+  }
+  for (int64_t i = 0; i < count; i++) {
+    if (!readString(pos, end, name) || !readInt(pos, end, value)) {
+      return false;
+    }
+    program.directives[name] = value;
+  }
+  if (!readInt(pos, end, count) || count < 0) {
+    return false;
+  }
+  program.ops.resize(count);
+  for (auto& op : program.ops) {
+    int64_t types;
+    if (!readInt(pos, end, types) ||
+        (types & 0xff) >= static_cast<int64_t>(Operation::Type::__COUNT) ||
+        ((types >> 8) & 0xff) > 2 || ((types >> 16) & 0xff) > 2 ||
+        !readNumber(pos, end, op.target.value) ||
+        !readNumber(pos, end, op.source.value) ||
+        !readString(pos, end, op.comment)) {
+      return false;
+    }
+    op.type = static_cast<Operation::Type>(types & 0xff);
+    op.target.type = static_cast<Operand::Type>((types >> 8) & 0xff);
+    op.source.type = static_cast<Operand::Type>((types >> 16) & 0xff);
+  }
+  return true;
+}
+
+bool ProgramArchive::getStamp(const std::string& path, int64_t& size,
+                              int64_t& time) {
+  std::error_code ec;
+  const auto s = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  const auto t = std::filesystem::last_write_time(path, ec);
+  if (ec) {
+    return false;
+  }
+  size = static_cast<int64_t>(s);
+  time = static_cast<int64_t>(t.time_since_epoch().count());
+  return true;
+}
+
+void ProgramArchive::close() {
+  index.clear();
+  file.reset();
+  data = nullptr;
+  commit.clear();
+  is_open = false;
+}
+
+void ProgramArchive::open() {
+  close();
+  is_open = true;
+  programs_home = Setup::getProgramsHome();
+  const auto path = getPath();
+  if (!isFile(path)) {
+    return;
+  }
+  try {
+    file.reset(new MappedFile(path));
+    const char* pos = file->data();
+    const char* end = pos + file->size();
+    std::string magic(pos, std::min<size_t>(file->size(), 8));
+    pos += magic.size();
+    std::string home;
+    int64_t count;
+    if (magic != ARCHIVE_MAGIC || !readString(pos, end, home) ||
+        !readString(pos, end, commit) || !readInt(pos, end, count) ||
+        count < 0) {
+      throw std::runtime_error("invalid header");
+    }
+    if (home != programs_home) {
+      // archive of a different programs home
+      file.reset();
+      commit.clear();
+      return;
+    }
+    int64_t id;
+    Entry e;
+    for (int64_t i = 0; i < count; i++) {
+      if (!readInt(pos, end, id) || !readInt(pos, end, e.offset) ||
+          !readInt(pos, end, e.length) || !readInt(pos, end, e.file_size) ||
+          !readInt(pos, end, e.file_time)) {
+        throw std::runtime_error("invalid index");
+      }
+      index[UID::castFromInt(id)] = e;
+    }
+    data = pos;
+    for (const auto& it : index) {
+      if (it.second.offset < 0 || it.second.length < 0 ||
+          it.second.offset + it.second.length > end - data) {
+        throw std::runtime_error("invalid index");
+      }
+    }
+  } catch (const std::exception& e) {
+    Log::get().warn("Ignoring program archive " + path + ": " + e.what());
+    close();
+    is_open = true;
+  }
+}
+
+bool ProgramArchive::load(UID id, Program& program) {
+  const auto path = ProgramUtil::getProgramPath(id);
+  std::shared_ptr<MappedFile> mapped;
+  const char* pos = nullptr;
+  Entry e;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!is_open || programs_home != Setup::getProgramsHome()) {
+      open();
+    }
+    auto it = index.find(id);
+    if (it != index.end()) {
+      mapped = file;
+      pos = data + it->second.offset;
+      e = it->second;
+    }
+  }
+  // deserialize without holding the lock; the mapping stays valid
+  if (mapped) {
+    int64_t size, time;
+    if (!getStamp(path, size, time)) {
+      return false;
+    }
+    if (size == e.file_size && time == e.file_time &&
+        deserialize(pos, pos + e.length, program)) {
+      return true;
+    }
+  }
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  Parser parser;
+  program = parser.parse(in);
+  return true;
+}
+
+void ProgramArchive::update() {
+  std::lock_guard<std::mutex> guard(mutex);
+  const auto home = Setup::getProgramsHome();
+  if (!is_open || programs_home != home) {
+    open();
+  }
+  const bool is_git = isDir(home + ".git");
+  const std::string new_commit = is_git ? Git::headCommit(home) : "";
+
+  // determine the candidate programs: if the programs home is a git repository
+  // and the archive has a commit, only the changed files need to be checked
+  // for new programs. Otherwise, all program folders are scanned.
+  std::unordered_set<UID> changed;
+  bool scan = index.empty() || !is_git || commit.empty() || new_commit.empty();
+  if (!scan) {
+    std::vector<std::string> files;
+    if (Git::changedFiles(home, commit, files)) {
+      for (const auto& f : files) {
+        auto name = std::filesystem::path(f).stem().string();
+        if (UID::valid(name)) {
+          changed.insert(UID(name));
+        }
+      }
+    } else {
+      scan = true;
+    }
+  }
+  std::vector<UID> ids;
+  if (scan) {
+    for (char domain : ARCHIVE_DOMAINS) {
+      const auto dir = ProgramUtil::getProgramsDir(domain);
+      if (!isDir(dir)) {
+        continue;
+      }
+      std::error_code ec;
+      for (const auto& sub : std::filesystem::directory_iterator(dir, ec)) {
+        if (!sub.is_directory()) {
+          continue;
+        }
+        for (const auto& f : std::filesystem::directory_iterator(sub, ec)) {
+          const auto name = f.path().stem().string();
+          if (f.path().extension() == ".asm" && UID::valid(name) &&
+              UID(name).domain() == domain) {
+            ids.push_back(UID(name));
+          }
+        }
+      }
+    }
+  } else {
+    for (const auto& it : index) {
+      ids.push_back(it.first);
+    }
+    for (auto id : changed) {
+      if (ARCHIVE_DOMAINS.find(id.domain()) != std::string::npos &&
+          index.find(id) == index.end()) {
+        ids.push_back(id);
+      }
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+
+  // serialize new and changed programs and copy the others
+  std::string blob, idx;
+  Parser parser;
+  Program program;
+  size_t num_entries = 0, num_parsed = 0;
+  for (auto id : ids) {
+    const auto path = ProgramUtil::getProgramPath(id);
+    Entry e;
+    if (!getStamp(path, e.file_size, e.file_time)) {
+      continue;  // deleted
+    }
+    e.offset = static_cast<int64_t>(blob.size());
+    auto it = index.find(id);
+    if (it != index.end() && changed.find(id) == changed.end() &&
+        it->second.file_size == e.file_size &&
+        it->second.file_time == e.file_time) {
+      blob.append(data + it->second.offset, it->second.length);
+    } else {
+      try {
+        program = parser.parse(path);
+      } catch (const std::exception&) {
+        continue;  // reported when the program is loaded
+      }
+      serialize(program, blob);
+      num_parsed++;
+    }
+    e.length = static_cast<int64_t>(blob.size()) - e.offset;
+    writeInt(idx, id.castToInt());
+    writeInt(idx, e.offset);
+    writeInt(idx, e.length);
+    writeInt(idx, e.file_size);
+    writeInt(idx, e.file_time);
+    num_entries++;
+  }
+  if (num_parsed == 0 && num_entries == index.size() && new_commit == commit) {
+    return;  // up to date
+  }
+
+  // write to a temporary file and replace the archive
+  const auto path = getPath();
+  const auto tmp_path = path + ".tmp" + std::to_string(Random::get().gen());
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    std::string header = ARCHIVE_MAGIC;
+    writeString(header, home);
+    writeString(header, new_commit);
+    writeInt(header, static_cast<int64_t>(num_entries));
+    out.write(header.data(), header.size());
+    out.write(idx.data(), idx.size());
+    out.write(blob.data(), blob.size());
+    if (!out) {
+      Log::get().warn("Cannot write program archive " + tmp_path);
+      out.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  close();
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    Log::get().warn("Cannot replace program archive " + path + ": " +
+                    ec.message());
+    std::remove(tmp_path.c_str());
+  }
+  open();
+  Log::get().debug("Updated program archive with " +
+                   std::to_string(num_entries) + " programs (" +
+                   std::to_string(num_parsed) + " parsed)");
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "base/uid.hpp"
+#include "lang/program.hpp"
+
+class MappedFile;
+
+// Packed archive of pre-parsed programs from the programs home. The archive
+// contains the operations, directives and comments of all programs in binary
+// form together with an index by ID. The program files remain the source of
+// truth: an archived program is used only if the size and modification time
+// of its file are unchanged. Otherwise, the program file is parsed. The
+// archive is rebuilt incrementally using the files changed since the archived
+// git commit, or using the file time stamps if the programs home is not a git
+// repository.
+class ProgramArchive {
+ public:
+  static ProgramArchive &get();
+
+  // Load a program from the archive or, if it is not archived or outdated,
+  // from its program file. Returns false if the program file does not exist.
+  bool load(UID id, Program &program);
+
+  // Update the archive with all changed program files and reload it.
+  void update();
+
+  // Path of the archive file.
+  static std::string getPath();
+
+  static void serialize(const Program &program, std::string &out);
+
+  static bool deserialize(const char *&pos, const char *end,
+                          Program &program);
+
+  ~ProgramArchive();
+
+ private:
+  class Entry {
+   public:
+    int64_t offset;
+    int64_t length;
+    int64_t file_size;
+    int64_t file_time;
+  };
+
+  ProgramArchive();
+
+  void open();
+
+  void close();
+
+  static bool getStamp(const std::string &path, int64_t &size, int64_t &time);
+
+  std::mutex mutex;
+  std::shared_ptr<MappedFile> file;  // kept alive by concurrent lookups
+  std::string programs_home;  // programs home of the loaded archive
+  std::string commit;         // git commit of the loaded archive
+  const char *data;           // start of the serialized programs
+  std::unordered_map<UID, Entry> index;
+  bool is_open;
+};
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "lang/parser.hpp"
+#include "lang/program_archive.hpp"
 #include "lang/program_util.hpp"
 
 const Program& ProgramCache::getProgram(UID id) {
@@ -14,9 +15,12 @@ const Program& ProgramCache::getProgram(UID id) {
   }
   if (programs.find(id) == programs.end()) {
     try {
-      Parser parser;
-      auto path = ProgramUtil::getProgramPath(id);
-      programs[id] = parser.parse(path);
+      Program program;
+      if (!ProgramArchive::get().load(id, program)) {
+        Parser parser;
+        program = parser.parse(ProgramUtil::getProgramPath(id));
+      }
+      programs[id] = std::move(program);
     } catch (...) {
       missing.insert(id);
       std::rethrow_exception(std::current_exception());
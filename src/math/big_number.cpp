@@ -2,26 +2,165 @@
 
 #include <algorithm>
 #include <limits>
+#include <stdexcept>
 #include <string>
-#include <vector>
 
-BigNumber::BigNumber() : is_negative(false), is_infinite(false) {
-  words.fill(0);
+// Operands with at least this many words are multiplied using Karatsuba.
+constexpr size_t KARATSUBA_THRESHOLD = 24;
+
+// Numbers are parsed and printed in chunks of 19 decimal digits.
+constexpr size_t CHUNK_DIGITS = 19;
+constexpr uint64_t CHUNK_BASE = 10000000000000000000ull;
+
+int countLeadingZeros(uint64_t x) {
+  int n = 0;
+  while (!(x & 0x8000000000000000ull)) {
+    x <<= 1;
+    n++;
+  }
+  return n;
+}
+
+// Divide a two-word number by a word and return the quotient. The remainder
+// is stored in the output argument. The high word must be less than d.
+uint64_t divWords(uint64_t high, uint64_t low, uint64_t d, uint64_t& rem) {
+#ifdef __SIZEOF_INT128__
+  const unsigned __int128 u =
+      (static_cast<unsigned __int128>(high) << 64) | low;
+  rem = static_cast<uint64_t>(u % d);
+  return static_cast<uint64_t>(u / d);
+#else
+  // see Hacker's Delight, section 9-4
+  constexpr uint64_t b = 0x100000000ull;
+  const int s = countLeadingZeros(d);
+  d <<= s;
+  const uint64_t vn1 = d >> 32, vn0 = d & 0xFFFFFFFFull;
+  const uint64_t un32 = s ? (high << s) | (low >> (64 - s)) : high;
+  const uint64_t un10 = low << s;
+  const uint64_t un1 = un10 >> 32, un0 = un10 & 0xFFFFFFFFull;
+  uint64_t q1 = un32 / vn1, rhat = un32 - q1 * vn1;
+  while (q1 >= b || q1 * vn0 > b * rhat + un1) {
+    q1--;
+    rhat += vn1;
+    if (rhat >= b) {
+      break;
+    }
+  }
+  const uint64_t un21 = un32 * b + un1 - q1 * d;
+  uint64_t q0 = un21 / vn1;
+  rhat = un21 - q0 * vn1;
+  while (q0 >= b || q0 * vn0 > b * rhat + un0) {
+    q0--;
+    rhat += vn1;
+    if (rhat >= b) {
+      break;
+    }
+  }
+  rem = (un21 * b + un0 - q0 * d) >> s;
+  return q1 * b + q0;
+#endif
 }
 
-BigNumber::BigNumber(int64_t value) {
-  if (value >= 0) {
-    is_negative = false;
-    is_infinite = false;
-    words.fill(0);
-    words[0] = value;
+// Add a to r in-place. The result must fit into nr words.
+void addWords(uint64_t* r, size_t nr, const uint64_t* a, size_t na) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < nr && (i < na || carry); i++) {
+    const uint64_t x = (i < na) ? a[i] : 0;
+    const uint64_t s = r[i] + x;
+    const uint64_t c = (s < x);
+    r[i] = s + carry;
+    carry = c | (r[i] < s);
+  }
+}
+
+// Subtract a from r in-place. The result must be non-negative.
+void subWords(uint64_t* r, size_t nr, const uint64_t* a, size_t na) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < nr && (i < na || borrow); i++) {
+    const uint64_t x = (i < na) ? a[i] : 0;
+    const uint64_t d = r[i] - x;
+    const uint64_t b = (r[i] < x);
+    r[i] = d - borrow;
+    borrow = b | (d < borrow);
+  }
+}
+
+void mulWordsArray(const uint64_t* x, size_t nx, const uint64_t* y, size_t ny,
+                   uint64_t* r);
+
+// Schoolbook multiplication. The result array must be zero-initialized.
+void mulSchoolbook(const uint64_t* x, size_t nx, const uint64_t* y, size_t ny,
+                   uint64_t* r) {
+  for (size_t i = 0; i < nx; i++) {
+    const uint64_t xi = x[i];
+    uint64_t carry = 0;
+    for (size_t j = 0; j < ny; j++) {
+      uint64_t high;
+      uint64_t low = BigNumber::mulWords(xi, y[j], high);
+      low += carry;
+      high += (low < carry);
+      low += r[i + j];
+      high += (low < r[i + j]);
+      r[i + j] = low;
+      carry = high;
+    }
+    r[i + ny] = carry;
+  }
+}
+
+// Karatsuba multiplication. The result array must be zero-initialized.
+void mulKaratsuba(const uint64_t* x, size_t nx, const uint64_t* y, size_t ny,
+                  uint64_t* r) {
+  // x = x1*B^m + x0, y = y1*B^m + y0
+  const size_t m = std::min(nx, ny) / 2;
+  mulWordsArray(x, m, y, m, r);                           // x0*y0
+  mulWordsArray(x + m, nx - m, y + m, ny - m, r + 2 * m);  // x1*y1
+  std::vector<uint64_t> sx(std::max(m, nx - m) + 1, 0);
+  std::vector<uint64_t> sy(std::max(m, ny - m) + 1, 0);
+  std::copy(x, x + m, sx.begin());
+  addWords(sx.data(), sx.size(), x + m, nx - m);
+  std::copy(y, y + m, sy.begin());
+  addWords(sy.data(), sy.size(), y + m, ny - m);
+  // (x0+x1)*(y0+y1) - x0*y0 - x1*y1 = x0*y1 + x1*y0
+  std::vector<uint64_t> p(sx.size() + sy.size(), 0);
+  mulWordsArray(sx.data(), sx.size(), sy.data(), sy.size(), p.data());
+  subWords(p.data(), p.size(), r, 2 * m);
+  subWords(p.data(), p.size(), r + 2 * m, nx + ny - 2 * m);
+  while (!p.empty() && p.back() == 0) {
+    p.pop_back();
+  }
+  addWords(r + m, nx + ny - m, p.data(), p.size());
+}
+
+void mulWordsArray(const uint64_t* x, size_t nx, const uint64_t* y, size_t ny,
+                   uint64_t* r) {
+  if (std::min(nx, ny) < KARATSUBA_THRESHOLD) {
+    mulSchoolbook(x, nx, y, ny, r);
   } else {
-    load(std::to_string(value));
+    mulKaratsuba(x, nx, y, ny, r);
+  }
+}
+
+BigNumber::BigNumber() : is_negative(false), is_infinite(false) {}
+
+BigNumber::BigNumber(int64_t value)
+    : is_negative(value < 0), is_infinite(false) {
+  if (value != 0) {
+    words.push_back(is_negative ? ~static_cast<uint64_t>(value) + 1 : value);
   }
 }
 
 BigNumber::BigNumber(const std::string& s) { load(s); }
 
+BigNumber::BigNumber(bool negative, uint64_t low, uint64_t high)
+    : is_negative(negative), is_infinite(false) {
+  if (high) {
+    words = {low, high};
+  } else if (low) {
+    words = {low};
+  }
+}
+
 void throwNumberParseError(const std::string& s) {
   throw std::invalid_argument("error reading number: '" + s + "'");
 }
@@ -55,88 +194,119 @@ void BigNumber::load(const std::string& s) {
   if (size == 0) {
     throwNumberParseError(s);
   }
-  words.fill(0);
   for (int64_t i = 0; i < size; i++) {
-    if (is_infinite) {
-      break;
-    }
-    char ch = s[start + i];
+    const char ch = s[start + i];
     if (ch < '0' || ch > '9') {
       throwNumberParseError(s);
     }
-    mulShort(10);
-    add(BigNumber(ch - '0'));  // TODO: use addShort
   }
-}
-
-bool BigNumber::isZero() const {
-  return !is_infinite && std::all_of(words.begin(), words.end(),
-                                     [](uint64_t w) { return w == 0; });
+  words.clear();
+  int64_t len = size % CHUNK_DIGITS;
+  if (len == 0) {
+    len = CHUNK_DIGITS;
+  }
+  for (int64_t pos = start; pos < start + size; pos += len) {
+    if (pos > start) {
+      len = CHUNK_DIGITS;
+    }
+    uint64_t chunk = 0, scale = 1;
+    for (int64_t i = 0; i < len; i++) {
+      chunk = (chunk * 10) + (s[pos + i] - '0');
+      scale *= 10;
+    }
+    mulShort(scale);
+    if (is_infinite) {
+      break;
+    }
+    addShort(chunk);
+  }
 }
 
 void BigNumber::makeInfinite() {
   is_negative = false;
   is_infinite = true;
-  words.fill(0);
+  words.clear();
+}
+
+void BigNumber::trim() {
+  while (!words.empty() && words.back() == 0) {
+    words.pop_back();
+  }
+}
+
+void BigNumber::checkOverflow() {
+  if (words.size() > NUM_WORDS) {
+    makeInfinite();
+  }
 }
 
 int64_t BigNumber::asInt() const {
   if (is_infinite) {
     throw std::runtime_error("Infinity error");
   }
-  if (words[0] > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+  if (!fitsInInt64()) {
     throw std::runtime_error("Integer overflow");
   }
-  for (size_t i = 1; i < NUM_WORDS; i++) {
-    if (words[i] != 0) {
-      throw std::runtime_error("Integer overflow");
-    }
+  if (words.empty()) {
+    return 0;
   }
   return is_negative ? -words[0] : words[0];
 }
 
 bool BigNumber::fitsInInt64() const {
-  if (is_infinite) {
+  if (is_infinite || words.size() > 1) {
     return false;
   }
-  if (words[0] > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
-    return false;
-  }
-  for (size_t i = 1; i < NUM_WORDS; i++) {
-    if (words[i] != 0) {
-      return false;
-    }
-  }
-  return true;
+  return words.empty() ||
+         words[0] <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
 }
 
 int64_t BigNumber::getNumUsedWords() const {
-  if (is_infinite) {
-    return 1;
-  }
-  for (int64_t i = NUM_WORDS - 1; i >= 0; i--) {
-    if (words[i] != 0) {
-      return i + 1;
-    }
+  return std::max<int64_t>(words.size(), 1);
+}
+
+bool BigNumber::getTwoWords(bool& negative, uint64_t& low,
+                            uint64_t& high) const {
+  if (is_infinite || words.size() > 2) {
+    return false;
   }
-  return 1;
+  negative = is_negative;
+  low = words.empty() ? 0 : words[0];
+  high = (words.size() < 2) ? 0 : words[1];
+  return true;
 }
 
 bool BigNumber::odd() const {
   if (is_infinite) {
     return false;  // by convention
   }
-  return (words[0] & 1);
+  return !words.empty() && (words[0] & 1);
 }
 
 BigNumber BigNumber::minMax(bool is_max) {
   BigNumber m;
   m.is_infinite = false;
   m.is_negative = !is_max;
-  m.words.fill(std::numeric_limits<uint64_t>::max());
+  m.words.assign(NUM_WORDS, std::numeric_limits<uint64_t>::max());
   return m;
 }
 
+uint64_t BigNumber::mulWords(uint64_t a, uint64_t b, uint64_t& high) {
+#ifdef __SIZEOF_INT128__
+  const unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+  high = static_cast<uint64_t>(p >> 64);
+  return static_cast<uint64_t>(p);
+#else
+  const uint64_t a0 = a & 0xFFFFFFFFull, a1 = a >> 32;
+  const uint64_t b0 = b & 0xFFFFFFFFull, b1 = b >> 32;
+  const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  const uint64_t mid =
+      (p00 >> 32) + (p01 & 0xFFFFFFFFull) + (p10 & 0xFFFFFFFFull);
+  high = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return (mid << 32) | (p00 & 0xFFFFFFFFull);
+#endif
+}
+
 bool BigNumber::operator==(const BigNumber& n) const {
   if (is_infinite != n.is_infinite) {
     return false;
@@ -150,16 +320,25 @@ bool BigNumber::operator==(const BigNumber& n) const {
 bool BigNumber::operator!=(const BigNumber& n) const { return !(*this == n); }
 
 bool BigNumber::operator<(const BigNumber& n) const {
-  bool is_zero = true;
-  for (int64_t i = NUM_WORDS - 1; i >= 0; i--) {
-    if (words[i] < n.words[i]) {
-      return !n.is_negative;
-    } else if (words[i] > n.words[i]) {
-      return is_negative;
+  const bool neg = is_negative && !words.empty();
+  const bool n_neg = n.is_negative && !n.words.empty();
+  if (neg != n_neg) {
+    return neg;
+  }
+  const int cmp = compareAbs(n);
+  return neg ? (cmp > 0) : (cmp < 0);
+}
+
+int BigNumber::compareAbs(const BigNumber& n) const {
+  if (words.size() != n.words.size()) {
+    return (words.size() < n.words.size()) ? -1 : 1;
+  }
+  for (size_t i = words.size(); i-- > 0;) {
+    if (words[i] != n.words[i]) {
+      return (words[i] < n.words[i]) ? -1 : 1;
     }
-    is_zero = is_zero && (words[i] == 0);
   }
-  return !is_zero && is_negative && !n.is_negative;
+  return 0;
 }
 
 BigNumber& BigNumber::negate() {
@@ -173,61 +352,41 @@ BigNumber& BigNumber::operator+=(const BigNumber& n) {
     makeInfinite();
     return *this;
   }
-  // check if one of the operands is negative
-  if (!is_negative && n.is_negative) {
-    BigNumber m(n);
-    m.is_negative = false;
-    if (*this < m) {
-      m.sub(*this);
-      (*this) = m;
-      is_negative = true;
-    } else {
-      sub(m);
-    }
-  } else if (is_negative && !n.is_negative) {
-    BigNumber m(n);
-    is_negative = false;
-    if (*this < m) {
-      m.sub(*this);
-      (*this) = m;
-    } else {
-      sub(m);
-      is_negative = true;
-    }
+  if (is_negative == n.is_negative) {
+    addAbs(n);
+  } else if (compareAbs(n) >= 0) {
+    subAbs(n);
   } else {
-    add(n);
+    BigNumber m(n);
+    m.subAbs(*this);
+    *this = std::move(m);
   }
   return *this;
 }
 
-void BigNumber::add(const BigNumber& n) {
+void BigNumber::addAbs(const BigNumber& n) {
+  const size_t size = n.words.size();
+  if (words.size() < size) {
+    words.resize(size, 0);
+  }
   uint64_t carry = 0;
-  for (size_t i = 0; i < NUM_WORDS; i++) {
-    uint64_t low, high;
-    low = (words[i] & LOW_BIT_MASK) + (n.words[i] & LOW_BIT_MASK) + carry;
-    carry = low >> 32;
-    high = (words[i] >> 32) + (n.words[i] >> 32) + carry;
-    carry = high >> 32;
-    words[i] = ((high & LOW_BIT_MASK) << 32) | (low & LOW_BIT_MASK);
+  for (size_t i = 0; i < words.size() && (i < size || carry); i++) {
+    const uint64_t x = (i < size) ? n.words[i] : 0;
+    const uint64_t s = words[i] + x;
+    const uint64_t c = (s < x);
+    words[i] = s + carry;
+    carry = c | (words[i] < s);
   }
   if (carry) {
-    makeInfinite();
+    words.push_back(carry);
+    checkOverflow();
   }
 }
 
-void BigNumber::sub(const BigNumber& n) {
-  uint64_t carry = 0;
-  for (size_t i = 0; i < NUM_WORDS; i++) {
-    uint64_t low, high;
-    low = (words[i] & LOW_BIT_MASK) - (n.words[i] & LOW_BIT_MASK) - carry;
-    carry = (low >> 32) != 0;
-    high = (words[i] >> 32) - (n.words[i] >> 32) - carry;
-    carry = (high >> 32) != 0;
-    words[i] = ((high & LOW_BIT_MASK) << 32) | (low & LOW_BIT_MASK);
-  }
-  if (carry) {
-    is_negative = true;
-  }
+void BigNumber::subAbs(const BigNumber& n) {
+  // the magnitude of n must not be greater than this one
+  subWords(words.data(), words.size(), n.words.data(), n.words.size());
+  trim();
 }
 
 BigNumber& BigNumber::operator*=(const BigNumber& n) {
@@ -235,185 +394,236 @@ BigNumber& BigNumber::operator*=(const BigNumber& n) {
     makeInfinite();
     return *this;
   }
-  BigNumber result(0);
-  int64_t shift = 0;
-  const int64_t s = n.getNumUsedWords();  // <= NUM_WORDS
-  for (int64_t i = 0; i < s; i++) {
-    auto copy = *this;
-    copy.mulShort(n.words[i] & LOW_BIT_MASK);  // low bits
-    copy.shift(shift);
-    shift += 1;
-    result += copy;
-    copy = *this;
-    copy.mulShort(n.words[i] >> 32);  // high bits
-    copy.shift(shift);
-    shift += 1;
-    result += copy;
-    if (result.is_infinite) {
-      break;
-    }
+  const bool negative = (is_negative != n.is_negative);
+  const size_t nx = words.size(), ny = n.words.size();
+  if (nx == 0 || ny == 0) {
+    words.clear();
+    is_negative = false;
+    return *this;
+  }
+  // the product has at least nx+ny-1 words
+  if (nx + ny - 1 > NUM_WORDS) {
+    makeInfinite();
+    return *this;
   }
-  if (!result.is_infinite) {
-    result.is_negative = (is_negative != n.is_negative);
+  is_negative = negative;
+  if (ny == 1) {
+    mulShort(n.words[0]);
+    return *this;
   }
-  (*this) = result;
-  return (*this);
+  std::vector<uint64_t> result(nx + ny, 0);
+  mulWordsArray(words.data(), nx, n.words.data(), ny, result.data());
+  words.swap(result);
+  trim();
+  checkOverflow();
+  return *this;
 }
 
 void BigNumber::mulShort(uint64_t n) {
+  if (n == 0) {
+    words.clear();
+    return;
+  }
   uint64_t carry = 0;
-  const int64_t s = std::min<int64_t>(getNumUsedWords() + 1, NUM_WORDS);
-  for (int64_t i = 0; i < s; i++) {
-    uint64_t low, high;
-    auto& w = words[i];
-    high = (w >> 32) * n;
-    low = (w & LOW_BIT_MASK) * n;
-    w = low + ((high & LOW_BIT_MASK) << 32) + carry;
-    carry = ((high + ((low + carry) >> 32)) >> 32);
+  for (auto& w : words) {
+    uint64_t high;
+    const uint64_t low = mulWords(w, n, high);
+    w = low + carry;
+    carry = high + (w < low);
   }
   if (carry) {
-    makeInfinite();
+    words.push_back(carry);
+    checkOverflow();
   }
 }
 
-void BigNumber::shift(int64_t n) {
-  for (; n > 0; n--) {
-    uint64_t next = 0;
-    for (size_t i = 0; i < NUM_WORDS; i++) {
-      uint64_t h = words[i] >> 32;
-      uint64_t l = words[i] & LOW_BIT_MASK;
-      words[i] = (l << 32) + next;
-      next = h;
-    }
-    if (next) {
-      makeInfinite();
-      break;
+void BigNumber::addShort(uint64_t n) {
+  for (auto& w : words) {
+    w += n;
+    if (w >= n) {
+      return;
     }
+    n = 1;
+  }
+  if (n) {
+    words.push_back(n);
+    checkOverflow();
   }
 }
 
+uint64_t BigNumber::divShort(uint64_t n) {
+  uint64_t rem = 0;
+  for (size_t i = words.size(); i-- > 0;) {
+    words[i] = divWords(rem, words[i], n, rem);
+  }
+  trim();
+  return rem;
+}
+
 BigNumber& BigNumber::operator/=(const BigNumber& n) {
   if (is_infinite || n.is_infinite || n.isZero()) {
     makeInfinite();
     return *this;
   }
-  auto m = n;  // TODO: avoid this copy is possible
-  bool new_is_negative = (m.is_negative != is_negative);
-  m.is_negative = false;
-  is_negative = false;
-  div(m);
-  is_negative = new_is_negative;
+  const bool negative = (is_negative != n.is_negative);
+  divAbs(n, false);
+  is_negative = negative;
   return *this;
 }
 
-void BigNumber::div(const BigNumber& n) {
-  if (n.getNumUsedWords() == 1 && !(n.words[0] >> 32)) {
-    divShort(n.words[0]);
-  } else {
-    divBig(n);
+BigNumber& BigNumber::operator%=(const BigNumber& n) {
+  if (is_infinite || n.is_infinite || n.isZero()) {
+    makeInfinite();
+    return *this;
   }
+  divAbs(n, true);
+  return *this;
 }
 
-void BigNumber::divShort(const uint64_t n) {
-  uint64_t carry = 0;
-  for (int64_t i = NUM_WORDS - 1; i >= 0; i--) {
-    uint64_t h, l, t, h2, u, l2;
-    auto& w = words[i];
-    h = w >> 32;
-    l = w & LOW_BIT_MASK;
-    t = (carry << 32) + h;
-    h2 = t / n;
-    carry = t % n;
-    u = (carry << 32) + l;
-    l2 = u / n;
-    carry = u % n;
-    w = (h2 << 32) + l2;
-  }
-}
-
-void BigNumber::divBig(const BigNumber& n) {
-  std::vector<std::pair<BigNumber, BigNumber>> d;
-  BigNumber f(n);
-  BigNumber g(1);
-  while (f < *this || f == *this) {
-    d.emplace_back(f, g);
-    f += f;
-    g += g;
-    if (f.is_infinite || g.is_infinite) {
-      makeInfinite();
-      return;
+void BigNumber::divAbs(const BigNumber& n, bool remainder) {
+  if (compareAbs(n) < 0) {
+    if (!remainder) {
+      words.clear();
     }
+    return;
   }
-  BigNumber r(0);
-  for (auto it = d.rbegin(); it != d.rend(); it++) {
-    while (it->first < *this || it->first == *this) {
-      sub(it->first);
-      r.add(it->second);
-      if (r.is_infinite) {
-        break;
+  const size_t nn = n.words.size(), nu = words.size();
+  if (nn == 1) {
+    const uint64_t rem = divShort(n.words[0]);
+    if (remainder) {
+      words.clear();
+      if (rem) {
+        words.push_back(rem);
       }
     }
+    return;
   }
-  *this = r;
-}
-
-BigNumber& BigNumber::operator%=(const BigNumber& n) {
-  if (is_infinite || n.is_infinite || n.isZero()) {
-    makeInfinite();
-    return *this;
-  }
-  auto m = n;
-  const bool new_is_negative = is_negative;
-  m.is_negative = false;
-  is_negative = false;
-  auto q = *this;
-  q.div(m);
-  if (q.is_infinite) {
-    makeInfinite();
-    return *this;
+  // Knuth, TAOCP Vol. 2, section 4.3.1, algorithm D
+  const int s = countLeadingZeros(n.words[nn - 1]);
+  std::vector<uint64_t> vn(nn), un(nu + 1);
+  for (size_t i = nn - 1; i > 0; i--) {
+    vn[i] = (n.words[i] << s) | (s ? n.words[i - 1] >> (64 - s) : 0);
+  }
+  vn[0] = n.words[0] << s;
+  un[nu] = s ? words[nu - 1] >> (64 - s) : 0;
+  for (size_t i = nu - 1; i > 0; i--) {
+    un[i] = (words[i] << s) | (s ? words[i - 1] >> (64 - s) : 0);
+  }
+  un[0] = words[0] << s;
+  std::vector<uint64_t> q(nu - nn + 1, 0);
+  const uint64_t v1 = vn[nn - 1], v2 = vn[nn - 2];
+  for (size_t j = nu - nn + 1; j-- > 0;) {
+    // estimate the quotient digit
+    uint64_t qhat, rhat;
+    bool rhat_overflow = false;
+    if (un[j + nn] >= v1) {
+      qhat = std::numeric_limits<uint64_t>::max();
+      rhat = un[j + nn - 1] + v1;
+      rhat_overflow = (rhat < v1);
+    } else {
+      qhat = divWords(un[j + nn], un[j + nn - 1], v1, rhat);
+    }
+    while (!rhat_overflow) {
+      uint64_t high;
+      const uint64_t low = mulWords(qhat, v2, high);
+      if (high < rhat || (high == rhat && low <= un[j + nn - 2])) {
+        break;
+      }
+      qhat--;
+      rhat += v1;
+      rhat_overflow = (rhat < v1);
+    }
+    // multiply and subtract
+    uint64_t borrow = 0, carry = 0;
+    for (size_t i = 0; i < nn; i++) {
+      uint64_t high;
+      uint64_t low = mulWords(qhat, vn[i], high);
+      low += carry;
+      carry = high + (low < carry);
+      const uint64_t d = un[i + j] - low;
+      const uint64_t b = (un[i + j] < low);
+      un[i + j] = d - borrow;
+      borrow = b | (d < borrow);
+    }
+    const uint64_t t = un[j + nn];
+    un[j + nn] = t - carry;
+    bool negative = (t < carry);
+    negative = negative || (un[j + nn] < borrow);
+    un[j + nn] -= borrow;
+    // add back if the estimate was one too large
+    if (negative) {
+      qhat--;
+      uint64_t c = 0;
+      for (size_t i = 0; i < nn; i++) {
+        const uint64_t sum = un[i + j] + vn[i];
+        const uint64_t c1 = (sum < vn[i]);
+        un[i + j] = sum + c;
+        c = c1 | (un[i + j] < sum);
+      }
+      un[j + nn] += c;
+    }
+    q[j] = qhat;
   }
-  q *= m;
-  if (q.is_infinite) {
-    makeInfinite();
-    return *this;
+  if (remainder) {
+    words.resize(nn);
+    for (size_t i = 0; i < nn; i++) {
+      words[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+    }
+  } else {
+    words.swap(q);
   }
-  sub(q);
-  is_negative = new_is_negative;
-  return *this;
+  trim();
 }
 
-BigNumber toTwosComplement(const BigNumber& n) {
-  BigNumber result = n;
-  if (n.is_negative && !n.isZero()) {
+void toTwosComplement(const std::vector<uint64_t>& words, bool negative,
+                      std::vector<uint64_t>& result) {
+  std::copy(words.begin(), words.end(), result.begin());
+  if (negative) {
     // Invert all bits and add 1
-    for (size_t i = 0; i < BigNumber::NUM_WORDS; i++) {
-      result.words[i] = ~result.words[i];
-    }
-    // Add 1
     uint64_t carry = 1;
-    for (size_t i = 0; i < BigNumber::NUM_WORDS; i++) {
-      uint64_t sum = result.words[i] + carry;
-      carry = (sum < result.words[i]);
-      result.words[i] = sum;
+    for (auto& w : result) {
+      w = ~w + carry;
+      carry = carry && (w == 0);
     }
   }
-  return result;
 }
 
-void fromTwosComplement(BigNumber& n, bool negative) {
-  if (negative && !n.isZero()) {
+void fromTwosComplement(std::vector<uint64_t>& words, bool negative) {
+  if (negative) {
     // Subtract 1 and invert all bits
     uint64_t borrow = 1;
-    for (size_t i = 0; i < BigNumber::NUM_WORDS; i++) {
-      uint64_t tmp = n.words[i];
-      n.words[i] = tmp - borrow;
+    for (auto& w : words) {
+      const uint64_t tmp = w;
+      w = ~(tmp - borrow);
       borrow = (tmp < borrow);
     }
-    for (size_t i = 0; i < BigNumber::NUM_WORDS; i++) {
-      n.words[i] = ~n.words[i];
-    }
   }
-  n.is_negative = negative;
+}
+
+uint64_t bitAnd(uint64_t a, uint64_t b) { return a & b; }
+
+uint64_t bitOr(uint64_t a, uint64_t b) { return a | b; }
+
+uint64_t bitXor(uint64_t a, uint64_t b) { return a ^ b; }
+
+void BigNumber::bitwise(const BigNumber& n,
+                        uint64_t (*op)(uint64_t, uint64_t)) {
+  // one extra word for the sign bit
+  const size_t size = std::max(words.size(), n.words.size()) + 1;
+  const bool neg = is_negative && !words.empty();
+  const bool n_neg = n.is_negative && !n.words.empty();
+  const bool negative = op(neg ? 1 : 0, n_neg ? 1 : 0) != 0;
+  std::vector<uint64_t> a(size, 0), b(size, 0);
+  toTwosComplement(words, neg, a);
+  toTwosComplement(n.words, n_neg, b);
+  for (size_t i = 0; i < size; i++) {
+    a[i] = op(a[i], b[i]);
+  }
+  fromTwosComplement(a, negative);
+  words.swap(a);
+  is_negative = negative;
+  trim();
+  checkOverflow();
 }
 
 BigNumber& BigNumber::operator^=(const BigNumber& n) {
@@ -421,14 +631,7 @@ BigNumber& BigNumber::operator^=(const BigNumber& n) {
     makeInfinite();
     return *this;
   }
-  BigNumber a = toTwosComplement(*this);
-  BigNumber b = toTwosComplement(n);
-  for (size_t i = 0; i < NUM_WORDS; i++) {
-    a.words[i] ^= b.words[i];
-  }
-  bool negative = is_negative != n.is_negative;
-  fromTwosComplement(a, negative);
-  *this = a;
+  bitwise(n, bitXor);
   return *this;
 }
 
@@ -437,14 +640,7 @@ BigNumber& BigNumber::operator&=(const BigNumber& n) {
     makeInfinite();
     return *this;
   }
-  BigNumber a = toTwosComplement(*this);
-  BigNumber b = toTwosComplement(n);
-  for (size_t i = 0; i < NUM_WORDS; i++) {
-    a.words[i] &= b.words[i];
-  }
-  bool negative = is_negative && n.is_negative;
-  fromTwosComplement(a, negative);
-  *this = a;
+  bitwise(n, bitAnd);
   return *this;
 }
 
@@ -453,14 +649,7 @@ BigNumber& BigNumber::operator|=(const BigNumber& n) {
     makeInfinite();
     return *this;
   }
-  BigNumber a = toTwosComplement(*this);
-  BigNumber b = toTwosComplement(n);
-  for (size_t i = 0; i < NUM_WORDS; i++) {
-    a.words[i] |= b.words[i];
-  }
-  bool negative = is_negative || n.is_negative;
-  fromTwosComplement(a, negative);
-  *this = a;
+  bitwise(n, bitOr);
   return *this;
 }
 
@@ -468,9 +657,11 @@ std::size_t BigNumber::hash() const {
   if (is_infinite) {
     return std::numeric_limits<std::size_t>::max();
   }
+  // the unused words are hashed as zeros to keep the hash values stable
   std::size_t seed = 0;
   bool is_zero = true;
-  for (const auto& w : words) {
+  for (size_t i = 0; i < NUM_WORDS; i++) {
+    const uint64_t w = (i < words.size()) ? words[i] : 0;
     seed ^= w + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     is_zero = is_zero && (w != 0);
   }
@@ -489,12 +680,12 @@ std::string BigNumber::toString() const {
   }
   std::string result;
   BigNumber m = *this;
-  BigNumber n;
   while (!m.isZero()) {
-    n = m;
-    n %= BigNumber(10);  // avoid this expensive mod operation
-    result += ('0' + n.words[0]);
-    m.divShort(10);
+    uint64_t chunk = m.divShort(CHUNK_BASE);
+    for (size_t i = 0; i < CHUNK_DIGITS && (chunk || !m.isZero()); i++) {
+      result += static_cast<char>('0' + (chunk % 10));
+      chunk /= 10;
+    }
   }
   if (is_negative) {
     result += '-';
@@ -1,11 +1,12 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
 #include <iostream>
+#include <vector>
 
 class BigNumber {
  public:
+  // Maximum number of words. Larger values overflow to infinity.
   static constexpr size_t NUM_WORDS = 60;
 
   BigNumber();
@@ -14,6 +15,10 @@ class BigNumber {
 
   explicit BigNumber(const std::string& s);
 
+  // Construct a number from its sign and the two lowest words of its
+  // magnitude.
+  BigNumber(bool negative, uint64_t low, uint64_t high);
+
   bool operator==(const BigNumber& n) const;
 
   bool operator!=(const BigNumber& n) const;
@@ -53,36 +58,45 @@ class BigNumber {
 
   int64_t getNumUsedWords() const;
 
+  // Returns true if the magnitude fits into two words. In this case, the sign
+  // and the two words are stored in the output arguments.
+  bool getTwoWords(bool& negative, uint64_t& low, uint64_t& high) const;
+
   bool odd() const;
 
   static BigNumber minMax(bool is_max);
 
- private:
-  static constexpr uint64_t HIGH_BIT_MASK = 0xFFFFFFFF00000000ull;
-  static constexpr uint64_t LOW_BIT_MASK = 0x00000000FFFFFFFFull;
+  // Multiply two words and return the low word of the product. The high word
+  // is stored in the output argument.
+  static uint64_t mulWords(uint64_t a, uint64_t b, uint64_t& high);
 
+ private:
   void load(const std::string& s);
 
-  bool isZero() const;
+  inline bool isZero() const { return !is_infinite && words.empty(); }
 
-  void add(const BigNumber& n);
+  void trim();
 
-  void sub(const BigNumber& n);
+  void checkOverflow();
 
-  void mulShort(uint64_t n);
+  int compareAbs(const BigNumber& n) const;
+
+  void addAbs(const BigNumber& n);
 
-  void shift(int64_t n);
+  void subAbs(const BigNumber& n);
+
+  void mulShort(uint64_t n);
 
-  void div(const BigNumber& n);
+  void addShort(uint64_t n);
 
-  void divShort(const uint64_t n);
+  uint64_t divShort(uint64_t n);
 
-  void divBig(const BigNumber& n);
+  void divAbs(const BigNumber& n, bool remainder);
 
-  friend BigNumber toTwosComplement(const BigNumber& n);
-  friend void fromTwosComplement(BigNumber& n, bool negative);
+  void bitwise(const BigNumber& n, uint64_t (*op)(uint64_t, uint64_t));
 
-  std::array<uint64_t, NUM_WORDS> words;
+  // magnitude in little-endian order without leading zero words
+  std::vector<uint64_t> words;
   bool is_negative;  // we don't want to expose this
   bool is_infinite;
 };
@@ -0,0 +1,133 @@
+#include "math/compact_sequence.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+inline uint64_t mixHash(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline bool isBigIndexLess(const std::pair<size_t, Number>& b, size_t i) {
+  return b.first < i;
+}
+
+CompactSequence::CompactSequence(const Sequence& seq) { assign(seq); }
+
+void CompactSequence::assign(const Sequence& seq) {
+  const size_t n = seq.size();
+  values.resize(n);
+  big.clear();
+  for (size_t i = 0; i < n; i++) {
+    const auto& t = seq[i];
+    if (t.fitsInInt64()) {
+      values[i] = t.asInt();
+    } else {
+      values[i] = BIG_TERM;
+      big.emplace_back(i, t);
+    }
+  }
+}
+
+void CompactSequence::toSequence(Sequence& seq) const {
+  const size_t n = values.size();
+  seq.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    seq[i] = Number(values[i]);
+  }
+  for (const auto& b : big) {
+    seq[b.first] = b.second;
+  }
+}
+
+Sequence CompactSequence::toSequence() const {
+  Sequence seq;
+  toSequence(seq);
+  return seq;
+}
+
+void CompactSequence::clear() {
+  values.clear();
+  big.clear();
+}
+
+void CompactSequence::truncate(size_t length) {
+  if (length >= values.size()) {
+    return;
+  }
+  values.resize(length);
+  while (!big.empty() && big.back().first >= length) {
+    big.pop_back();
+  }
+}
+
+Number CompactSequence::get(size_t index) const {
+  if (values[index] == BIG_TERM && !big.empty()) {
+    auto it = std::lower_bound(big.begin(), big.end(), index, isBigIndexLess);
+    if (it != big.end() && it->first == index) {
+      return it->second;
+    }
+  }
+  return Number(values[index]);
+}
+
+void CompactSequence::set(size_t index, const Number& n) {
+  auto it = std::lower_bound(big.begin(), big.end(), index, isBigIndexLess);
+  const bool found = (it != big.end() && it->first == index);
+  if (n.fitsInInt64()) {
+    values[index] = n.asInt();
+    if (found) {
+      big.erase(it);
+    }
+  } else {
+    values[index] = BIG_TERM;
+    if (found) {
+      it->second = n;
+    } else {
+      big.emplace(it, index, n);
+    }
+  }
+}
+
+uint64_t CompactSequence::hash() const {
+  // independent lanes without dependencies between consecutive terms, so that
+  // the compiler can vectorize the main loop
+  constexpr size_t LANES = 4;
+  uint64_t h[LANES] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                       0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL};
+  const size_t n = values.size();
+  const int64_t* v = values.data();
+  size_t i = 0;
+  for (; i + LANES <= n; i += LANES) {
+    for (size_t k = 0; k < LANES; k++) {
+      h[k] = (h[k] ^ static_cast<uint64_t>(v[i + k])) * 0x100000001b3ULL;
+    }
+  }
+  for (; i < n; i++) {
+    h[i % LANES] =
+        (h[i % LANES] ^ static_cast<uint64_t>(v[i])) * 0x100000001b3ULL;
+  }
+  uint64_t result = mixHash(n + 0x9e3779b97f4a7c15ULL);
+  for (size_t k = 0; k < LANES; k++) {
+    result = mixHash(result ^ h[k]);
+  }
+  for (const auto& b : big) {
+    result = mixHash(result ^ (b.first + b.second.hash()));
+  }
+  return result;
+}
+
+bool CompactSequence::operator==(const CompactSequence& s) const {
+  return values.size() == s.values.size() &&
+         (values.empty() ||
+          std::memcmp(values.data(), s.values.data(),
+                      values.size() * sizeof(int64_t)) == 0) &&
+         big == s.big;
+}
+
+size_t CompactSequence::getMemoryUsage() const {
+  return values.capacity() * sizeof(int64_t) +
+         big.capacity() * sizeof(std::pair<size_t, Number>);
+}
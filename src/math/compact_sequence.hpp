@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "math/sequence.hpp"
+
+// Sequence of integers stored as contiguous int64 array. Terms that do not
+// fit into int64 are stored in a side table sorted by index and marked with
+// BIG_TERM in the array. Most sequences used for matching have only small
+// terms, so they can be compared, hashed and reduced using plain int64
+// operations without touching any Number.
+class CompactSequence {
+ public:
+  // Marker of a big term in the array. A term with this value is big only if
+  // it is contained in the side table.
+  static constexpr int64_t BIG_TERM = std::numeric_limits<int64_t>::min();
+
+  CompactSequence() = default;
+
+  explicit CompactSequence(const Sequence &seq);
+
+  // Replace the terms reusing the allocated memory.
+  void assign(const Sequence &seq);
+
+  void toSequence(Sequence &seq) const;
+
+  Sequence toSequence() const;
+
+  size_t size() const { return values.size(); }
+
+  bool empty() const { return values.empty(); }
+
+  void clear();
+
+  // Remove all terms starting from the given index.
+  void truncate(size_t length);
+
+  // Returns true if all terms fit into int64.
+  bool isSmall() const { return big.empty(); }
+
+  // Raw terms. Only valid as values if the sequence is small.
+  const int64_t *data() const { return values.data(); }
+
+  int64_t *data() { return values.data(); }
+
+  Number get(size_t index) const;
+
+  void set(size_t index, const Number &n);
+
+  uint64_t hash() const;
+
+  bool operator==(const CompactSequence &s) const;
+
+  bool operator!=(const CompactSequence &s) const { return !(*this == s); }
+
+  // Approximate heap memory usage in bytes.
+  size_t getMemoryUsage() const;
+
+ private:
+  std::vector<int64_t> values;
+  std::vector<std::pair<size_t, Number>> big;  // sorted by index
+};
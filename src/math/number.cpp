@@ -1,5 +1,6 @@
 #include "math/number.hpp"
 
+#include <atomic>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
@@ -18,99 +19,118 @@ constexpr int64_t MIN_INT = std::numeric_limits<int64_t>::min();
 constexpr int64_t MAX_INT = std::numeric_limits<int64_t>::max();
 constexpr std::size_t MAX_SIZE = std::numeric_limits<std::size_t>::max();
 
-BigNumber* INF_PTR = reinterpret_cast<BigNumber*>(1);
+constexpr uint64_t INF_TAG = 1;
+constexpr uint64_t WIDE_TAG = 3;
+constexpr uint64_t WIDE_SIGN = 4;
+constexpr int WIDE_SHIFT = 3;
+constexpr uint64_t MAX_WIDE_HIGH = (static_cast<uint64_t>(1) << 61) - 1;
+
+std::atomic<size_t> num_heap_allocations(0);
+
+uint64_t newBig(const BigNumber& b) {
+  num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(new BigNumber(b)));
+}
 
 Number::Number()
-    : value(0), big(FORCE_BIG_NUMBER ? new BigNumber(0) : nullptr) {}
+    : value(0), aux(FORCE_BIG_NUMBER ? newBig(BigNumber(0)) : 0) {}
 
 Number::Number(const Number& n)
-    : value(n.value),
-      big((n.big && n.big != INF_PTR) ? new BigNumber(*n.big) : n.big) {}
+    : value(n.value), aux(n.isHeapBig() ? newBig(*n.getBig()) : n.aux) {}
+
+Number::Number(Number&& n) noexcept : value(n.value), aux(n.aux) {
+  n.value = 0;
+  n.aux = 0;
+}
 
 Number::Number(int64_t value)
     : value(FORCE_BIG_NUMBER ? 0 : value),
-      big(FORCE_BIG_NUMBER ? new BigNumber(value) : nullptr) {}
+      aux(FORCE_BIG_NUMBER ? newBig(BigNumber(value)) : 0) {}
 
-Number::Number(const std::string& s) {
+Number::Number(const std::string& s) : value(0), aux(0) {
   if (s == "inf") {
-    value = 0;
-    big = INF_PTR;
+    aux = INF_TAG;
     return;
   }
-  bool is_big = FORCE_BIG_NUMBER;
-  if (!is_big) {
-    if (s.size() <= 18) {
-      value = std::stoll(s);
-      big = nullptr;
-    } else if (USE_BIG_NUMBER) {
-      is_big = true;
-    } else {
-      value = 0;
-      big = INF_PTR;
-    }
-  }
-  if (is_big) {
-    value = 0;
-    big = new BigNumber(s);
-    checkInfBig();
+  if (s.size() <= 18 && !FORCE_BIG_NUMBER) {
+    value = std::stoll(s);
+  } else if (USE_BIG_NUMBER) {
+    assignBig(BigNumber(s));
+  } else {
+    aux = INF_TAG;
   }
 }
 
-Number::~Number() {
-  if (big && big != INF_PTR) {
-    delete big;
+Number::~Number() { release(); }
+
+Number& Number::operator=(const Number& n) {
+  if (this != &n) {
+    if (n.isHeapBig()) {
+      if (isHeapBig()) {
+        *getBig() = *n.getBig();  // reuse the allocated memory
+      } else {
+        value = 0;
+        aux = newBig(*n.getBig());
+      }
+    } else {
+      release();
+      value = n.value;
+      aux = n.aux;
+    }
   }
+  return *this;
 }
 
-Number& Number::operator=(const Number& n) {
+Number& Number::operator=(Number&& n) noexcept {
   if (this != &n) {
+    release();
     value = n.value;
-    if (big && big != INF_PTR) {
-      delete big;
-    }
-    big = (n.big && n.big != INF_PTR) ? new BigNumber(*n.big) : n.big;
+    aux = n.aux;
+    n.value = 0;
+    n.aux = 0;
   }
   return *this;
 }
 
 bool Number::operator==(const Number& n) const {
-  if (big == INF_PTR) {
-    return (n.big == INF_PTR);
-  }
-  if (n.big == INF_PTR) {
-    return false;
+  // the representation is canonical
+  if (aux == n.aux) {
+    return value == n.value;
   }
-  if (big) {
-    if (n.big) {
-      return (*big) == (*n.big);
-    } else {
-      return (*big) == BigNumber(n.value);
-    }
-  } else if (n.big) {
-    return BigNumber(value) == (*n.big);
-  } else {
-    return (value == n.value);
+  if (isHeapBig() && n.isHeapBig()) {
+    return (*getBig()) == (*n.getBig());
   }
+  return false;
 }
 
 bool Number::operator!=(const Number& n) const { return !(*this == n); }
 
 bool Number::operator<(const Number& n) const {
-  if (n.big == INF_PTR || big == INF_PTR) {
+  if (aux == 0 && n.aux == 0) {
+    return (value < n.value);
+  }
+  if (aux == INF_TAG || n.aux == INF_TAG) {
     return false;
   }
-  if (big) {
-    if (n.big) {
-      return (*big) < (*n.big);
-    } else {
-      return (*big) < BigNumber(n.value);
+  if (isHeapBig()) {
+    if (n.isHeapBig()) {
+      return (*getBig()) < (*n.getBig());
     }
+    return (*getBig()) < n.toBig();
   }
-  if (n.big) {
-    return BigNumber(value) < (*n.big);
-  } else {
-    return (value < n.value);
+  if (n.isHeapBig()) {
+    return toBig() < (*n.getBig());
+  }
+  bool an, bn;
+  uint64_t al, ah, bl, bh;
+  getWide(an, al, ah);
+  n.getWide(bn, bl, bh);
+  if (an != bn) {
+    return an;
   }
+  const bool less = (ah < bh) || (ah == bh && al < bl);
+  const bool greater = (ah > bh) || (ah == bh && al > bl);
+  return an ? greater : less;
 }
 
 bool Number::operator>(const Number& n) const { return (n < *this); }
@@ -124,128 +144,111 @@ bool Number::operator>=(const Number& n) const {
 }
 
 Number& Number::negate() {
-  if (big == INF_PTR) {
-    return *this;
-  }
-  if (big) {
-    big->negate();
-    checkInfBig();
-  } else if (value == MIN_INT) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      big->negate();
-      checkInfBig();
+  if (aux == 0) {
+    if (value == MIN_INT) {
+      setWide(false, static_cast<uint64_t>(MAX_INT) + 1, 0);
     } else {
-      value = 0;
-      big = INF_PTR;
+      value = -value;
     }
-  } else {
-    value = -value;
+  } else if (isHeapBig()) {
+    getBig()->negate();
+  } else if (aux != INF_TAG) {
+    bool negative;
+    uint64_t low, high;
+    getWide(negative, low, high);
+    setWide(!negative, low, high);
   }
   return *this;
 }
 
 Number& Number::operator+=(const Number& n) {
+  add(n, false);
+  return *this;
+}
+
+Number& Number::operator-=(const Number& n) {
+  add(n, true);
+  return *this;
+}
+
+void Number::add(const Number& n, bool subtract) {
   if (checkInfArgs(n)) {
-    return *this;
+    return;
   }
-  // One of the operands big?
-  if (big) {
-    if (n.big) {
-      (*big) += (*n.big);
-      checkInfBig();
-    } else {
-      (*big) += BigNumber(n.value);
-      checkInfBig();
+  // None of the operands is wide or big
+  if (aux == 0 && n.aux == 0) {
+    if (subtract) {
+      if (!((n.value < 0 && value > MAX_INT + n.value) ||
+            (n.value > 0 && value < MIN_INT + n.value))) {
+        value -= n.value;
+        return;
+      }
+    } else if (!((value > 0 && n.value > MAX_INT - value) ||
+                 (value < 0 && n.value < MIN_INT - value))) {
+      value += n.value;
+      return;
     }
-    return *this;
   }
-  if (n.big) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      (*big) += (*n.big);
-      checkInfBig();
+  // None of the operands is big: add the magnitudes inline
+  if (!isHeapBig() && !n.isHeapBig()) {
+    bool an, bn;
+    uint64_t al, ah, bl, bh;
+    getWide(an, al, ah);
+    n.getWide(bn, bl, bh);
+    bn = (bn != subtract);
+    if (an == bn) {
+      const uint64_t low = al + bl;
+      setWide(an, low, ah + bh + (low < al));
+    } else if (ah > bh || (ah == bh && al >= bl)) {
+      setWide(an, al - bl, ah - bh - (al < bl));
     } else {
-      value = 0;
-      big = INF_PTR;
+      setWide(bn, bl - al, bh - ah - (bl < al));
     }
-    return *this;
+    return;
   }
-  // None of the operands is big
-  if ((value > 0 && n.value > MAX_INT - value) ||
-      (value < 0 && n.value < MIN_INT - value)) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      // It could be that *this == n. In that case, we just converted n to big
-      // as well!
-      if (n.big) {
-        (*big) += (*n.big);
-      } else {
-        (*big) += BigNumber(n.value);
-      }
-      checkInfBig();
+  applyBig(n, [subtract](BigNumber& a, const BigNumber& b) {
+    if (subtract) {
+      BigNumber m(b);
+      a += m.negate();
     } else {
-      value = 0;
-      big = INF_PTR;
+      a += b;
     }
-  } else {
-    value += n.value;
-  }
-  return *this;
-}
-
-Number& Number::operator-=(const Number& n) {
-  auto m = n;
-  m.negate();
-  *this += m;
-  return *this;
+  });
 }
 
 Number& Number::operator*=(const Number& n) {
   if (checkInfArgs(n)) {
     return *this;
   }
-  // One of the operands big?
-  if (big) {
-    if (n.big) {
-      (*big) *= (*n.big);
-      checkInfBig();
-    } else {
-      (*big) *= BigNumber(n.value);
-      checkInfBig();
-    }
+  // None of the operands is wide or big and the product fits in 62 bits
+  static constexpr int64_t MAX_HALF = static_cast<int64_t>(1) << 31;
+  if (aux == 0 && n.aux == 0 && value < MAX_HALF && value > -MAX_HALF &&
+      n.value < MAX_HALF && n.value > -MAX_HALF) {
+    value *= n.value;
     return *this;
   }
-  if (n.big) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      (*big) *= (*n.big);
-      checkInfBig();
-    } else {
-      value = 0;
-      big = INF_PTR;
+  // None of the operands is big: multiply the magnitudes inline if possible
+  if (!isHeapBig() && !n.isHeapBig()) {
+    bool an, bn;
+    uint64_t al, ah, bl, bh;
+    getWide(an, al, ah);
+    n.getWide(bn, bl, bh);
+    if (ah != 0) {
+      std::swap(al, bl);
+      std::swap(ah, bh);
     }
-    return *this;
-  }
-  // None of the operands is big
-  if (n.value != 0 && (MAX_INT / std::abs(n.value) < std::abs(value))) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      // It could be that *this == n. In that case, we just converted n to big
-      // as well!
-      if (n.big) {
-        (*big) *= (*n.big);
-      } else {
-        (*big) *= BigNumber(n.value);
+    if (ah == 0) {
+      uint64_t carry, overflow;
+      const uint64_t low = BigNumber::mulWords(al, bl, carry);
+      const uint64_t cross = BigNumber::mulWords(al, bh, overflow);
+      const uint64_t high = cross + carry;
+      if (overflow == 0 && high >= cross) {
+        setWide(an != bn, low, high);
+        return *this;
       }
-      checkInfBig();
-    } else {
-      value = 0;
-      big = INF_PTR;
     }
-  } else {
-    value *= n.value;
   }
+  applyBig(n, [](BigNumber& a, const BigNumber& b) { a *= b; });
   return *this;
 }
 
@@ -253,50 +256,18 @@ Number& Number::operator/=(const Number& n) {
   if (checkInfArgs(n)) {
     return *this;
   }
-  // One of the operands big?
-  if (big) {
-    if (n.big) {
-      (*big) /= (*n.big);
-      checkInfBig();
-    } else {
-      (*big) /= BigNumber(n.value);
-      checkInfBig();
+  // None of the operands is wide or big
+  if (aux == 0 && n.aux == 0) {
+    if (n.value == 0) {
+      setInf();
+      return *this;
     }
-    return *this;
-  }
-  if (n.big) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      (*big) /= (*n.big);
-      checkInfBig();
-    } else {
-      value = 0;
-      big = INF_PTR;
-    }
-    return *this;
-  }
-  // None of the operands is big
-  if (n.value == 0) {
-    value = 0;
-    big = INF_PTR;
-  } else if (value == MIN_INT) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      // It could be that *this == n. In that case, we just converted n to big
-      // as well!
-      if (n.big) {
-        (*big) /= (*n.big);
-      } else {
-        (*big) /= BigNumber(n.value);
-      }
-      checkInfBig();
-    } else {
-      value = 0;
-      big = INF_PTR;
+    if (value != MIN_INT) {
+      value /= n.value;
+      return *this;
     }
-  } else {
-    value /= n.value;
   }
+  applyBig(n, [](BigNumber& a, const BigNumber& b) { a /= b; });
   return *this;
 }
 
@@ -304,50 +275,18 @@ Number& Number::operator%=(const Number& n) {
   if (checkInfArgs(n)) {
     return *this;
   }
-  // One of the operands big?
-  if (big) {
-    if (n.big) {
-      (*big) %= (*n.big);
-      checkInfBig();
-    } else {
-      (*big) %= BigNumber(n.value);
-      checkInfBig();
-    }
-    return *this;
-  }
-  if (n.big) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      (*big) %= (*n.big);
-      checkInfBig();
-    } else {
-      value = 0;
-      big = INF_PTR;
+  // None of the operands is wide or big
+  if (aux == 0 && n.aux == 0) {
+    if (n.value == 0) {
+      setInf();
+      return *this;
     }
-    return *this;
-  }
-  // None of the operands is big
-  if (n.value == 0) {
-    value = 0;
-    big = INF_PTR;
-  } else if (value == MIN_INT) {
-    if (USE_BIG_NUMBER) {
-      convertToBig();
-      // It could be that *this == n. In that case, we just converted n to big
-      // as well!
-      if (n.big) {
-        (*big) %= (*n.big);
-      } else {
-        (*big) %= BigNumber(n.value);
-      }
-      checkInfBig();
-    } else {
-      value = 0;
-      big = INF_PTR;
+    if (value != MIN_INT) {
+      value %= n.value;
+      return *this;
     }
-  } else {
-    value %= n.value;
   }
+  applyBig(n, [](BigNumber& a, const BigNumber& b) { a %= b; });
   return *this;
 }
 
@@ -355,17 +294,13 @@ Number& Number::operator&=(const Number& n) {
   if (checkInfArgs(n)) {
     return *this;
   }
-  // First check if one of the operands is big. If not, perform the operation
+  // First check if both operands are small. If so, perform the operation
   // on the small numbers. No need to check for INF after the operation, as the
-  // result always fits in a Number. No need to check for USE_BIG_NUMBER, as we
-  // never get a big number if both operands are small.
-  if (big) {
-    (*big) &= (n.big ? (*n.big) : BigNumber(n.value));
-  } else if (n.big) {
-    convertToBig();
-    (*big) &= (*n.big);
-  } else {
+  // result always fits in a Number.
+  if (aux == 0 && n.aux == 0) {
     value &= n.value;
+  } else {
+    applyBig(n, [](BigNumber& a, const BigNumber& b) { a &= b; });
   }
   return *this;
 }
@@ -374,17 +309,13 @@ Number& Number::operator|=(const Number& n) {
   if (checkInfArgs(n)) {
     return *this;
   }
-  // First check if one of the operands is big. If not, perform the operation
+  // First check if both operands are small. If so, perform the operation
   // on the small numbers. No need to check for INF after the operation, as the
-  // result always fits in a Number. No need to check for USE_BIG_NUMBER, as we
-  // never get a big number if both operands are small.
-  if (big) {
-    (*big) |= (n.big ? (*n.big) : BigNumber(n.value));
-  } else if (n.big) {
-    convertToBig();
-    (*big) |= (*n.big);
-  } else {
+  // result always fits in a Number.
+  if (aux == 0 && n.aux == 0) {
     value |= n.value;
+  } else {
+    applyBig(n, [](BigNumber& a, const BigNumber& b) { a |= b; });
   }
   return *this;
 }
@@ -393,77 +324,84 @@ Number& Number::operator^=(const Number& n) {
   if (checkInfArgs(n)) {
     return *this;
   }
-  // First check if one of the operands is big. If not, perform the operation
+  // First check if both operands are small. If so, perform the operation
   // on the small numbers. No need to check for INF after the operation, as the
-  // result always fits in a Number. No need to check for USE_BIG_NUMBER, as we
-  // never get a big number if both operands are small.
-  if (big) {
-    (*big) ^= (n.big ? (*n.big) : BigNumber(n.value));
-  } else if (n.big) {
-    convertToBig();
-    (*big) ^= (*n.big);
-  } else {
+  // result always fits in a Number.
+  if (aux == 0 && n.aux == 0) {
     value ^= n.value;
+  } else {
+    applyBig(n, [](BigNumber& a, const BigNumber& b) { a ^= b; });
   }
   return *this;
 }
 
 int64_t Number::asInt() const {
-  if (big == INF_PTR) {
+  if (aux == 0) {
+    return value;
+  }
+  if (aux == INF_TAG) {
     throw std::runtime_error("Infinity error");
   }
-  if (big) {
-    return big->asInt();
+  if (isHeapBig()) {
+    return getBig()->asInt();
   }
-  return value;
+  throw std::runtime_error("Integer overflow");
 }
 
-bool Number::fitsInInt64() const {
-  if (big == INF_PTR) {
-    return false;
-  }
-  if (big) {
-    return big->fitsInInt64();
-  }
-  return true;
-}
+bool Number::fitsInInt64() const { return aux == 0; }
 
 int64_t Number::getNumUsedWords() const {
-  if (big && big != INF_PTR) {
-    return big->getNumUsedWords();
+  if (isHeapBig()) {
+    return getBig()->getNumUsedWords();
+  }
+  if (aux != 0 && aux != INF_TAG && (aux >> WIDE_SHIFT) != 0) {
+    return 2;
   }
   return 1;
 }
 
 bool Number::odd() const {
-  if (big == INF_PTR) {
+  if (aux == INF_TAG) {
     return false;  // by convention
   }
-  if (big) {
-    return big->odd();
+  if (isHeapBig()) {
+    return getBig()->odd();
   }
   return (value & 1);
 }
 
 std::size_t Number::hash() const {
-  if (big == INF_PTR) {
+  if (aux == INF_TAG) {
     return MAX_SIZE;  // must be the same as in BigNumber!
   }
-  if (big) {
-    return big->hash();
-  } else {
-    // we must use the same hash values as in BigNumber!
-    return BigNumber(value).hash();
+  if (isHeapBig()) {
+    return getBig()->hash();
+  }
+  // we must use the same hash values as in BigNumber! The words above the
+  // two lowest words are zero, so the sign is always hashed if negative.
+  bool negative;
+  uint64_t low, high;
+  getWide(negative, low, high);
+  std::size_t seed = 0;
+  for (size_t i = 0; i < BigNumber::NUM_WORDS; i++) {
+    const uint64_t w = (i == 0) ? low : ((i == 1) ? high : 0);
+    seed ^= w + 0x9e3779b9 + (seed << 6) + (seed >> 2);
   }
+  if (negative) {
+    seed ^= 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+  return seed;
 }
 
 std::ostream& operator<<(std::ostream& out, const Number& n) {
-  if (n.big == INF_PTR) {
+  if (n.aux == 0) {
+    out << n.value;
+  } else if (n.aux == INF_TAG) {
     out << "inf";
-  } else if (n.big) {
-    out << *n.big;
+  } else if (n.isHeapBig()) {
+    out << *n.getBig();
   } else {
-    out << n.value;
+    out << n.toBig();
   }
   return out;
 }
@@ -500,47 +438,152 @@ void Number::readIntString(std::istream& in, std::string& out) {
   }
 }
 
+size_t Number::getNumHeapAllocations() {
+  return num_heap_allocations.load(std::memory_order_relaxed);
+}
+
 Number Number::infinity() {
   Number inf(0);
-  inf.big = INF_PTR;
+  inf.setInf();
   return inf;
 }
 
 Number Number::minMax(bool is_max) {
-  Number m;
-  m.value = 0;
-  m.big = new BigNumber(BigNumber::minMax(is_max));
+  Number m(0);
+  m.assignBig(BigNumber::minMax(is_max));
   return m;
 }
 
-bool Number::checkInfArgs(const Number& n) {
-  if (big == INF_PTR) {
-    return true;
+void Number::getWide(bool& negative, uint64_t& low, uint64_t& high) const {
+  if (aux == 0) {
+    negative = (value < 0);
+    low = negative ? ~static_cast<uint64_t>(value) + 1 : value;
+    high = 0;
+  } else {
+    negative = (aux & WIDE_SIGN);
+    low = static_cast<uint64_t>(value);
+    high = aux >> WIDE_SHIFT;
   }
-  if (n.big == INF_PTR) {
-    if (big) {
-      delete big;
+}
+
+void Number::setWide(bool negative, uint64_t low, uint64_t high) {
+  if (high == 0 && !FORCE_BIG_NUMBER) {
+    if (!negative && low <= static_cast<uint64_t>(MAX_INT)) {
+      release();
+      value = low;
+      aux = 0;
+      return;
+    }
+    if (negative && low <= static_cast<uint64_t>(MAX_INT) + 1) {
+      release();
+      value = ~low + 1;
+      aux = 0;
+      return;
     }
-    big = INF_PTR;
-    return true;
   }
-  return false;
+  if (!USE_BIG_NUMBER) {
+    setInf();
+  } else if (high <= MAX_WIDE_HIGH && !FORCE_BIG_NUMBER) {
+    release();
+    value = low;
+    aux = (high << WIDE_SHIFT) | (negative ? WIDE_SIGN : 0) | WIDE_TAG;
+  } else if (isHeapBig()) {
+    *getBig() = BigNumber(negative, low, high);
+  } else {
+    value = 0;
+    aux = newBig(BigNumber(negative, low, high));
+  }
+}
+
+void Number::setInf() {
+  release();
+  value = 0;
+  aux = INF_TAG;
 }
 
-void Number::checkInfBig() {
-  if (big && big != INF_PTR && big->isInfinite()) {
-    delete big;
+void Number::release() {
+  if (isHeapBig()) {
+    delete getBig();
+    aux = 0;
+  }
+}
+
+BigNumber Number::toBig() const {
+  if (isHeapBig()) {
+    return *getBig();
+  }
+  BigNumber b;
+  if (aux == INF_TAG) {
+    b.makeInfinite();
+  } else {
+    bool negative;
+    uint64_t low, high;
+    getWide(negative, low, high);
+    b = BigNumber(negative, low, high);
+  }
+  return b;
+}
+
+void Number::assignBig(const BigNumber& b) {
+  bool negative;
+  uint64_t low, high;
+  if (b.isInfinite()) {
+    setInf();
+  } else if (b.getTwoWords(negative, low, high)) {
+    setWide(negative, low, high);
+  } else if (isHeapBig()) {
+    *getBig() = b;
+  } else {
     value = 0;
-    big = INF_PTR;
+    aux = newBig(b);
   }
 }
 
-void Number::convertToBig() {
-  if (big == INF_PTR) {
-    big = new BigNumber();
-    big->makeInfinite();
-  } else if (!big) {
-    big = new BigNumber(value);
+void Number::normalizeBig() {
+  bool negative;
+  uint64_t low, high;
+  auto big = getBig();
+  if (big->isInfinite()) {
+    setInf();
+  } else if (!FORCE_BIG_NUMBER && big->getTwoWords(negative, low, high) &&
+             high <= MAX_WIDE_HIGH) {
+    setWide(negative, low, high);
   }
-  value = 0;
+}
+
+template <typename F>
+void Number::applyBig(const Number& n, F op) {
+  if (!USE_BIG_NUMBER) {
+    setInf();
+    return;
+  }
+  if (isHeapBig()) {
+    // It could be that *this == n. In that case, the operation is performed
+    // in-place on the same big number.
+    if (n.isHeapBig()) {
+      op(*getBig(), *n.getBig());
+    } else {
+      op(*getBig(), n.toBig());
+    }
+    normalizeBig();
+  } else {
+    auto b = toBig();
+    if (n.isHeapBig()) {
+      op(b, *n.getBig());
+    } else {
+      op(b, n.toBig());
+    }
+    assignBig(b);
+  }
+}
+
+bool Number::checkInfArgs(const Number& n) {
+  if (aux == INF_TAG) {
+    return true;
+  }
+  if (n.aux == INF_TAG) {
+    setInf();
+    return true;
+  }
+  return false;
 }
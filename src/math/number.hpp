@@ -24,6 +24,8 @@ class Number {
 
   Number(const Number& n);
 
+  Number(Number&& n) noexcept;
+
   Number(int64_t value);
 
   Number(const std::string& s);
@@ -32,6 +34,8 @@ class Number {
 
   Number& operator=(const Number& n);
 
+  Number& operator=(Number&& n) noexcept;
+
   bool operator==(const Number& n) const;
 
   bool operator!=(const Number& n) const;
@@ -79,6 +83,10 @@ class Number {
 
   static void readIntString(std::istream& in, std::string& out);
 
+  // Total number of heap-allocated big numbers (for benchmarking). The
+  // internal buffers of big numbers are not counted.
+  static size_t getNumHeapAllocations();
+
  private:
   // TODO: avoid this friend class
   friend class SequenceUtil;
@@ -87,12 +95,41 @@ class Number {
 
   static Number minMax(bool is_max);
 
-  bool checkInfArgs(const Number& n);
+  inline bool isHeapBig() const { return aux != 0 && (aux & 3) == 0; }
+
+  inline BigNumber* getBig() const {
+    return reinterpret_cast<BigNumber*>(static_cast<uintptr_t>(aux));
+  }
+
+  void getWide(bool& negative, uint64_t& low, uint64_t& high) const;
+
+  void setWide(bool negative, uint64_t low, uint64_t high);
 
-  void checkInfBig();
+  void setInf();
 
-  void convertToBig();
+  void release();
+
+  BigNumber toBig() const;
+
+  void assignBig(const BigNumber& b);
+
+  void normalizeBig();
+
+  template <typename F>
+  void applyBig(const Number& n, F op);
+
+  void add(const Number& n, bool subtract);
+
+  bool checkInfArgs(const Number& n);
 
+  // The number is stored in two words. The second word determines how the
+  // first one is interpreted:
+  //   aux == 0: small number stored in value
+  //   aux == 1: infinity
+  //   aux & 3 == 3: wide number with magnitude (aux >> 3) * 2^64 + value and
+  //                 the sign in bit 2 of aux; used up to 125 bits
+  //   otherwise: pointer to a heap-allocated big number
+  // The representation is canonical, i.e., the smallest one is always used.
   int64_t value;
-  BigNumber* big;
+  uint64_t aux;
 };
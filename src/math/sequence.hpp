@@ -36,9 +36,3 @@ class Sequence : public std::vector<Number> {
 struct SequenceHasher {
   std::size_t operator()(const Sequence &s) const;
 };
-
-class SequenceToIdsMap
-    : public std::unordered_map<Sequence, std::vector<UID>, SequenceHasher> {
- public:
-  void remove(const Sequence &seq, UID id);
-};
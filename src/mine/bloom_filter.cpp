@@ -0,0 +1,41 @@
+#include "mine/bloom_filter.hpp"
+
+#include <algorithm>
+
+BloomFilter::BloomFilter(size_t num_bits_log2, size_t num_probes)
+    : bits((static_cast<size_t>(1) << std::max<size_t>(num_bits_log2, 6)) / 64,
+           0),
+      mask((static_cast<uint64_t>(1) << std::max<size_t>(num_bits_log2, 6)) -
+           1),
+      num_probes(num_probes) {}
+
+// We use double hashing. The step is derived from the upper bits of the key
+// and must be odd to reach all bits.
+inline uint64_t firstProbe(uint64_t key, uint64_t& step) {
+  uint64_t h = (key ^ (key >> 29)) * 0xbf58476d1ce4e5b9ULL;
+  step = ((h >> 32) | (h << 32)) | 1;
+  return h;
+}
+
+void BloomFilter::insert(uint64_t key) {
+  uint64_t step;
+  uint64_t h = firstProbe(key, step);
+  for (size_t i = 0; i < num_probes; i++, h += step) {
+    const uint64_t b = h & mask;
+    bits[b >> 6] |= static_cast<uint64_t>(1) << (b & 63);
+  }
+}
+
+bool BloomFilter::mayContain(uint64_t key) const {
+  uint64_t step;
+  uint64_t h = firstProbe(key, step);
+  for (size_t i = 0; i < num_probes; i++, h += step) {
+    const uint64_t b = h & mask;
+    if (!(bits[b >> 6] & (static_cast<uint64_t>(1) << (b & 63)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BloomFilter::clear() { std::fill(bits.begin(), bits.end(), 0); }
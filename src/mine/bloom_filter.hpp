@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bloom filter for 64-bit keys. The keys are expected to be well-distributed
+// hash values. Lookups can return false positives, but no false negatives.
+class BloomFilter {
+ public:
+  // Create a filter with 2^num_bits_log2 bits and the given number of probes.
+  BloomFilter(size_t num_bits_log2, size_t num_probes);
+
+  void insert(uint64_t key);
+
+  bool mayContain(uint64_t key) const;
+
+  void clear();
+
+  size_t getMemoryUsage() const { return bits.size() * sizeof(uint64_t); }
+
+ private:
+  std::vector<uint64_t> bits;
+  const uint64_t mask;
+  const size_t num_probes;
+};
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <limits>
 #include <sstream>
+#include <utility>
 
 #include "eval/fold.hpp"
 #include "eval/minimizer.hpp"
@@ -141,11 +142,16 @@ bool isBetterVirEval(const Program& existing, const Program& optimized,
 }
 
 Checker::Checker(const Settings& settings, Evaluator& evaluator,
-                 Minimizer& minimizer, InvalidMatches& invalid_matches)
+                 Minimizer& minimizer, InvalidMatches& invalid_matches,
+                 ReferenceCache reference_cache)
     : evaluator(evaluator),
       minimizer(minimizer),
       invalid_matches(invalid_matches),
-      optimizer(settings) {
+      optimizer(settings),
+      reference_cache(std::move(reference_cache)),
+      max_memory(settings.max_memory),
+      max_cycles(settings.max_cycles),
+      streaming_comparison(true) {
   // Initialize forced_submitter_checks from setup value
   std::string value = Setup::getSetupValue("LODA_FORCED_SUBMITTER_CHECKS");
   std::stringstream ss(value);
@@ -358,33 +364,61 @@ std::string Checker::isOptimizedBetter(Program existing, Program optimized,
 
   // ======= EVALUATION CHECKS =========
 
-  // evaluate optimized program for fixed number of terms
+  // evaluate existing program for fixed number of terms
   num_check = std::min<size_t>(num_check, terms.size());
   num_check = std::max<size_t>(num_check, SequenceUtil::EXTENDED_SEQ_LENGTH);
   Sequence optimized_seq, existing_seq;
+  const auto existing_steps =
+      evalExisting(existing, existing_seq, seq.id, num_check);
+  if (Signals::HALT) {
+    return not_better;  // interrupted evaluation
+  }
+
+  // evaluate optimized program for same number of terms. In streaming mode,
+  // the evaluation stops as soon as the optimized program is provably not
+  // better than the existing one: if it computes a wrong term, or if it
+  // cannot be faster anymore and cannot compute more terms either.
+  const int64_t s = terms.size();
+  const size_t existing_checked = std::min(terms.size(), existing_seq.size());
+  const bool existing_correct =
+      existing_seq.subsequence(0, existing_checked) ==
+      terms.subsequence(0, existing_checked);
+  const bool more_terms_possible =
+      num_check > existing_steps.runs * THRESHOLD_BETTER;
+  const double existing_total = existing_steps.total;
+  std::string stop_rule;
+  Evaluator::term_callback_t on_term;
+  if (streaming_comparison) {
+    on_term = [&](int64_t i, const Number& term, const steps_t& steps) {
+      if (i < s && term != terms[i]) {
+        stop_rule = "wrong term";
+      } else if (existing_correct && !more_terms_possible &&
+                 existing_total <= steps.total * THRESHOLD_FASTER) {
+        stop_rule = "not faster";
+      }
+      return stop_rule.empty();
+    };
+  }
   evaluator.clearCaches();
   auto optimized_steps =
-      evaluator.eval(optimized, optimized_seq, num_check, false);
+      evaluator.eval(optimized, optimized_seq, num_check, false, on_term);
   if (Signals::HALT) {
     return not_better;  // interrupted evaluation
   }
+  if (!stop_rule.empty()) {
+    Log::get().debug("Stopped comparison for " + seq.id.string() + " after " +
+                     std::to_string(optimized_seq.size()) + "/" +
+                     std::to_string(num_check) + " terms: " + stop_rule);
+    return not_better;
+  }
 
   // check if the first decreasing/non-increasing term is beyond the known
   // sequence terms => fake "better" program
-  const int64_t s = terms.size();
   if (optimized_seq.get_first_delta_lt(Number::ZERO) >= s ||  // decreasing
       optimized_seq.get_first_delta_lt(Number::ONE) >= s) {   // non-increasing
     return not_better;  // => fake "better" program
   }
 
-  // evaluate existing program for same number of terms
-  evaluator.clearCaches();
-  const auto existing_steps =
-      evaluator.eval(existing, existing_seq, num_check, false);
-  if (Signals::HALT) {
-    return not_better;  // interrupted evaluation
-  }
-
   // check correctness of the optimized program
   size_t num_checked_terms = std::min(terms.size(), optimized_seq.size());
   if (optimized_seq.subsequence(0, num_checked_terms) !=
@@ -393,9 +427,7 @@ std::string Checker::isOptimizedBetter(Program existing, Program optimized,
   }
 
   // check correctness of the existing program
-  num_checked_terms = std::min(terms.size(), existing_seq.size());
-  if (existing_seq.subsequence(0, num_checked_terms) !=
-      terms.subsequence(0, num_checked_terms)) {
+  if (!existing_correct) {
     return "Corrected";
   }
 
@@ -410,7 +442,6 @@ std::string Checker::isOptimizedBetter(Program existing, Program optimized,
   }
 
   //  compare number of execution steps
-  double existing_total = existing_steps.total;
   double optimized_total = optimized_steps.total;
   if (existing_total > (optimized_total * THRESHOLD_FASTER)) {
     return "Faster";
@@ -438,6 +469,29 @@ std::string Checker::compare(Program p1, Program p2, const std::string& name1,
   return "Both programs are equivalent";
 }
 
+steps_t Checker::evalExisting(const Program& existing, Sequence& seq, UID id,
+                              size_t num_terms) {
+  // the existing program does not change between comparisons: use the cached
+  // result if the program and the evaluation parameters are the same
+  size_t key = SequenceProgram::getTransitiveProgramHash(existing);
+  for (size_t v : {num_terms, static_cast<size_t>(max_memory),
+                   static_cast<size_t>(max_cycles)}) {
+    key = (key * 31) + v;
+  }
+  steps_t steps;
+  if (reference_cache.lookup(id, key, seq, steps)) {
+    return steps;
+  }
+  evaluator.clearCaches();
+  steps = evaluator.eval(existing, seq, num_terms, false);
+  if (!Signals::HALT) {
+    reference_cache.insert(id, key, seq, steps);
+  }
+  return steps;
+}
+
+void Checker::removeCachedReference(UID id) { reference_cache.remove(id); }
+
 void Checker::notifyUnfoldOrMinimizeProblem(const Program& p,
                                             const std::string& id) {
   Log::get().warn("Program for " + id +
@@ -8,6 +8,7 @@
 #include "eval/optimizer.hpp"
 #include "mine/invalid_matches.hpp"
 #include "mine/matcher.hpp"
+#include "mine/reference_cache.hpp"
 
 class ManagedSequence;
 
@@ -19,7 +20,8 @@ struct check_result_t {
 class Checker {
  public:
   Checker(const Settings& settings, Evaluator& evaluator, Minimizer& minimizer,
-          InvalidMatches& invalid_matches);
+          InvalidMatches& invalid_matches,
+          ReferenceCache reference_cache = ReferenceCache());
 
   check_result_t checkProgramExtended(Program program, Program existing,
                                       bool is_new, const ManagedSequence& seq,
@@ -41,12 +43,25 @@ class Checker {
                       const std::string& name2, const ManagedSequence& seq,
                       bool full_check, size_t num_usages);
 
+  // Remove the cached evaluation result of the existing program.
+  void removeCachedReference(UID id);
+
+  // Enable or disable early termination of program comparisons.
+  void setStreamingComparison(bool enabled) { streaming_comparison = enabled; }
+
  private:
   Evaluator& evaluator;
   Minimizer& minimizer;
   InvalidMatches& invalid_matches;
   Optimizer optimizer;
+  ReferenceCache reference_cache;
+  const int64_t max_memory;
+  const int64_t max_cycles;
+  bool streaming_comparison;
   std::unordered_set<std::string> forced_submitter_checks;
 
   void notifyUnfoldOrMinimizeProblem(const Program& p, const std::string& id);
+
+  steps_t evalExisting(const Program& existing, Sequence& seq, UID id,
+                       size_t num_terms);
 };
@@ -24,6 +24,11 @@ Finder::Finder(const Settings &settings, Evaluator &evaluator)
       optimizer(settings),
       minimizer(settings),
       num_find_attempts(0),
+      num_prefix_checks(0),
+      num_prefix_rejects(0),
+      num_match_probes(0),
+      num_match_probe_rejects(0),
+      num_saved_cycles(0),
       invalid_matches(),
       checker(settings, evaluator, minimizer, invalid_matches) {
   auto config = ConfigLoader::load(settings);
@@ -44,23 +49,35 @@ Finder::Finder(const Settings &settings, Evaluator &evaluator)
 }
 
 void Finder::insert(const Sequence &norm_seq, UID id) {
+  const CompactSequence seq(norm_seq);
+  std::unique_lock<std::shared_mutex> lock(matchers_mutex);
   for (auto &matcher : matchers) {
-    matcher->insert(norm_seq, id);
+    matcher->insert(seq, id);
   }
 }
 
 void Finder::remove(const Sequence &norm_seq, UID id) {
+  const CompactSequence seq(norm_seq);
+  std::unique_lock<std::shared_mutex> lock(matchers_mutex);
   for (auto &matcher : matchers) {
-    matcher->remove(norm_seq, id);
+    matcher->remove(seq, id);
   }
 }
 
 Matcher::seq_programs_t Finder::findSequence(const Program &p,
                                              Sequence &norm_seq,
                                              const SequenceIndex &sequences) {
+  return findSequence(p, norm_seq, sequences, evaluator);
+}
+
+Matcher::seq_programs_t Finder::findSequence(const Program &p,
+                                             Sequence &norm_seq,
+                                             const SequenceIndex &sequences,
+                                             Evaluator &evaluator) {
   // update memory usage info
   if (num_find_attempts++ % 1000 == 0) {
     bool has_memory = Setup::hasMemory();
+    std::unique_lock<std::shared_mutex> lock(matchers_mutex);
     for (const auto &matcher : matchers) {
       matcher->has_memory = has_memory;
     }
@@ -75,11 +92,25 @@ Matcher::seq_programs_t Finder::findSequence(const Program &p,
     max_index = largest_used_cell;
   }
 
-  // interpret program
+  // interpret program: evaluate the first terms and reject the program if
+  // none of the matchers can match them; otherwise evaluate remaining terms
+  thread_local std::vector<Sequence> tmp_seqs;
   tmp_seqs.resize(std::max<size_t>(2, max_index + 1));
   Matcher::seq_programs_t result;
+  const int64_t num_terms = settings.num_terms;
+  const int64_t prefix_length =
+      std::min<int64_t>(Matcher::PREFIX_LENGTH, num_terms);
   try {
-    evaluator.eval(p, tmp_seqs);
+    auto steps = evaluator.eval(p, tmp_seqs, prefix_length);
+    num_prefix_checks++;
+    if (!mayMatch(tmp_seqs)) {
+      num_prefix_rejects++;
+      // linear extrapolation of the remaining evaluation cost
+      num_saved_cycles +=
+          (steps.total * (num_terms - prefix_length)) / prefix_length;
+      return result;
+    }
+    evaluator.eval(p, tmp_seqs, num_terms, prefix_length);
     norm_seq = tmp_seqs[1];
   } catch (const std::exception &) {
     // evaluation error
@@ -88,25 +119,50 @@ Matcher::seq_programs_t Finder::findSequence(const Program &p,
   Program p2 = p;
   p2.push_back(Operation::Type::MOV, Operand::Type::DIRECT,
                Program::OUTPUT_CELL, Operand::Type::DIRECT, 0);
+  thread_local CompactSequence compact_seq;
   for (size_t i = 0; i < tmp_seqs.size(); i++) {
+    compact_seq.assign(tmp_seqs[i]);
     if (i == Program::OUTPUT_CELL) {
-      findAll(p, tmp_seqs[i], sequences, result);
+      findAll(p, compact_seq, sequences, evaluator, result);
     } else {
       p2.ops.back().source.value = i;
-      findAll(p2, tmp_seqs[i], sequences, result);
+      findAll(p2, compact_seq, sequences, evaluator, result);
     }
   }
   return result;
 }
 
-void Finder::findAll(const Program &p, const Sequence &norm_seq,
-                     const SequenceIndex &sequences,
+bool Finder::mayMatch(const std::vector<Sequence> &prefixes) {
+  thread_local CompactSequence prefix;
+  std::shared_lock<std::shared_mutex> lock(matchers_mutex);
+  for (const auto &p : prefixes) {
+    prefix.assign(p);
+    for (const auto &matcher : matchers) {
+      if (matcher->mayMatch(prefix)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void Finder::findAll(const Program &p, const CompactSequence &norm_seq,
+                     const SequenceIndex &sequences, Evaluator &evaluator,
                      Matcher::seq_programs_t &result) {
   // collect possible matches
+  thread_local Matcher::seq_programs_t tmp_result;
   std::pair<UID, Program> last(UID('A', 0), Program());
   for (size_t i = 0; i < matchers.size(); i++) {
     tmp_result.clear();
-    matchers[i]->match(p, norm_seq, tmp_result);
+    {
+      std::shared_lock<std::shared_mutex> lock(matchers_mutex);
+      num_match_probes++;
+      if (!matchers[i]->mayMatch(norm_seq)) {
+        num_match_probe_rejects++;
+        continue;
+      }
+      matchers[i]->match(p, norm_seq, tmp_result);
+    }
 
     // validate the found matches
     for (auto t : tmp_result) {
@@ -130,13 +186,34 @@ void Finder::findAll(const Program &p, const Sequence &norm_seq,
   }
 }
 
+std::string Finder::getPrefixFilterSummary() {
+  const size_t checks = num_prefix_checks.exchange(0);
+  const size_t rejects = num_prefix_rejects.exchange(0);
+  const size_t probes = num_match_probes.exchange(0);
+  const size_t probe_rejects = num_match_probe_rejects.exchange(0);
+  const size_t saved = num_saved_cycles.exchange(0);
+  if (checks == 0) {
+    return "";
+  }
+  std::stringstream buf;
+  buf.setf(std::ios::fixed);
+  buf.precision(1);
+  buf << "Prefix filter rejected " << (100.0 * rejects / checks)
+      << "% of programs and "
+      << (100.0 * probe_rejects / std::max<size_t>(probes, 1))
+      << "% of matcher probes, saving ~" << saved << " cycles";
+  return buf.str();
+}
+
 void Finder::logSummary(size_t loaded_count) {
   std::stringstream buf;
   buf << "Matcher compaction ratios: ";
+  std::shared_lock<std::shared_mutex> lock(matchers_mutex);
   for (size_t i = 0; i < matchers.size(); i++) {
     if (i > 0) buf << ", ";
     buf << matchers[i]->getName() << ": " << std::setprecision(3)
-        << matchers[i]->getCompationRatio() << "%";
+        << matchers[i]->getCompationRatio() << "% ("
+        << (matchers[i]->getMemoryUsage() / (1024 * 1024)) << " MiB)";
   }
   Log::get().debug(buf.str());
 }
\ No newline at end of file
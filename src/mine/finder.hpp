@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <shared_mutex>
 
 #include "base/uid.hpp"
 #include "eval/evaluator.hpp"
@@ -25,15 +27,31 @@ class Finder {
   Matcher::seq_programs_t findSequence(const Program &p, Sequence &norm_seq,
                                        const SequenceIndex &sequences);
 
+  // Thread-safe variant for concurrent mining threads. Matches are evaluated
+  // using the given evaluator instead of the shared instance. The matcher
+  // tables are shared with all other threads.
+  Matcher::seq_programs_t findSequence(const Program &p, Sequence &norm_seq,
+                                       const SequenceIndex &sequences,
+                                       Evaluator &evaluator);
+
   std::vector<std::unique_ptr<Matcher>> &getMatchers() { return matchers; }
 
   Checker &getChecker() { return checker; }
 
+  InvalidMatches &getInvalidMatches() { return invalid_matches; }
+
   void logSummary(size_t loaded_count);
 
+  // Summary of the prefix filter statistics since the last call, or an empty
+  // string if no programs were checked.
+  std::string getPrefixFilterSummary();
+
  private:
-  void findAll(const Program &p, const Sequence &norm_seq,
-               const SequenceIndex &sequences, Matcher::seq_programs_t &result);
+  bool mayMatch(const std::vector<Sequence> &prefixes);
+
+  void findAll(const Program &p, const CompactSequence &norm_seq,
+               const SequenceIndex &sequences, Evaluator &evaluator,
+               Matcher::seq_programs_t &result);
 
   void notifyUnfoldOrMinimizeProblem(const Program &p, const std::string &id);
 
@@ -42,13 +60,13 @@ class Finder {
   Optimizer optimizer;
   Minimizer minimizer;
   std::vector<std::unique_ptr<Matcher>> matchers;
-  mutable size_t num_find_attempts;
+  std::shared_mutex matchers_mutex;  // guards the matcher tables
+  std::atomic<size_t> num_find_attempts;
+  std::atomic<size_t> num_prefix_checks;
+  std::atomic<size_t> num_prefix_rejects;
+  std::atomic<size_t> num_match_probes;
+  std::atomic<size_t> num_match_probe_rejects;
+  std::atomic<size_t> num_saved_cycles;  // estimated
   InvalidMatches invalid_matches;
   Checker checker;
-
-  // temporary containers (cached as members)
-  mutable std::unordered_set<int64_t> tmp_used_cells;
-  mutable std::vector<Sequence> tmp_seqs;
-  mutable Matcher::seq_programs_t tmp_result;
-  mutable std::map<std::string, std::string> tmp_matcher_labels;
 };
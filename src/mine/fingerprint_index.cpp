@@ -0,0 +1,196 @@
+#include "mine/fingerprint_index.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+inline void writeVarInt(std::vector<uint8_t>& out, int64_t value) {
+  uint64_t z = (static_cast<uint64_t>(value) << 1) ^
+               static_cast<uint64_t>(value >> 63);
+  while (z >= 0x80) {
+    out.push_back(static_cast<uint8_t>(z | 0x80));
+    z >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(z));
+}
+
+inline int64_t readVarInt(const uint8_t*& pos) {
+  uint64_t z = 0;
+  int shift = 0;
+  while (*pos & 0x80) {
+    z |= static_cast<uint64_t>(*pos++ & 0x7f) << shift;
+    shift += 7;
+  }
+  z |= static_cast<uint64_t>(*pos++) << shift;
+  return static_cast<int64_t>((z >> 1) ^ (~(z & 1) + 1));
+}
+
+FingerprintIndex::FingerprintIndex() : num_sequences(0), num_used_slots(0) {}
+
+uint64_t FingerprintIndex::fingerprint(const CompactSequence& seq) {
+  return seq.hash();
+}
+
+void FingerprintIndex::insert(const CompactSequence& seq, UID id) {
+  const uint64_t fp = fingerprint(seq);
+  const uint32_t head = findEntry(seq, fp);
+  if (head != NONE) {
+    auto& e = entries[head];
+    if (e.length & REMOVED_FLAG) {
+      e.length &= ~REMOVED_FLAG;
+      e.id = id;
+      num_sequences++;
+    } else {
+      // additional ID for an existing sequence: append it at the end of the
+      // chain to keep the insertion order
+      uint32_t tail = head;
+      while (entries[tail].next != NONE) {
+        tail = entries[tail].next;
+      }
+      Entry dup = e;
+      dup.next = NONE;
+      dup.id = id;
+      entries[tail].next = static_cast<uint32_t>(entries.size());
+      entries.push_back(dup);
+    }
+    return;
+  }
+  if (seq.size() > LENGTH_MASK || entries.size() >= NONE) {
+    throw std::runtime_error("fingerprint index overflow");
+  }
+  Entry e;
+  e.fingerprint = fp;
+  e.length = static_cast<uint32_t>(seq.size());
+  e.id = id;
+  e.next = NONE;
+  if (!seq.isSmall()) {
+    e.offset = static_cast<uint32_t>(big_seqs.size());
+    e.length |= BIG_FLAG;
+    big_seqs.push_back(seq);
+  } else {
+    if (arena.size() >= NONE) {
+      throw std::runtime_error("fingerprint index overflow");
+    }
+    e.offset = static_cast<uint32_t>(arena.size());
+    const int64_t* terms = seq.data();
+    for (size_t i = 0; i < seq.size(); i++) {
+      writeVarInt(arena, terms[i]);
+    }
+  }
+  if (2 * (num_used_slots + 1) > slots.size()) {
+    grow();
+  }
+  const size_t mask = slots.size() - 1;
+  size_t slot = fp & mask;
+  while (slots[slot] != NONE) {
+    slot = (slot + 1) & mask;
+  }
+  slots[slot] = static_cast<uint32_t>(entries.size());
+  entries.push_back(e);
+  num_used_slots++;
+  num_sequences++;
+}
+
+void FingerprintIndex::remove(const CompactSequence& seq, UID id) {
+  const uint32_t head = findEntry(seq, fingerprint(seq));
+  if (head == NONE || (entries[head].length & REMOVED_FLAG)) {
+    return;
+  }
+  // remove all occurrences of the ID; unlinked entries are not reused
+  uint32_t prev = head;
+  uint32_t cur = entries[head].next;
+  while (cur != NONE) {
+    if (entries[cur].id == id) {
+      entries[prev].next = entries[cur].next;
+    } else {
+      prev = cur;
+    }
+    cur = entries[cur].next;
+  }
+  auto& e = entries[head];
+  if (e.id == id) {
+    if (e.next != NONE) {
+      e.id = entries[e.next].id;
+      e.next = entries[e.next].next;
+    } else {
+      // keep the slot and the terms for re-insertion
+      e.length |= REMOVED_FLAG;
+      num_sequences--;
+    }
+  }
+}
+
+bool FingerprintIndex::find(const CompactSequence& seq,
+                            std::vector<UID>& result) const {
+  const uint32_t head = findEntry(seq, fingerprint(seq));
+  if (head == NONE || (entries[head].length & REMOVED_FLAG)) {
+    return false;
+  }
+  for (uint32_t i = head; i != NONE; i = entries[i].next) {
+    result.push_back(entries[i].id);
+  }
+  return true;
+}
+
+size_t FingerprintIndex::getMemoryUsage() const {
+  size_t result = slots.capacity() * sizeof(uint32_t) +
+                  entries.capacity() * sizeof(Entry) + arena.capacity() +
+                  big_seqs.capacity() * sizeof(CompactSequence);
+  for (const auto& s : big_seqs) {
+    result += s.getMemoryUsage();
+  }
+  return result;
+}
+
+uint32_t FingerprintIndex::findEntry(const CompactSequence& seq,
+                                     uint64_t fp) const {
+  if (slots.empty()) {
+    return NONE;
+  }
+  const size_t mask = slots.size() - 1;
+  for (size_t slot = fp & mask; slots[slot] != NONE;
+       slot = (slot + 1) & mask) {
+    const auto& e = entries[slots[slot]];
+    if (e.fingerprint == fp && equals(e, seq)) {
+      return slots[slot];
+    }
+  }
+  return NONE;
+}
+
+bool FingerprintIndex::equals(const Entry& e,
+                              const CompactSequence& seq) const {
+  if ((e.length & LENGTH_MASK) != seq.size()) {
+    return false;
+  }
+  if (e.length & BIG_FLAG) {
+    return big_seqs[e.offset] == seq;
+  }
+  if (!seq.isSmall()) {
+    return false;
+  }
+  const uint8_t* pos = arena.data() + e.offset;
+  const int64_t* terms = seq.data();
+  for (size_t i = 0; i < seq.size(); i++) {
+    if (terms[i] != readVarInt(pos)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FingerprintIndex::grow() {
+  const size_t new_size = std::max<size_t>(16, 2 * slots.size());
+  std::vector<uint32_t> old_slots(new_size, NONE);
+  old_slots.swap(slots);
+  const size_t mask = slots.size() - 1;
+  for (auto index : old_slots) {
+    if (index == NONE) {
+      continue;
+    }
+    size_t slot = entries[index].fingerprint & mask;
+    while (slots[slot] != NONE) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = index;
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "base/uid.hpp"
+#include "math/compact_sequence.hpp"
+
+// Compact map from sequences to IDs used by the matchers. Sequences are
+// identified by their 64-bit hashes in an open-addressing hash table. The
+// terms are stored in a flat arena using a variable-length encoding and are
+// compared only if the fingerprints match. Sequences with terms that do not
+// fit into int64 are stored separately.
+class FingerprintIndex {
+ public:
+  FingerprintIndex();
+
+  static uint64_t fingerprint(const CompactSequence &seq);
+
+  void insert(const CompactSequence &seq, UID id);
+
+  void remove(const CompactSequence &seq, UID id);
+
+  // Append the IDs of a sequence to the result in insertion order. Returns
+  // false if the sequence is not contained in the index.
+  bool find(const CompactSequence &seq, std::vector<UID> &result) const;
+
+  // Number of distinct sequences.
+  size_t size() const { return num_sequences; }
+
+  // Approximate memory usage in bytes.
+  size_t getMemoryUsage() const;
+
+ private:
+  static constexpr uint32_t NONE = 0xffffffff;
+  static constexpr uint32_t BIG_FLAG = 0x80000000;
+  static constexpr uint32_t REMOVED_FLAG = 0x40000000;
+  static constexpr uint32_t LENGTH_MASK = 0x3fffffff;
+
+  class Entry {
+   public:
+    uint64_t fingerprint;
+    uint32_t offset;  // arena offset or index of big sequence
+    uint32_t length;  // number of terms and flags
+    UID id;
+    uint32_t next;  // next entry of the same sequence or NONE
+  };
+
+  uint32_t findEntry(const CompactSequence &seq, uint64_t fp) const;
+
+  bool equals(const Entry &e, const CompactSequence &seq) const;
+
+  void grow();
+
+  std::vector<uint32_t> slots;  // index of first entry of a sequence or NONE
+  std::vector<Entry> entries;
+  std::vector<uint8_t> arena;  // zigzag varint encoded terms
+  std::vector<CompactSequence> big_seqs;
+  size_t num_sequences;
+  size_t num_used_slots;
+};
@@ -21,6 +21,7 @@ void InvalidMatches::load() {
   }
   
   auto path = cache_path;
+  std::lock_guard<std::mutex> lock(mutex);
   try {
     SequenceList::loadMap(path, invalid_matches);
   } catch (const std::exception&) {
@@ -31,6 +32,7 @@ void InvalidMatches::load() {
 }
 
 bool InvalidMatches::hasTooMany(UID id) const {
+  std::lock_guard<std::mutex> lock(mutex);
   auto it = invalid_matches.find(id);
   if (it != invalid_matches.end() && it->second > 0) {
     int64_t r = Random::get().gen() % it->second;
@@ -40,6 +42,7 @@ bool InvalidMatches::hasTooMany(UID id) const {
 }
 
 void InvalidMatches::insert(UID id) {
+  std::lock_guard<std::mutex> lock(mutex);
   invalid_matches[id]++;
   if (scheduler.isTargetReached()) {
     scheduler.reset();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "base/uid.hpp"
@@ -17,4 +18,5 @@ class InvalidMatches {
  private:
   std::map<UID, int64_t> invalid_matches;
   AdaptiveScheduler scheduler;
+  mutable std::mutex mutex;
 };
@@ -1,5 +1,7 @@
 #include "mine/matcher.hpp"
 
+#include <array>
+
 #include "eval/optimizer.hpp"
 #include "math/semantics.hpp"
 #include "mine/reducer.hpp"
@@ -27,41 +29,81 @@ Matcher::UPtr Matcher::Factory::create(const Matcher::Config& config) {
   return result;
 }
 
+// --- Prefix Keys ------------------------------------------------------------
+
+inline uint64_t mixPrefixKey(uint64_t key, const Number& n) {
+  const uint64_t v = n.fitsInInt64() ? static_cast<uint64_t>(n.asInt())
+                                     : static_cast<uint64_t>(n.hash());
+  return key ^ (v + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2));
+}
+
+// Key of the first terms that is invariant under transformations a*x+b with
+// a>0: the differences of consecutive terms divided by their gcd.
+bool affinePrefixKey(const CompactSequence& seq, uint64_t& key) {
+  const size_t n = std::min(seq.size(), Matcher::PREFIX_LENGTH);
+  std::array<Number, Matcher::PREFIX_LENGTH> deltas;
+  Number g = Number::ZERO;
+  for (size_t i = 1; i < n; i++) {
+    deltas[i] = Semantics::sub(seq.get(i), seq.get(i - 1));
+    g = Semantics::gcd(g, deltas[i]);
+  }
+  if (g == Number::INF) {
+    return false;
+  }
+  key = n;
+  for (size_t i = 1; i < n; i++) {
+    key = mixPrefixKey(key, g == Number::ZERO ? deltas[i]
+                                              : Semantics::div(deltas[i], g));
+  }
+  return true;
+}
+
 // --- AbstractMatcher --------------------------------------------------------
 
 template <class T>
-void AbstractMatcher<T>::insert(const Sequence& norm_seq, UID id) {
-  auto reduced = reduce(norm_seq, false);
-  if (!reduced.first.empty()) {
-    data[id] = reduced.second;
-    ids[reduced.first].push_back(id);
+void AbstractMatcher<T>::insert(const CompactSequence& norm_seq, UID id) {
+  CompactSequence reduced = norm_seq;
+  auto info = reduce(reduced, false);
+  if (!reduced.empty()) {
+    data[id] = info;
+    ids.insert(reduced, id);
+    uint64_t key;
+    if (prefixKey(norm_seq, key)) {
+      prefix_filter.insert(key);  // not removed, which is safe
+    }
   }
 }
 
 template <class T>
-void AbstractMatcher<T>::remove(const Sequence& norm_seq, UID id) {
-  auto reduced = reduce(norm_seq, false);
-  if (!reduced.first.empty()) {
-    ids.remove(reduced.first, id);
+void AbstractMatcher<T>::remove(const CompactSequence& norm_seq, UID id) {
+  CompactSequence reduced = norm_seq;
+  reduce(reduced, false);
+  if (!reduced.empty()) {
+    ids.remove(reduced, id);
     data.erase(id);
   }
 }
 
 template <class T>
-void AbstractMatcher<T>::match(const Program& p, const Sequence& norm_seq,
+void AbstractMatcher<T>::match(const Program& p,
+                               const CompactSequence& norm_seq,
                                seq_programs_t& result) const {
   if (!shouldMatchSequence(norm_seq)) {
     return;
   }
-  auto reduced = reduce(norm_seq, true);
-  if (!shouldMatchSequence(reduced.first) && norm_seq != reduced.first) {
+  // reuse buffers to avoid allocations
+  static thread_local CompactSequence reduced;
+  static thread_local std::vector<UID> found;
+  reduced = norm_seq;
+  auto info = reduce(reduced, true);
+  if (!shouldMatchSequence(reduced) && norm_seq != reduced) {
     return;
   }
-  auto it = ids.find(reduced.first);
-  if (it != ids.end()) {
-    for (auto id : it->second) {
+  found.clear();
+  if (ids.find(reduced, found)) {
+    for (auto id : found) {
       Program copy = p;
-      if (extend(copy, data.at(id), reduced.second)) {
+      if (extend(copy, data.at(id), info)) {
         result.push_back(std::pair<UID, Program>(id, copy));
         if (backoff && (Random::get().gen() % 10) == 0)  // magic number
         {
@@ -74,9 +116,18 @@ void AbstractMatcher<T>::match(const Program& p, const Sequence& norm_seq,
 }
 
 template <class T>
-bool AbstractMatcher<T>::shouldMatchSequence(const Sequence& seq) const {
+bool AbstractMatcher<T>::mayMatch(const CompactSequence& prefix) const {
+  uint64_t key;
+  return !prefixKey(prefix, key) || prefix_filter.mayContain(key);
+}
+
+template <class T>
+bool AbstractMatcher<T>::shouldMatchSequence(
+    const CompactSequence& seq) const {
   if (backoff) {
-    if (match_attempts.find(seq) != match_attempts.end()) {
+    std::lock_guard<std::mutex> lock(match_attempts_mutex);
+    const auto fp = FingerprintIndex::fingerprint(seq);
+    if (match_attempts.find(fp) != match_attempts.end()) {
       // Log::get().debug( "Back off matching of already matched sequence " +
       // seq.to_string() );
       return false;
@@ -84,7 +135,7 @@ bool AbstractMatcher<T>::shouldMatchSequence(const Sequence& seq) const {
     if ((has_memory || match_attempts.size() < 1000) &&  // magic number
         (Random::get().gen() % 10) == 0)                 // magic number
     {
-      match_attempts.insert(seq);
+      match_attempts.insert(fp);
     }
   }
   return true;
@@ -92,24 +143,28 @@ bool AbstractMatcher<T>::shouldMatchSequence(const Sequence& seq) const {
 
 // --- Direct Matcher ---------------------------------------------------------
 
-std::pair<Sequence, int> DirectMatcher::reduce(const Sequence& seq,
-                                               bool match) const {
-  std::pair<Sequence, int> result;
-  result.first = seq;
-  result.second = 0;
-  return result;
+int DirectMatcher::reduce(CompactSequence& seq, bool match) const {
+  return 0;
 }
 
 bool DirectMatcher::extend(Program& p, int base, int gen) const { return true; }
 
+bool DirectMatcher::prefixKey(const CompactSequence& seq,
+                              uint64_t& key) const {
+  const size_t n = std::min(seq.size(), PREFIX_LENGTH);
+  key = n;
+  for (size_t i = 0; i < n; i++) {
+    key = mixPrefixKey(key, seq.get(i));
+  }
+  return true;
+}
+
 // --- Linear Matcher ---------------------------------------------------------
 
-std::pair<Sequence, line_t> LinearMatcher::reduce(const Sequence& seq,
-                                                  bool match) const {
-  std::pair<Sequence, line_t> result;
-  result.first = seq;
-  result.second.offset = Reducer::truncate(result.first);
-  result.second.factor = Reducer::shrink(result.first);
+line_t LinearMatcher::reduce(CompactSequence& seq, bool match) const {
+  line_t result;
+  result.offset = Reducer::truncate(seq);
+  result.factor = Reducer::shrink(seq);
   return result;
 }
 
@@ -117,12 +172,15 @@ bool LinearMatcher::extend(Program& p, line_t base, line_t gen) const {
   return Extender::linear1(p, gen, base);
 }
 
-std::pair<Sequence, line_t> LinearMatcher2::reduce(const Sequence& seq,
-                                                   bool match) const {
-  std::pair<Sequence, line_t> result;
-  result.first = seq;
-  result.second.factor = Reducer::shrink(result.first);
-  result.second.offset = Reducer::truncate(result.first);
+bool LinearMatcher::prefixKey(const CompactSequence& seq,
+                              uint64_t& key) const {
+  return affinePrefixKey(seq, key);
+}
+
+line_t LinearMatcher2::reduce(CompactSequence& seq, bool match) const {
+  line_t result;
+  result.factor = Reducer::shrink(seq);
+  result.offset = Reducer::truncate(seq);
   return result;
 }
 
@@ -130,16 +188,17 @@ bool LinearMatcher2::extend(Program& p, line_t base, line_t gen) const {
   return Extender::linear2(p, gen, base);
 }
 
+bool LinearMatcher2::prefixKey(const CompactSequence& seq,
+                               uint64_t& key) const {
+  return affinePrefixKey(seq, key);
+}
+
 // --- Delta Matcher ----------------------------------------------------------
 
 const int64_t DeltaMatcher::MAX_DELTA = 4;  // magic number
 
-std::pair<Sequence, delta_t> DeltaMatcher::reduce(const Sequence& seq,
-                                                  bool match) const {
-  std::pair<Sequence, delta_t> result;
-  result.first = seq;
-  result.second = Reducer::delta(result.first, MAX_DELTA);
-  return result;
+delta_t DeltaMatcher::reduce(CompactSequence& seq, bool match) const {
+  return Reducer::delta(seq, MAX_DELTA);
 }
 
 bool DeltaMatcher::extend(Program& p, delta_t base, delta_t gen) const {
@@ -167,22 +226,35 @@ bool DeltaMatcher::extend(Program& p, delta_t base, delta_t gen) const {
 
 // --- Digit Matcher ----------------------------------------------------------
 
-std::pair<Sequence, int64_t> DigitMatcher::reduce(const Sequence& seq,
-                                                  bool match) const {
-  std::pair<Sequence, int64_t> result;
-  result.first = seq;
-  result.second = Reducer::digit(result.first, num_digits);
+int64_t DigitMatcher::reduce(CompactSequence& seq, bool match) const {
   if (!match) {
-    for (auto& n : seq) {
-      if (n < Number::ZERO || !(n < num_digits_big)) {
-        result.first.clear();
-        break;
+    const int64_t* v = seq.data();
+    for (size_t i = 0; i < seq.size(); i++) {
+      if (!seq.isSmall() || v[i] < 0 || v[i] >= num_digits) {
+        seq.clear();
+        return 0;
       }
     }
   }
-  return result;
+  return Reducer::digit(seq, num_digits);
 }
 
 bool DigitMatcher::extend(Program& p, int64_t base, int64_t gen) const {
   return Extender::digit(p, num_digits, base - gen);
 }
+
+bool DigitMatcher::prefixKey(const CompactSequence& seq,
+                             uint64_t& key) const {
+  // the reduction shifts all digits by the same offset
+  const size_t n = std::min(seq.size(), PREFIX_LENGTH);
+  key = n;
+  for (size_t i = 1; i < n; i++) {
+    auto d = Semantics::mod(Semantics::sub(seq.get(i), seq.get(0)),
+                            num_digits_big);
+    if (d < Number::ZERO) {
+      d += num_digits_big;
+    }
+    key = mixPrefixKey(key, d);
+  }
+  return true;
+}
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <unordered_set>
 
 #include "base/uid.hpp"
 #include "lang/program.hpp"
+#include "mine/bloom_filter.hpp"
 #include "mine/extender.hpp"
+#include "mine/fingerprint_index.hpp"
 #include "mine/reducer.hpp"
 
 class Matcher {
@@ -14,6 +17,9 @@ class Matcher {
 
   using UPtr = std::unique_ptr<Matcher>;
 
+  // Number of terms used for rejecting sequences before full evaluation.
+  static constexpr size_t PREFIX_LENGTH = 3;
+
   class Config {
    public:
     std::string type;
@@ -27,17 +33,25 @@ class Matcher {
 
   virtual ~Matcher() {}
 
-  virtual void insert(const Sequence &norm_seq, UID id) = 0;
+  virtual void insert(const CompactSequence &norm_seq, UID id) = 0;
 
-  virtual void remove(const Sequence &norm_seq, UID id) = 0;
+  virtual void remove(const CompactSequence &norm_seq, UID id) = 0;
 
-  virtual void match(const Program &p, const Sequence &norm_seq,
+  virtual void match(const Program &p, const CompactSequence &norm_seq,
                      seq_programs_t &result) const = 0;
 
+  // Returns false if no sequence starting with the first terms of the given
+  // sequence can be matched. It is sufficient to pass the first PREFIX_LENGTH
+  // terms. False positives are possible.
+  virtual bool mayMatch(const CompactSequence &prefix) const = 0;
+
   virtual const std::string &getName() const = 0;
 
   virtual double getCompationRatio() const = 0;
 
+  // Approximate memory usage of the sequence table in bytes.
+  virtual size_t getMemoryUsage() const = 0;
+
   bool has_memory = true;
 };
 
@@ -45,36 +59,54 @@ template <class T>
 class AbstractMatcher : public Matcher {
  public:
   AbstractMatcher(const std::string &name, bool backoff)
-      : name(name), backoff(backoff) {}
+      : name(name),
+        prefix_filter(23, 3),  // 1 MiB (magic number)
+        backoff(backoff) {}
 
   virtual ~AbstractMatcher() {}
 
-  virtual void insert(const Sequence &norm_seq, UID id) override;
+  virtual void insert(const CompactSequence &norm_seq, UID id) override;
 
-  virtual void remove(const Sequence &norm_seq, UID id) override;
+  virtual void remove(const CompactSequence &norm_seq, UID id) override;
 
-  virtual void match(const Program &p, const Sequence &norm_seq,
+  virtual void match(const Program &p, const CompactSequence &norm_seq,
                      seq_programs_t &result) const override;
 
+  virtual bool mayMatch(const CompactSequence &prefix) const override;
+
   virtual const std::string &getName() const override { return name; }
 
   virtual double getCompationRatio() const override {
     return 100.0 - (100.0 * ids.size() / std::max<size_t>(data.size(), 1));
   }
 
+  virtual size_t getMemoryUsage() const override {
+    return ids.getMemoryUsage() + prefix_filter.getMemoryUsage();
+  }
+
  protected:
-  virtual std::pair<Sequence, T> reduce(const Sequence &seq,
-                                        bool match) const = 0;
+  // Reduce a sequence in place and return the reduction parameters. An empty
+  // sequence indicates that it cannot be reduced.
+  virtual T reduce(CompactSequence &seq, bool match) const = 0;
 
   virtual bool extend(Program &p, T base, T gen) const = 0;
 
+  // Compute a key of the first PREFIX_LENGTH terms of a sequence that is the
+  // same for all sequences with the same reduced sequence. Returns false if
+  // the matcher does not support prefix keys.
+  virtual bool prefixKey(const CompactSequence &seq, uint64_t &key) const {
+    return false;
+  }
+
  private:
-  bool shouldMatchSequence(const Sequence &seq) const;
+  bool shouldMatchSequence(const CompactSequence &seq) const;
 
   std::string name;
-  SequenceToIdsMap ids;
+  FingerprintIndex ids;
+  BloomFilter prefix_filter;  // prefix keys of all inserted sequences
   std::unordered_map<UID, T> data;
-  mutable std::unordered_set<Sequence, SequenceHasher> match_attempts;
+  mutable std::unordered_set<uint64_t> match_attempts;  // fingerprints
+  mutable std::mutex match_attempts_mutex;  // matching is multi-threaded
   bool backoff;
 };
 
@@ -85,10 +117,12 @@ class DirectMatcher : public AbstractMatcher<int> {
   virtual ~DirectMatcher() {}
 
  protected:
-  virtual std::pair<Sequence, int> reduce(const Sequence &seq,
-                                          bool match) const override;
+  virtual int reduce(CompactSequence &seq, bool match) const override;
 
   virtual bool extend(Program &p, int base, int gen) const override;
+
+  virtual bool prefixKey(const CompactSequence &seq,
+                         uint64_t &key) const override;
 };
 
 class LinearMatcher : public AbstractMatcher<line_t> {
@@ -98,10 +132,12 @@ class LinearMatcher : public AbstractMatcher<line_t> {
   virtual ~LinearMatcher() {}
 
  protected:
-  virtual std::pair<Sequence, line_t> reduce(const Sequence &seq,
-                                             bool match) const override;
+  virtual line_t reduce(CompactSequence &seq, bool match) const override;
 
   virtual bool extend(Program &p, line_t base, line_t gen) const override;
+
+  virtual bool prefixKey(const CompactSequence &seq,
+                         uint64_t &key) const override;
 };
 
 class LinearMatcher2 : public AbstractMatcher<line_t> {
@@ -111,10 +147,12 @@ class LinearMatcher2 : public AbstractMatcher<line_t> {
   virtual ~LinearMatcher2() {}
 
  protected:
-  virtual std::pair<Sequence, line_t> reduce(const Sequence &seq,
-                                             bool match) const override;
+  virtual line_t reduce(CompactSequence &seq, bool match) const override;
 
   virtual bool extend(Program &p, line_t base, line_t gen) const override;
+
+  virtual bool prefixKey(const CompactSequence &seq,
+                         uint64_t &key) const override;
 };
 
 class DeltaMatcher : public AbstractMatcher<delta_t> {
@@ -126,8 +164,7 @@ class DeltaMatcher : public AbstractMatcher<delta_t> {
   virtual ~DeltaMatcher() {}
 
  protected:
-  virtual std::pair<Sequence, delta_t> reduce(const Sequence &seq,
-                                              bool match) const override;
+  virtual delta_t reduce(CompactSequence &seq, bool match) const override;
 
   virtual bool extend(Program &p, delta_t base, delta_t gen) const override;
 };
@@ -142,11 +179,13 @@ class DigitMatcher : public AbstractMatcher<int64_t> {
   virtual ~DigitMatcher() {}
 
  protected:
-  virtual std::pair<Sequence, int64_t> reduce(const Sequence &seq,
-                                              bool match) const override;
+  virtual int64_t reduce(CompactSequence &seq, bool match) const override;
 
   virtual bool extend(Program &p, int64_t base, int64_t gen) const override;
 
+  virtual bool prefixKey(const CompactSequence &seq,
+                         uint64_t &key) const override;
+
  private:
   const int64_t num_digits;
   const Number num_digits_big;
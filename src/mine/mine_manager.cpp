@@ -4,21 +4,25 @@
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <thread>
 
 #include "eval/fold.hpp"
 #include "eval/interpreter.hpp"
 #include "eval/optimizer.hpp"
 #include "form/formula_gen.hpp"
 #include "lang/comments.hpp"
+#include "lang/program_archive.hpp"
 #include "lang/program_util.hpp"
 #include "mine/config.hpp"
 #include "mine/stats.hpp"
+#include "seq/bfile_cache.hpp"
 #include "seq/seq_list.hpp"
 #include "seq/seq_program.hpp"
 #include "sys/file.hpp"
@@ -52,7 +56,7 @@ MineManager::MineManager(const Settings& settings,
       is_api_server(Setup::getSetupFlag("LODA_IS_API_SERVER", false)),
       optimizer(settings),
       minimizer(settings),
-      loader(sequences, settings.num_terms),
+      loader(sequences, settings.num_terms, settings.use_shared_seqs),
       stats_home(stats_home.empty()
                      ? (Setup::getLodaHome() + "stats" + FILE_SEP)
                      : stats_home) {
@@ -61,12 +65,17 @@ MineManager::MineManager(const Settings& settings,
   domains = config.domains;
 }
 
+MineManager::~MineManager() { BFileCache::get().stopPrefetch(); }
+
 void MineManager::load() {
   // check if already loaded
   if (getTotalCount() > 0) {
     return;
   }
 
+  // discard b-file terms of previously loaded sequences
+  BFileCache::get().clear();
+
   // first load the custom sequences lists (needs no lock)
   const std::string oeis_progs = Setup::getProgramsHome() + "oeis" + FILE_SEP;
   SequenceList::loadList(oeis_progs + "deny.txt", deny_list);
@@ -103,6 +112,14 @@ void MineManager::load() {
 
   // check consistency
   loader.checkConsistency();
+
+  // update the program archive
+  {
+    // obtain lock
+    FolderLock lock(Setup::getCacheHome());
+    ProgramArchive::get().update();
+    // lock released at the end of this block
+  }
 }
 
 Finder& MineManager::getFinder() {
@@ -309,46 +326,81 @@ void MineManager::generateStats(int64_t age_in_days) {
   }
   Log::get().info(msg);
   auto start_time = std::chrono::steady_clock::now();
-  stats.reset(new Stats());
-
-  size_t num_processed = 0;
-  Program program;
-  std::string file_name, submitter;
-  bool has_program, has_formula;
-
-  AdaptiveScheduler notify(20);  // magic number
+  // collect the IDs in the order of the sequence index
+  std::vector<UID> ids;
   for (const auto& s : sequences) {
-    file_name = ProgramUtil::getProgramPath(s.id);
-    std::ifstream program_file(file_name);
-    has_program = false;
-    has_formula = false;
-    if (program_file.good()) {
-      try {
-        program = parser.parse(program_file);
-        has_program = true;
-        std::string formula_str =
-            Comments::getCommentField(program, Comments::PREFIX_FORMULA);
-        has_formula = !formula_str.empty();
-        submitter = Comments::getSubmitter(program);
-        int64_t offset = ProgramUtil::getOffset(program);
-        ProgramUtil::removeOps(program, Operation::Type::NOP);
-
-        // update stats
-        stats->updateProgramStats(s.id, program, submitter, formula_str,
-                                  offset);
-        num_processed++;
-      } catch (const std::exception& exc) {
-        Log::get().error(
-            "Error parsing " + file_name + ": " + std::string(exc.what()),
-            false);
+    ids.push_back(s.id);
+  }
+
+  // process shards of consecutive IDs in parallel. The partial stats are
+  // merged in the original order to obtain the same result as serially.
+  int64_t num_threads = settings.num_stats_threads;
+  if (num_threads <= 0) {
+    num_threads =
+        std::max<int64_t>(1, std::thread::hardware_concurrency());
+  }
+  const size_t num_shards =
+      std::max<size_t>(1, std::min<size_t>(ids.size(), 4 * num_threads));
+  std::vector<std::unique_ptr<Stats>> shards(num_shards);
+  std::atomic<size_t> next_shard(0);
+  std::atomic<size_t> num_processed(0);
+  auto worker = [&](bool report) {
+    Program program;
+    std::string file_name, submitter;
+    bool has_program, has_formula;
+    AdaptiveScheduler notify(20);  // magic number
+    for (size_t k = next_shard++; k < num_shards; k = next_shard++) {
+      std::unique_ptr<Stats> shard(new Stats());
+      const size_t begin = k * ids.size() / num_shards;
+      const size_t end = (k + 1) * ids.size() / num_shards;
+      for (size_t i = begin; i < end; i++) {
+        const auto id = ids[i];
+        file_name = ProgramUtil::getProgramPath(id);
+        has_program = false;
+        has_formula = false;
+        try {
+          if (ProgramArchive::get().load(id, program)) {
+            has_program = true;
+            std::string formula_str =
+                Comments::getCommentField(program, Comments::PREFIX_FORMULA);
+            has_formula = !formula_str.empty();
+            submitter = Comments::getSubmitter(program);
+            int64_t offset = ProgramUtil::getOffset(program);
+            ProgramUtil::removeOps(program, Operation::Type::NOP);
+
+            // update stats
+            shard->updateProgramStats(id, program, submitter, formula_str,
+                                      offset);
+            num_processed++;
+          }
+        } catch (const std::exception& exc) {
+          Log::get().error(
+              "Error parsing " + file_name + ": " + std::string(exc.what()),
+              false);
+        }
+        shard->updateSequenceStats(id, has_program, has_formula);
+        if (report && notify.isTargetReached()) {
+          notify.reset();
+          const size_t n = num_processed;
+          Log::get().info("Processed " + std::to_string(n) + " program" +
+                          (n == 1 ? "" : "s"));
+        }
       }
+      shards[k] = std::move(shard);
     }
-    stats->updateSequenceStats(s.id, has_program, has_formula);
-    if (notify.isTargetReached()) {
-      notify.reset();
-      Log::get().info("Processed " + std::to_string(num_processed) +
-                  " program" + (num_processed == 1 ? "" : "s"));
-    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(worker, false);
+  }
+  worker(true);
+  for (auto& t : threads) {
+    t.join();
+  }
+  stats.reset(new Stats());
+  for (auto& shard : shards) {
+    stats->merge(*shard);
+    shard.reset();
   }
 
   // write stats
@@ -365,8 +417,10 @@ void MineManager::generateStats(int64_t age_in_days) {
   buf.setf(std::ios::fixed);
   buf.precision(2);
   buf << duration;
-  Log::get().info("Generated stats for " + std::to_string(num_processed) +
-                  " programs in " + buf.str() + "s");
+  Log::get().info("Generated stats for " +
+                  std::to_string(num_processed.load()) + " programs in " +
+                  buf.str() + "s using " + std::to_string(num_threads) +
+                  " thread" + (num_threads == 1 ? "" : "s"));
 }
 
 void MineManager::cleanupListFiles() {
@@ -440,6 +494,12 @@ void MineManager::migrate() {
 
 const SequenceIndex& MineManager::getSequences() const { return sequences; }
 
+void MineManager::prefetchTerms(UID id) const {
+  if (sequences.exists(id)) {
+    BFileCache::get().prefetch(sequences.get(id));
+  }
+}
+
 const Stats& MineManager::getStats() {
   if (!stats) {
     // obtain lock
@@ -631,7 +691,7 @@ void MineManager::alert(Program p, UID id, const std::string& prefix,
   Log::get().alert(msg, details);
 }
 
-Program MineManager::getExistingProgram(UID id) {
+Program MineManager::getExistingProgram(UID id) const {
   const std::string global_file = ProgramUtil::getProgramPath(id, false);
   const std::string local_file = ProgramUtil::getProgramPath(id, true);
   const bool has_global = isFile(global_file);
@@ -640,6 +700,7 @@ Program MineManager::getExistingProgram(UID id) {
   if (has_global || has_local) {
     const std::string file_name = has_local ? local_file : global_file;
     try {
+      Parser parser;
       existing = parser.parse(file_name);
     } catch (const std::exception&) {
       Log::get().error("Error parsing " + file_name, false);
@@ -657,10 +718,25 @@ update_program_result_t MineManager::updateProgram(
   result.previous_hash = 0;
 
   // ignore this sequence?
-  if (id.number() == 0 || !sequences.exists(id) ||
-      ignore_list.find(id) != ignore_list.end()) {
+  if (ignore_list.find(id) != ignore_list.end()) {
     return result;
   }
+  validated_program_t validated;
+  if (!validateProgram(id, p, validation_mode, finder.getChecker(),
+                       validated)) {
+    return result;
+  }
+  return storeProgram(validated);
+}
+
+bool MineManager::validateProgram(UID id, Program p,
+                                  ValidationMode validation_mode,
+                                  Checker& checker,
+                                  validated_program_t& validated) const {
+  if (id.number() == 0 || !sequences.exists(id)) {
+    return false;
+  }
+  validated.program = p;
 
   // get metadata from comments
   const std::string submitter = Comments::getSubmitter(p);
@@ -684,7 +760,7 @@ update_program_result_t MineManager::updateProgram(
     optimizer.removeNops(existing);
     optimizer.removeNops(p);
     if (p == existing) {
-      return result;
+      return false;
     }
   }
 
@@ -694,27 +770,90 @@ update_program_result_t MineManager::updateProgram(
   auto num_usages = stats->getNumUsages(seq.id);
   switch (validation_mode) {
     case ValidationMode::BASIC:
-      checked = finder.getChecker().checkProgramBasic(
-          p, existing, is_new, seq, change_type, submitter, previous_hash,
-          full_check, num_usages);
+      checked = checker.checkProgramBasic(p, existing, is_new, seq,
+                                          change_type, submitter,
+                                          previous_hash, full_check,
+                                          num_usages);
       break;
     case ValidationMode::EXTENDED:
-      checked = finder.getChecker().checkProgramExtended(
-          p, existing, is_new, seq, full_check, num_usages);
+      checked = checker.checkProgramExtended(p, existing, is_new, seq,
+                                             full_check, num_usages);
       break;
   }
   // not better or the same after optimization?
   if (checked.status.empty() || (!is_new && checked.program == existing)) {
+    return false;
+  }
+  validated.id = id;
+  validated.is_new = is_new;
+  validated.existing = std::move(existing);
+  validated.submitter = submitter;
+  validated.checked = std::move(checked);
+  return true;
+}
+
+ValidatedQueue::ValidatedQueue() : num_taken(0) {}
+
+void ValidatedQueue::clear() {
+  queue.clear();
+  num_taken = 0;
+}
+
+void ValidatedQueue::push(int64_t index,
+                          std::vector<validated_program_t>&& validated) {
+  queue[index] = std::move(validated);
+}
+
+bool ValidatedQueue::hasNext() const {
+  return queue.find(num_taken) != queue.end();
+}
+
+bool ValidatedQueue::pop(std::vector<validated_program_t>& validated) {
+  auto it = queue.find(num_taken);
+  if (it == queue.end()) {
+    return false;
+  }
+  validated = std::move(it->second);
+  queue.erase(it);
+  num_taken++;
+  return true;
+}
+
+update_program_result_t MineManager::commitProgram(
+    const validated_program_t& validated, ValidationMode validation_mode) {
+  update_program_result_t result;
+  result.updated = false;
+  result.is_new = false;
+  result.previous_hash = 0;
+  if (ignore_list.find(validated.id) != ignore_list.end()) {
     return result;
   }
+  auto existing = getExistingProgram(validated.id);
+  optimizer.removeNops(existing);
+  if (existing != validated.existing) {
+    // the program was updated in the meantime
+    return updateProgram(validated.id, validated.program, validation_mode);
+  }
+  return storeProgram(validated);
+}
+
+update_program_result_t MineManager::storeProgram(
+    const validated_program_t& validated) {
+  const auto id = validated.id;
+  const auto& checked = validated.checked;
+  const bool is_new = validated.is_new;
+  auto& seq = sequences.get(id);
 
   // update result
+  update_program_result_t result;
   result.updated = true;
   result.is_new = is_new;
+  result.previous_hash = 0;
   result.program = checked.program;
   result.change_type = checked.status;
   if (!is_new) {
-    result.previous_hash = SequenceProgram::getTransitiveProgramHash(existing);
+    result.previous_hash =
+        SequenceProgram::getTransitiveProgramHash(validated.existing);
   }
 
   // write new or better program version
@@ -722,7 +861,9 @@ update_program_result_t MineManager::updateProgram(
   const std::string target_file = ProgramUtil::getProgramPath(id, !is_server);
   auto delta = updateProgramOffset(id, result.program);
   optimizer.optimize(result.program);
-  const auto formula = dumpProgram(id, result.program, target_file, submitter);
+  const auto formula =
+      dumpProgram(id, result.program, target_file, validated.submitter);
+  finder.getChecker().removeCachedReference(id);
   if (is_server) {
     updateAllDependentOffset(id, delta);
   }
@@ -739,13 +880,14 @@ update_program_result_t MineManager::updateProgram(
 
   // send alert
   const std::string color = is_new ? "good" : "warning";
-  alert(result.program, id, checked.status, color, formula, submitter);
+  alert(result.program, id, checked.status, color, formula,
+        validated.submitter);
 
   // log the change
   if (is_new) {
-    change_log.logAdded(id, checked.status, submitter);
+    change_log.logAdded(id, checked.status, validated.submitter);
   } else {
-    change_log.logUpdated(id, checked.status, submitter);
+    change_log.logUpdated(id, checked.status, validated.submitter);
   }
 
   return result;
@@ -852,12 +994,12 @@ std::vector<Program> MineManager::loadAllPrograms() {
   AdaptiveScheduler scheduler(20);
   int64_t loaded = 0;
   for (auto id : program_ids) {
-    std::ifstream in(ProgramUtil::getProgramPath(id));
-    if (!in) {
-      continue;
-    }
+    Program program;
     try {
-      programs.push_back(parser.parse(in));
+      if (!ProgramArchive::get().load(id, program)) {
+        continue;
+      }
+      programs.push_back(std::move(program));
       loaded++;
     } catch (const std::exception& e) {
       Log::get().warn("Skipping " + id.string() + ": " + e.what());
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <map>
+#include <vector>
+
 #include "eval/evaluator.hpp"
 #include "eval/minimizer.hpp"
 #include "eval/optimizer.hpp"
@@ -25,11 +28,51 @@ struct update_program_result_t {
   Program program;
 };
 
+// Program that passed the validation, but is not stored yet.
+struct validated_program_t {
+  UID id;
+  bool is_new;
+  Program program;   // submitted program including comments
+  Program existing;  // existing program at the time of the validation
+  std::string submitter;
+  check_result_t checked;
+};
+
+// Validated programs of numbered submissions. The submissions can be validated
+// in any order, but they are taken from the queue in the order of their
+// numbers, starting with zero. Not thread-safe.
+class ValidatedQueue {
+ public:
+  ValidatedQueue();
+
+  void clear();
+
+  void push(int64_t index, std::vector<validated_program_t>&& validated);
+
+  // Returns true if the next submission in order was validated.
+  bool hasNext() const;
+
+  // Take the validated programs of the next submission in order. Returns
+  // false if the next submission was not validated yet.
+  bool pop(std::vector<validated_program_t>& validated);
+
+  // Number of submissions taken from the queue.
+  int64_t getNumTaken() const { return num_taken; }
+
+  size_t size() const { return queue.size(); }
+
+ private:
+  std::map<int64_t, std::vector<validated_program_t>> queue;
+  int64_t num_taken;
+};
+
 class MineManager {
  public:
   explicit MineManager(const Settings& settings,
                        const std::string& stats_home = "");
 
+  ~MineManager();
+
   void load();
 
   void update(bool force);
@@ -38,17 +81,31 @@ class MineManager {
 
   const SequenceIndex& getSequences() const;
 
+  // Load the b-file of a sequence in the background.
+  void prefetchTerms(UID id) const;
+
   const Stats& getStats();
 
   Finder& getFinder();
 
   size_t getTotalCount() const { return loader.getNumTotal(); }
 
-  Program getExistingProgram(UID id);
+  Program getExistingProgram(UID id) const;
 
   update_program_result_t updateProgram(UID id, Program p,
                                         ValidationMode validation_mode);
 
+  // Minimize and check a program without changing the programs home. Can be
+  // called concurrently if every thread uses its own checker. Returns false
+  // if the program is not better than the existing one.
+  bool validateProgram(UID id, Program p, ValidationMode validation_mode,
+                       Checker& checker, validated_program_t& validated) const;
+
+  // Store a validated program. If the existing program was changed after the
+  // validation, the program is validated again.
+  update_program_result_t commitProgram(const validated_program_t& validated,
+                                        ValidationMode validation_mode);
+
   bool maintainProgram(UID id, bool eval = true);
 
   std::string dumpProgram(UID id, Program& p, const std::string& file,
@@ -73,6 +130,8 @@ class MineManager {
 
   void addSeqComments(Program& p) const;
 
+  update_program_result_t storeProgram(const validated_program_t& validated);
+
   int64_t updateProgramOffset(UID id, Program& p) const;
 
   void updateDependentOffset(UID id, UID used_id, int64_t delta);
@@ -8,6 +8,7 @@
 
 #include "eval/interpreter.hpp"
 #include "eval/optimizer.hpp"
+#include "eval/term_store.hpp"
 #include "gen/generator.hpp"
 #include "lang/comments.hpp"
 #include "lang/parser.hpp"
@@ -39,7 +40,13 @@ Miner::Miner(const Settings& settings, ProgressMonitor* progress_monitor)
       num_processed(0),
       num_removed(0),
       num_reported_hours(0),
-      current_fetch(0) {}
+      current_fetch(0),
+      stop_workers(false),
+      num_active_workers(0),
+      num_worker_processed(0),
+      num_seen_checks(0),
+      num_seen_hits(0),
+      num_fetched(0) {}
 
 void Miner::reload() {
   api_client.reset(new ApiClient());
@@ -51,6 +58,15 @@ void Miner::reload() {
   validation_mode = miner_config.validation_mode;
   if (mining_mode == MINING_MODE_SERVER || submit_mode) {
     multi_generator.reset();
+    worker_generators.clear();
+  } else if (settings.num_mine_threads > 1) {
+    // one generator per mining thread
+    worker_generators.resize(settings.num_mine_threads);
+    for (auto& generator : worker_generators) {
+      if (!generator || generator->supportsRestart()) {
+        generator.reset(new MultiGenerator(settings, manager->getStats()));
+      }
+    }
   } else {
     if (!multi_generator || multi_generator->supportsRestart()) {
       multi_generator.reset(new MultiGenerator(settings, manager->getStats()));
@@ -130,6 +146,30 @@ std::string convertValidationModeToStr(ValidationMode mode) {
   return "";
 }
 
+// Get the sequence ID stored in the comments of a submitted program. Returns
+// an ID with number 0 if there is no valid ID.
+UID getSubmittedSequenceId(const Program& program) {
+  auto id_str = Comments::getSequenceIdFromProgram(program);
+  if (id_str.empty()) {
+    return UID();
+  }
+  UID id;
+  bool ok = true;
+  try {
+    id = UID(id_str);
+  } catch (const std::exception&) {
+    ok = false;
+  }
+  if (id.domain() != 'A' || id.number() == 0) {
+    ok = false;
+  }
+  if (!ok) {
+    Log::get().warn("Invalid sequence ID: " + id_str);
+    return UID();
+  }
+  return id;
+}
+
 void Miner::runMineLoop() {
   Parser parser;
   std::stack<Program> progs;
@@ -139,6 +179,11 @@ void Miner::runMineLoop() {
   Program program;
   Matcher::seq_programs_t seq_programs;
   update_program_result_t update_result;
+  Optimizer optimizer(settings);
+  std::unique_ptr<SeenProgramFilter> seen_programs;
+  if (mining_mode != MINING_MODE_SERVER && settings.num_seen_programs > 0) {
+    seen_programs.reset(new SeenProgramFilter(settings.num_seen_programs));
+  }
 
   // check validate modes
   if (validation_mode == ValidationMode::BASIC &&
@@ -177,148 +222,117 @@ void Miner::runMineLoop() {
     Log::get().info(msg);
   }
 
-  std::string submitter;
-  std::string submitted_profile;
+  // share evaluated sequence terms with other miner processes
+  if (settings.use_term_store && !TermStore::get().isOpen()) {
+    TermStore::get().open(Setup::getCacheHome() + "terms");
+  }
+
   current_fetch = (mining_mode == MINING_MODE_SERVER) ? PROGRAMS_TO_FETCH : 0;
   num_processed = 0;
   num_removed = 0;
-  while (true) {
-    // if queue is empty: fetch or generate a new program
-    if (progs.empty()) {
-      // server mode: try to fetch a program
-      if (mining_mode == MINING_MODE_SERVER) {
-        if (current_fetch > 0) {
-          while (true) {
-            submission = api_client->getNextSubmission();
-            if (submission.mode == Submission::Mode::REMOVE) {
-              maintain_ids.push(submission.id);
-              continue;
-            }
-            program = submission.toProgram();
-            if (program.ops.empty()) {
-              current_fetch = 0;
+  if (settings.num_mine_threads > 1 && mining_mode == MINING_MODE_SERVER) {
+    runValidationPipeline();
+  } else if (settings.num_mine_threads > 1) {
+    // hand over the initial mutations to the worker threads
+    if (!base_program.ops.empty()) {
+      mutation_queue.push_back(base_program);
+    }
+    runParallelMineLoop();
+  } else {
+    while (true) {
+      // if queue is empty: fetch or generate a new program
+      if (progs.empty()) {
+        // server mode: try to fetch a program
+        if (mining_mode == MINING_MODE_SERVER) {
+          if (current_fetch > 0) {
+            while (true) {
+              submission = api_client->getNextSubmission();
+              if (submission.mode == Submission::Mode::REMOVE) {
+                maintain_ids.push(submission.id);
+                continue;
+              }
+              program = submission.toProgram();
+              if (program.ops.empty()) {
+                current_fetch = 0;
+                break;
+              }
+              current_fetch--;
+              // check metadata stored in program's comments
+              ensureSubmitter(program);
+              progs.push(program);
               break;
             }
-            current_fetch--;
-            // check metadata stored in program's comments
-            ensureSubmitter(program);
-            progs.push(program);
-            break;
-          }
-        }
-      } else {
-        // client mode
-        if (base_program.ops.empty()) {
-          // generate new program
-          program = multi_generator->generateProgram();
-          if (program.ops.empty() && multi_generator->isFinished()) {
-            break;
           }
-          progs.push(std::move(program));
         } else {
-          // mutate base program
-          mutator->mutateCopiesRandom(base_program, NUM_MUTATIONS, progs);
+          // client mode
+          if (base_program.ops.empty()) {
+            // generate new program
+            program = multi_generator->generateProgram();
+            if (program.ops.empty() && multi_generator->isFinished()) {
+              break;
+            }
+            progs.push(std::move(program));
+          } else {
+            // mutate base program
+            mutator->mutateCopiesRandom(base_program, NUM_MUTATIONS, progs);
+          }
         }
       }
-    }
 
-    if (!progs.empty()) {
-      // get the next program
-      program = progs.top();
-      progs.pop();
+      if (!progs.empty()) {
+        // get the next program
+        program = progs.top();
+        progs.pop();
 
-      // try to extract A-number from comment (server mode)
-      seq_programs.clear();
-      auto id_str = Comments::getSequenceIdFromProgram(program);
-      if (!id_str.empty()) {
-        UID id;
-        bool ok = true;
-        try {
-          id = UID(id_str);
-        } catch (const std::exception&) {
-          ok = false;
-        }
-        if (id.domain() != 'A' || id.number() == 0) {
-          ok = false;
-        }
-        if (ok) {
+        // try to extract A-number from comment (server mode)
+        seq_programs.clear();
+        auto id = getSubmittedSequenceId(program);
+        if (id.number() != 0) {
           seq_programs.push_back({id, program});
-        } else {
-          Log::get().warn("Invalid sequence ID: " + id_str);
         }
-      }
-
-      // otherwise match sequences
-      if (seq_programs.empty()) {
-        seq_programs = manager->getFinder().findSequence(
-            program, norm_seq, manager->getSequences());
-      }
 
-      // validate matched programs and update existing programs
-      for (auto s : seq_programs) {
-        if (!checkRegularTasks()) {
-          break;
+        // otherwise match sequences unless the program was seen before
+        if (seq_programs.empty() &&
+            !isSeenProgram(seen_programs.get(), optimizer, program)) {
+          seq_programs = manager->getFinder().findSequence(
+              program, norm_seq, manager->getSequences());
         }
-        program = s.second;
-        updateSubmitter(program);
-        update_result =
-            manager->updateProgram(s.first, program, validation_mode);
-        if (update_result.updated) {
-          // update metrics
-          submitter = Comments::getSubmitter(program);
-          if (submitter.empty()) {
-            submitter = "unknown";
-          }
-          if (update_result.is_new) {
-            num_new_per_user[submitter]++;
-          } else {
-            num_updated_per_user[submitter]++;
-          }
-          // in client mode: submit the program to the API server
-          if (mining_mode == MINING_MODE_CLIENT) {
-            if (s.first.domain() == 'A') {  // only A-numbers allowed
-              // add metadata as comments
-              program = update_result.program;
-              Comments::addComment(
-                  program, Comments::PREFIX_MINER_PROFILE + " " + profile_name);
-              Comments::addComment(program, Comments::PREFIX_CHANGE_TYPE + " " +
-                                                update_result.change_type);
-              if (!update_result.is_new) {
-                Comments::addComment(
-                    program, Comments::PREFIX_PREVIOUS_HASH + " " +
-                                 std::to_string(update_result.previous_hash));
-              }
-              api_client->postProgram(program, 10);  // magic number
-            } else {
-              Log::get().warn("Skipping program submission for " +
-                              s.first.string());
-            }
+        for (const auto& s : seq_programs) {
+          manager->prefetchTerms(s.first);
+        }
+
+        // validate matched programs and update existing programs
+        for (auto s : seq_programs) {
+          if (!checkRegularTasks()) {
+            break;
           }
+          update_result = processMatch(s.first, s.second);
           // mutate successful program
-          if (mining_mode != MINING_MODE_SERVER && progs.size() < MAX_BACKLOG) {
+          if (update_result.updated && mining_mode != MINING_MODE_SERVER &&
+              progs.size() < MAX_BACKLOG) {
             mutator->mutateCopiesConstants(update_result.program,
                                            NUM_MUTATIONS / 2, progs);
             mutator->mutateCopiesRandom(update_result.program,
                                         NUM_MUTATIONS / 2, progs);
           }
         }
+      } else {
+        // we are in server mode and have no programs to process
+        // => lets do maintenance work!
+        if (maintain_ids.empty()) {
+          maintain_ids.emplace(mutator->random_program_ids.getFromAll());
+        }
+        auto id = maintain_ids.top();
+        maintain_ids.pop();
+        if (!manager->maintainProgram(id)) {
+          num_removed++;
+        }
       }
-    } else {
-      // we are in server mode and have no programs to process
-      // => lets do maintenance work!
-      if (maintain_ids.empty()) {
-        maintain_ids.emplace(mutator->random_program_ids.getFromAll());
-      }
-      auto id = maintain_ids.top();
-      maintain_ids.pop();
-      if (!manager->maintainProgram(id)) {
-        num_removed++;
-      }
-    }
 
-    num_processed++;
-    if (!checkRegularTasks()) {
-      break;
+      num_processed++;
+      if (!checkRegularTasks()) {
+        break;
+      }
     }
   }
 
@@ -331,6 +345,379 @@ void Miner::runMineLoop() {
   }
 }
 
+update_program_result_t Miner::processMatch(UID id, Program program) {
+  updateSubmitter(program);
+  auto update_result = manager->updateProgram(id, program, validation_mode);
+  processUpdate(id, program, update_result);
+  return update_result;
+}
+
+void Miner::processUpdate(UID id, const Program& program,
+                          const update_program_result_t& update_result) {
+  if (update_result.updated) {
+    // update metrics
+    auto submitter = Comments::getSubmitter(program);
+    if (submitter.empty()) {
+      submitter = "unknown";
+    }
+    if (update_result.is_new) {
+      num_new_per_user[submitter]++;
+    } else {
+      num_updated_per_user[submitter]++;
+    }
+    // in client mode: submit the program to the API server
+    if (mining_mode == MINING_MODE_CLIENT) {
+      if (id.domain() == 'A') {  // only A-numbers allowed
+        // add metadata as comments
+        auto submitted = update_result.program;
+        Comments::addComment(
+            submitted, Comments::PREFIX_MINER_PROFILE + " " + profile_name);
+        Comments::addComment(submitted, Comments::PREFIX_CHANGE_TYPE + " " +
+                                            update_result.change_type);
+        if (!update_result.is_new) {
+          Comments::addComment(
+              submitted, Comments::PREFIX_PREVIOUS_HASH + " " +
+                             std::to_string(update_result.previous_hash));
+        }
+        api_client->postProgram(submitted, 10);  // magic number
+      } else {
+        Log::get().warn("Skipping program submission for " + id.string());
+      }
+    }
+  }
+}
+
+void Miner::runParallelMineLoop() {
+  Log::get().info("Starting " + std::to_string(settings.num_mine_threads) +
+                  " mining threads");
+  startWorkers();
+  try {
+    std::pair<UID, Program> match;
+    while (true) {
+      // wait for the next match found by the worker threads
+      bool has_match = false;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cond.wait_for(lock, std::chrono::milliseconds(100), [this] {
+          return !match_queue.empty() || num_active_workers == 0;
+        });
+        if (!match_queue.empty()) {
+          match = std::move(match_queue.front());
+          match_queue.pop_front();
+          has_match = true;
+        } else if (num_active_workers == 0) {
+          break;  // all generators finished
+        }
+      }
+      num_processed += num_worker_processed.exchange(0);
+
+      // validate and store the program; feed successful programs back to
+      // the worker threads for mutation
+      if (has_match) {
+        queue_cond.notify_all();
+        auto update_result = processMatch(match.first, match.second);
+        if (update_result.updated) {
+          std::lock_guard<std::mutex> lock(queue_mutex);
+          if (mutation_queue.size() < MAX_BACKLOG) {
+            mutation_queue.push_back(update_result.program);
+          }
+        }
+      }
+      if (!checkRegularTasks()) {
+        break;
+      }
+    }
+  } catch (...) {
+    stopWorkers();
+    throw;
+  }
+  stopWorkers();
+  num_processed += num_worker_processed.exchange(0);
+}
+
+void Miner::runValidationPipeline() {
+  Log::get().info("Starting " + std::to_string(settings.num_mine_threads) +
+                  " validation threads");
+  submission_queue.clear();
+  validated_queue.clear();
+  removal_queue.clear();
+  num_fetched = 0;
+  pipeline_error.clear();
+  startWorkers();
+  try {
+    std::vector<validated_program_t> validated;
+    while (true) {
+      // wait for the next submission in order
+      bool has_result = false;
+      bool is_idle = false;
+      UID maintain_id;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cond.wait_for(lock, std::chrono::milliseconds(100), [this] {
+          return validated_queue.hasNext() || !pipeline_error.empty();
+        });
+        if (!pipeline_error.empty()) {
+          throw std::runtime_error(pipeline_error);
+        }
+        if (validated_queue.pop(validated)) {
+          has_result = true;
+        } else if (validated_queue.getNumTaken() == num_fetched &&
+                   current_fetch <= 0) {
+          is_idle = true;
+          if (!removal_queue.empty()) {
+            maintain_id = removal_queue.front();
+            removal_queue.pop_front();
+          }
+        }
+      }
+
+      // store accepted programs
+      if (has_result) {
+        for (const auto& v : validated) {
+          if (!checkRegularTasks()) {
+            break;
+          }
+          auto update_result = manager->commitProgram(v, validation_mode);
+          processUpdate(v.id, v.program, update_result);
+        }
+        num_processed++;
+      } else if (is_idle) {
+        // no programs to process => lets do maintenance work!
+        if (maintain_id.number() == 0) {
+          maintain_id = mutator->random_program_ids.getFromAll();
+        }
+        if (!manager->maintainProgram(maintain_id)) {
+          num_removed++;
+        }
+        num_processed++;
+      }
+      if (!checkRegularTasks()) {
+        break;
+      }
+    }
+  } catch (...) {
+    stopWorkers();
+    throw;
+  }
+  stopWorkers();
+}
+
+void Miner::runPrefetcher() {
+  try {
+    while (!stop_workers && !Signals::HALT) {
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        auto can_fetch = [this] {
+          return current_fetch > 0 &&
+                 static_cast<int64_t>(submission_queue.size()) < MAX_BACKLOG;
+        };
+        queue_cond.wait_for(lock, std::chrono::milliseconds(100), [&] {
+          return can_fetch() || stop_workers;
+        });
+        if (stop_workers || !can_fetch()) {
+          continue;
+        }
+      }
+      auto submission = api_client->getNextSubmission();
+      if (submission.mode == Submission::Mode::REMOVE) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        removal_queue.push_back(submission.id);
+        continue;
+      }
+      auto program = submission.toProgram();
+      if (program.ops.empty()) {
+        current_fetch = 0;
+        queue_cond.notify_all();
+        continue;
+      }
+      current_fetch--;
+      // check metadata stored in program's comments
+      ensureSubmitter(program);
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        submission_queue.emplace_back(num_fetched++, std::move(program));
+      }
+      queue_cond.notify_all();
+    }
+  } catch (const std::exception& e) {
+    // report the error to the main thread
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (pipeline_error.empty()) {
+      pipeline_error = "Error in prefetching thread: " + std::string(e.what());
+    }
+  }
+  queue_cond.notify_all();
+}
+
+void Miner::runValidator() {
+  // thread-local evaluation state; the sequences and the matchers are shared
+  // with all other threads
+  Evaluator evaluator(settings, EVAL_ALL, true);
+  Minimizer minimizer(settings);
+  auto& finder = manager->getFinder();
+  Checker checker(settings, evaluator, minimizer, finder.getInvalidMatches());
+  const auto& sequences = manager->getSequences();
+  Sequence norm_seq;
+  Matcher::seq_programs_t seq_programs;
+  std::pair<int64_t, Program> submission;
+  try {
+    while (!Signals::HALT) {
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cond.wait(lock, [this] {
+          return !submission_queue.empty() || stop_workers;
+        });
+        if (stop_workers) {
+          break;
+        }
+        submission = std::move(submission_queue.front());
+        submission_queue.pop_front();
+      }
+      queue_cond.notify_all();
+
+      // use the A-number from the comment or match sequences
+      auto& program = submission.second;
+      seq_programs.clear();
+      auto id = getSubmittedSequenceId(program);
+      if (id.number() != 0) {
+        seq_programs.push_back({id, program});
+      } else {
+        seq_programs =
+            finder.findSequence(program, norm_seq, sequences, evaluator);
+      }
+      for (const auto& s : seq_programs) {
+        manager->prefetchTerms(s.first);
+      }
+      std::vector<validated_program_t> validated;
+      for (auto& s : seq_programs) {
+        if (Signals::HALT) {
+          break;
+        }
+        updateSubmitter(s.second);
+        validated_program_t v;
+        if (manager->validateProgram(s.first, s.second, validation_mode,
+                                     checker, v)) {
+          validated.emplace_back(std::move(v));
+        }
+      }
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        validated_queue.push(submission.first, std::move(validated));
+      }
+      queue_cond.notify_all();
+    }
+  } catch (const std::exception& e) {
+    // report the error to the main thread
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (pipeline_error.empty()) {
+      pipeline_error = "Error in validation thread: " + std::string(e.what());
+    }
+  }
+  queue_cond.notify_all();
+}
+
+void Miner::startWorkers() {
+  stop_workers = false;
+  if (mining_mode == MINING_MODE_SERVER) {
+    workers.emplace_back(&Miner::runPrefetcher, this);
+    for (int64_t i = 0; i < settings.num_mine_threads; i++) {
+      workers.emplace_back(&Miner::runValidator, this);
+    }
+    return;
+  }
+  num_active_workers = worker_generators.size();
+  const auto& stats = manager->getStats();
+  for (auto& generator : worker_generators) {
+    workers.emplace_back(&Miner::runWorker, this, generator.get(),
+                         std::cref(stats));
+  }
+}
+
+void Miner::stopWorkers() {
+  stop_workers = true;
+  queue_cond.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+void Miner::runWorker(MultiGenerator* generator, const Stats& stats) {
+  // thread-local mining state; the sequence index and the matchers are
+  // shared with all other threads
+  Evaluator evaluator(settings, EVAL_ALL, true);
+  Mutator mutator(stats);
+  auto& finder = manager->getFinder();
+  const auto& sequences = manager->getSequences();
+  Optimizer optimizer(settings);
+  std::unique_ptr<SeenProgramFilter> seen_programs;
+  if (settings.num_seen_programs > 0) {
+    seen_programs.reset(new SeenProgramFilter(settings.num_seen_programs));
+  }
+  std::stack<Program> progs;
+  Sequence norm_seq;
+  Program program;
+  try {
+    while (!stop_workers && !Signals::HALT) {
+      // mutate successful programs of the main thread
+      program.ops.clear();
+      if (progs.size() < MAX_BACKLOG) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (!mutation_queue.empty()) {
+          program = std::move(mutation_queue.front());
+          mutation_queue.pop_front();
+        }
+      }
+      if (!program.ops.empty()) {
+        mutator.mutateCopiesConstants(program, NUM_MUTATIONS / 2, progs);
+        mutator.mutateCopiesRandom(program, NUM_MUTATIONS / 2, progs);
+      }
+
+      // generate a new program or mutate the base program
+      if (progs.empty()) {
+        if (base_program.ops.empty()) {
+          program = generator->generateProgram();
+          if (program.ops.empty() && generator->isFinished()) {
+            break;
+          }
+          progs.push(std::move(program));
+        } else {
+          mutator.mutateCopiesRandom(base_program, NUM_MUTATIONS, progs);
+        }
+      }
+      program = std::move(progs.top());
+      progs.pop();
+
+      // match sequences and pass the results to the main thread
+      num_worker_processed++;
+      if (isSeenProgram(seen_programs.get(), optimizer, program)) {
+        continue;
+      }
+      auto seq_programs =
+          finder.findSequence(program, norm_seq, sequences, evaluator);
+      if (!seq_programs.empty()) {
+        for (const auto& s : seq_programs) {
+          manager->prefetchTerms(s.first);
+        }
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cond.wait(lock, [this] {
+          return match_queue.size() < MAX_BACKLOG || stop_workers;
+        });
+        for (auto& s : seq_programs) {
+          match_queue.emplace_back(std::move(s));
+        }
+        queue_cond.notify_all();
+      }
+    }
+  } catch (const std::exception& e) {
+    Log::get().error("Error in mining thread: " + std::string(e.what()),
+                     false);
+    Signals::HALT = true;
+  }
+  num_active_workers--;
+  queue_cond.notify_all();
+}
+
 bool Miner::checkRegularTasks() {
   if (Signals::HALT) {
     return false;  // stop immediately
@@ -367,6 +754,33 @@ bool Miner::checkRegularTasks() {
     labels.clear();
     labels["kind"] = "removed";
     entries.push_back({"programs", labels, static_cast<double>(num_removed)});
+    if (mining_mode == MINING_MODE_SERVER && !workers.empty()) {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      const int64_t fetched = submission_queue.size();
+      const int64_t validated = validated_queue.size();
+      const int64_t validating =
+          num_fetched - validated_queue.getNumTaken() - fetched - validated;
+      labels["kind"] = "fetched";
+      entries.push_back(
+          {"validation_queue", labels, static_cast<double>(fetched)});
+      labels["kind"] = "validating";
+      entries.push_back(
+          {"validation_queue", labels, static_cast<double>(validating)});
+      labels["kind"] = "validated";
+      entries.push_back(
+          {"validation_queue", labels, static_cast<double>(validated)});
+    }
+    auto& term_store = TermStore::get();
+    if (term_store.isOpen()) {
+      term_store.flush();
+      labels["kind"] = "hit";
+      entries.push_back(
+          {"seq_terms", labels, static_cast<double>(term_store.getNumHits())});
+      labels["kind"] = "miss";
+      entries.push_back({"seq_terms", labels,
+                         static_cast<double>(term_store.getNumMisses())});
+      term_store.resetCounters();
+    }
     Metrics::get().write(entries);
     num_new_per_user.clear();
     num_updated_per_user.clear();
@@ -382,12 +796,38 @@ bool Miner::checkRegularTasks() {
   // regular task: reload oeis manager and generators
   if (reload_scheduler.isTargetReached()) {
     reload_scheduler.reset();
+    const bool restart_workers = !workers.empty();
+    if (restart_workers) {
+      stopWorkers();
+    }
     reload();
+    if (restart_workers) {
+      startWorkers();
+    }
   }
 
   return result;
 }
 
+bool Miner::isSeenProgram(SeenProgramFilter* filter,
+                          const Optimizer& optimizer, Program program) {
+  if (!filter) {
+    return false;
+  }
+  // programs that are identical after optimization have the same terms
+  try {
+    optimizer.optimize(program);
+  } catch (const std::exception&) {
+    return false;
+  }
+  num_seen_checks++;
+  if (filter->checkAndInsert(program)) {
+    num_seen_hits++;
+    return true;
+  }
+  return false;
+}
+
 void Miner::logProgress(bool report_slow) {
   std::string progress;
   if (progress_monitor) {
@@ -404,6 +844,22 @@ void Miner::logProgress(bool report_slow) {
   } else if (report_slow) {
     Log::get().warn("Slow processing of programs" + progress);
   }
+  const int64_t seen_checks = num_seen_checks.exchange(0);
+  const int64_t seen_hits = num_seen_hits.exchange(0);
+  if (seen_checks > 0) {
+    std::stringstream buf;
+    buf.setf(std::ios::fixed);
+    buf.precision(1);
+    buf << "Seen-program filter skipped " << (100.0 * seen_hits / seen_checks)
+        << "% of programs";
+    Log::get().info(buf.str());
+  }
+  if (manager) {
+    auto summary = manager->getFinder().getPrefixFilterSummary();
+    if (!summary.empty()) {
+      Log::get().info(summary);
+    }
+  }
 }
 
 void Miner::reportCPUHour() {
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "eval/optimizer.hpp"
 #include "lang/program.hpp"
@@ -11,6 +16,7 @@
 #include "mine/matcher.hpp"
 #include "mine/mine_manager.hpp"
 #include "mine/mutator.hpp"
+#include "mine/seen_program_filter.hpp"
 #include "sys/setup.hpp"
 #include "sys/util.hpp"
 
@@ -43,6 +49,25 @@ class Miner {
  private:
   void runMineLoop();
 
+  void runParallelMineLoop();
+
+  void runWorker(MultiGenerator *generator, const Stats &stats);
+
+  void runValidationPipeline();
+
+  void runPrefetcher();
+
+  void runValidator();
+
+  void startWorkers();
+
+  void stopWorkers();
+
+  update_program_result_t processMatch(UID id, Program program);
+
+  void processUpdate(UID id, const Program &program,
+                     const update_program_result_t &update_result);
+
   bool checkRegularTasks();
 
   void reload();
@@ -51,6 +76,9 @@ class Miner {
 
   void updateSubmitter(Program &program);
 
+  bool isSeenProgram(SeenProgramFilter *filter, const Optimizer &optimizer,
+                     Program program);
+
   void logProgress(bool report_slow);
 
   void reportCPUHour();
@@ -68,6 +96,7 @@ class Miner {
   std::unique_ptr<MineManager> manager;
   std::unique_ptr<MultiGenerator> multi_generator;
   std::unique_ptr<Mutator> mutator;
+  std::vector<std::unique_ptr<MultiGenerator>> worker_generators;
   AdaptiveScheduler log_scheduler;
   AdaptiveScheduler metrics_scheduler;
   AdaptiveScheduler cpuhours_scheduler;
@@ -78,7 +107,29 @@ class Miner {
   int64_t num_processed;
   int64_t num_removed;
   int64_t num_reported_hours;
-  int64_t current_fetch;
+  std::atomic<int64_t> current_fetch;
   std::map<std::string, int64_t> num_new_per_user;
   std::map<std::string, int64_t> num_updated_per_user;
+
+  // Worker threads generate programs and match them against the shared
+  // sequence index. Matches are validated and stored by the main thread.
+  std::vector<std::thread> workers;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cond;
+  std::deque<std::pair<UID, Program>> match_queue;  // found by workers
+  std::deque<Program> mutation_queue;  // successful programs to be mutated
+  std::atomic<bool> stop_workers;
+  std::atomic<int64_t> num_active_workers;
+  std::atomic<int64_t> num_worker_processed;
+  std::atomic<int64_t> num_seen_checks;  // programs checked by seen filters
+  std::atomic<int64_t> num_seen_hits;    // skipped programs
+
+  // Server mode: a prefetcher thread fetches submissions, validation threads
+  // check them using their own evaluators and the main thread stores the
+  // accepted programs in the order of the submissions.
+  std::deque<std::pair<int64_t, Program>> submission_queue;  // fetched
+  ValidatedQueue validated_queue;  // validated, but not stored yet
+  std::deque<UID> removal_queue;   // removed programs to be checked
+  int64_t num_fetched;             // index of the next fetched submission
+  std::string pipeline_error;      // first error of a pipeline thread
 };
@@ -1,5 +1,7 @@
 #include "mine/reducer.hpp"
 
+#include <numeric>
+
 #include "math/semantics.hpp"
 #include "sys/util.hpp"
 
@@ -112,3 +114,247 @@ int64_t Reducer::digit(Sequence& seq, int64_t num_digits) {
   //          + std::to_string( index ) );
   return index.asInt();
 }
+
+// --- Compact Sequences ------------------------------------------------------
+
+// The int64 kernels below operate on contiguous arrays. Their main loops are
+// free of early exits and data-dependent branches, so that the compiler can
+// vectorize them. Overflows are accumulated in the sign bit of a flag and
+// checked after the loop.
+
+inline int countTrailingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  int result = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    result++;
+  }
+  return result;
+#endif
+}
+
+// Multiplicative inverse of an odd number modulo 2^64.
+inline uint64_t inverseOdd(uint64_t m) {
+  uint64_t x = m;  // correct for the lowest 3 bits
+  for (int i = 0; i < 5; i++) {
+    x *= 2 - m * x;  // doubles the number of correct bits
+  }
+  return x;
+}
+
+// Binary gcd of two odd numbers.
+inline uint64_t gcdOdd(uint64_t a, uint64_t b) {
+  while (a != b) {
+    if (a > b) {
+      a -= b;
+      a >>= countTrailingZeros(a);
+    } else {
+      b -= a;
+      b >>= countTrailingZeros(b);
+    }
+  }
+  return a;
+}
+
+// Minimum of the terms. Returns false if there is a negative term.
+inline bool minKernel(const int64_t* v, size_t n, int64_t& min) {
+  int64_t m = std::numeric_limits<int64_t>::max();
+  int64_t neg = 0;
+  for (size_t i = 0; i < n; i++) {
+    m = v[i] < m ? v[i] : m;
+    neg |= v[i];
+  }
+  min = m;
+  return neg >= 0;
+}
+
+inline void subKernel(int64_t* v, size_t n, int64_t d) {
+  for (size_t i = 0; i < n; i++) {
+    v[i] -= d;
+  }
+}
+
+// Greatest common divisor of the absolute values of the terms, or zero if
+// all terms are zero. Returns false if an absolute value overflows.
+inline bool gcdKernel(const int64_t* v, size_t n, uint64_t& g) {
+  const int64_t min = std::numeric_limits<int64_t>::min();
+  uint64_t bits = 0;
+  int64_t has_min = 0;
+  for (size_t i = 0; i < n; i++) {
+    bits |= static_cast<uint64_t>(v[i]);
+    has_min |= (v[i] == min);
+  }
+  g = 0;
+  if (has_min) {
+    return false;
+  }
+  if (bits == 0) {
+    return true;
+  }
+  // the common power of two is the lowest bit set in any term, so only the
+  // odd parts need to be reduced
+  const int shift = countTrailingZeros(bits);
+  uint64_t odd = 0;
+  for (size_t i = 0; i < n && odd != 1; i++) {
+    uint64_t a = static_cast<uint64_t>(v[i] < 0 ? -v[i] : v[i]);
+    if (a == 0) {
+      continue;
+    }
+    a >>= countTrailingZeros(a);
+    odd = (odd == 0) ? a : gcdOdd(odd, a);
+  }
+  g = odd << shift;
+  return true;
+}
+
+// Exact division of all terms by 2^shift*odd using an arithmetic shift and a
+// multiplication with the inverse of the odd factor instead of a division.
+inline void divKernel(int64_t* v, size_t n, int shift, uint64_t odd) {
+  const uint64_t inv = inverseOdd(odd);
+  for (size_t i = 0; i < n; i++) {
+    v[i] = static_cast<int64_t>(static_cast<uint64_t>(v[i] >> shift) * inv);
+  }
+}
+
+// First differences of the terms with the first term unchanged. Returns the
+// sign-bit flags of any negative difference, any overflow and any non-zero
+// subtrahend.
+inline void deltaKernel(const int64_t* v, int64_t* d, size_t n, int64_t& neg,
+                        int64_t& overflow, int64_t& nonzero) {
+  neg = 0;
+  overflow = 0;
+  nonzero = 0;
+  if (n == 0) {
+    return;
+  }
+  d[0] = v[0];
+  neg = v[0];
+  for (size_t i = 1; i < n; i++) {
+    const int64_t a = v[i], b = v[i - 1];
+    const int64_t r = static_cast<int64_t>(static_cast<uint64_t>(a) -
+                                           static_cast<uint64_t>(b));
+    d[i] = r;
+    neg |= r;
+    overflow |= (a ^ b) & (a ^ r);
+    nonzero |= b;
+  }
+}
+
+// Apply a Number-based reduction to a compact sequence.
+template <class F>
+auto reduceNumbers(CompactSequence& seq, F reduce) {
+  thread_local Sequence tmp;
+  seq.toSequence(tmp);
+  auto result = reduce(tmp);
+  seq.assign(tmp);
+  return result;
+}
+
+Number Reducer::truncate(CompactSequence& seq) {
+  if (!seq.isSmall()) {
+    return reduceNumbers(seq, [](Sequence& s) { return truncate(s); });
+  }
+  const size_t n = seq.size();
+  if (n == 0) {
+    return Number::ZERO;
+  }
+  int64_t min;
+  if (!minKernel(seq.data(), n, min)) {
+    return Number::ZERO;
+  }
+  if (min > 0) {
+    subKernel(seq.data(), n, min);
+  }
+  return Number(min);
+}
+
+Number Reducer::shrink(CompactSequence& seq) {
+  uint64_t factor;
+  if (!seq.isSmall() || !gcdKernel(seq.data(), seq.size(), factor)) {
+    return reduceNumbers(seq, [](Sequence& s) { return shrink(s); });
+  }
+  if (factor == 0) {
+    factor = 1;
+  }
+  if (factor != 1) {
+    const int shift = countTrailingZeros(factor);
+    divKernel(seq.data(), seq.size(), shift, factor >> shift);
+  }
+  return Number(static_cast<int64_t>(factor));
+}
+
+delta_t Reducer::delta(CompactSequence& seq, int64_t max_delta) {
+  if (!seq.isSmall()) {
+    return reduceNumbers(seq,
+                         [&](Sequence& s) { return delta(s, max_delta); });
+  }
+  delta_t result;
+  result.delta = 0;
+  const size_t size = seq.size();
+  thread_local std::vector<int64_t> cur, next;
+  cur.assign(seq.data(), seq.data() + size);
+  next.resize(size);
+  int64_t neg, overflow, nonzero;
+  for (int64_t i = 0; i < max_delta; i++) {
+    deltaKernel(cur.data(), next.data(), size, neg, overflow, nonzero);
+    if (overflow < 0) {
+      return reduceNumbers(seq,
+                           [&](Sequence& s) { return delta(s, max_delta); });
+    }
+    if (neg < 0 || nonzero == 0) {
+      break;  // negative difference or same sequence
+    }
+    cur.swap(next);
+    result.delta++;
+  }
+  std::copy(cur.begin(), cur.end(), seq.data());
+  result.offset = truncate(seq);
+  result.factor = shrink(seq);
+  return result;
+}
+
+int64_t Reducer::digit(CompactSequence& seq, int64_t num_digits) {
+  if (!seq.isSmall()) {
+    return reduceNumbers(seq,
+                         [&](Sequence& s) { return digit(s, num_digits); });
+  }
+  const size_t size = seq.size();
+  int64_t* v = seq.data();
+  // for powers of two, the non-negative remainder is a bit mask
+  const bool pow2 = (num_digits & (num_digits - 1)) == 0;
+  const int64_t mask = num_digits - 1;
+  thread_local std::vector<size_t> count;
+  count.assign(num_digits, 0);
+  if (pow2) {
+    for (size_t i = 0; i < size; i++) {
+      count[v[i] & mask]++;
+    }
+  } else {
+    for (size_t i = 0; i < size; i++) {
+      count[((v[i] % num_digits) + num_digits) % num_digits]++;
+    }
+  }
+  int64_t index = 0;
+  size_t max = 0;
+  for (int64_t i = 0; i < num_digits; i++) {
+    if (count[i] > max) {
+      index = i;
+      max = count[i];
+    }
+  }
+  // same as ((v-index)%d+d)%d without overflow
+  if (pow2) {
+    for (size_t i = 0; i < size; i++) {
+      v[i] = static_cast<int64_t>((static_cast<uint64_t>(v[i]) - index) &
+                                  static_cast<uint64_t>(mask));
+    }
+  } else {
+    for (size_t i = 0; i < size; i++) {
+      v[i] = (((v[i] % num_digits) - index) % num_digits + num_digits) %
+             num_digits;
+    }
+  }
+  return index;
+}
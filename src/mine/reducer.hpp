@@ -1,5 +1,6 @@
 #pragma once
 
+#include "math/compact_sequence.hpp"
 #include "math/sequence.hpp"
 
 struct delta_t {
@@ -17,4 +18,16 @@ class Reducer {
   static delta_t delta(Sequence &seq, int64_t max_delta);
 
   static int64_t digit(Sequence &seq, int64_t num_digits);
+
+  // Reductions of compact sequences. If all terms fit into int64, they are
+  // reduced using int64 arithmetic. Otherwise, or if an intermediate result
+  // overflows, the Number-based reductions are used.
+
+  static Number truncate(CompactSequence &seq);
+
+  static Number shrink(CompactSequence &seq);
+
+  static delta_t delta(CompactSequence &seq, int64_t max_delta);
+
+  static int64_t digit(CompactSequence &seq, int64_t num_digits);
 };
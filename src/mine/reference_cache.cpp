@@ -0,0 +1,80 @@
+#include "mine/reference_cache.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include "sys/file.hpp"
+#include "sys/log.hpp"
+#include "sys/setup.hpp"
+#include "sys/util.hpp"
+
+ReferenceCache::ReferenceCache()
+    : ReferenceCache(Setup::getCacheHome() + "references") {}
+
+ReferenceCache::ReferenceCache(const std::string& folder) : folder(folder) {
+  ensureTrailingFileSep(this->folder);
+  ensureDir(this->folder);
+}
+
+std::string ReferenceCache::getPath(UID id) const {
+  return folder + id.string() + ".txt";
+}
+
+bool ReferenceCache::lookup(UID id, size_t key, Sequence& seq,
+                            steps_t& steps) const {
+  std::ifstream in(getPath(id));
+  size_t stored_key;
+  if (!(in >> stored_key) || stored_key != key) {
+    return false;
+  }
+  steps_t s;
+  Sequence terms;
+  std::string line, term;
+  if (!(in >> s.total >> s.min >> s.max >> s.runs) ||
+      !std::getline(in >> std::ws, line)) {
+    return false;
+  }
+  std::stringstream buf(line);
+  try {
+    while (std::getline(buf, term, ',')) {
+      terms.push_back(Number(term));
+    }
+  } catch (const std::exception&) {
+    Log::get().warn("Ignoring invalid reference cache entry for " +
+                    id.string());
+    return false;
+  }
+  seq = terms;
+  steps = s;
+  return true;
+}
+
+void ReferenceCache::insert(UID id, size_t key, const Sequence& seq,
+                            const steps_t& steps) {
+  // write to a temporary file to avoid partial entries
+  const auto path = getPath(id);
+  const auto tmp = path + ".tmp" + std::to_string(Random::get().gen());
+  {
+    std::ofstream out(tmp);
+    out << key << "\n"
+        << steps.total << " " << steps.min << " " << steps.max << " "
+        << steps.runs << "\n"
+        << seq << "\n";
+    if (!out) {
+      Log::get().warn("Cannot write reference cache entry " + tmp);
+      out.close();
+      std::remove(tmp.c_str());
+      return;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::remove(tmp.c_str());
+  }
+}
+
+void ReferenceCache::remove(UID id) {
+  std::error_code ec;
+  std::filesystem::remove(getPath(id), ec);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include "base/uid.hpp"
+#include "eval/evaluator.hpp"
+#include "math/sequence.hpp"
+
+// Persistent cache of the evaluation results of existing programs that are
+// used as references when comparing them with optimized programs. There is
+// one entry per sequence, which is identified by a key derived from the hash
+// of the existing program and the evaluation parameters. An entry with a
+// different key is outdated and gets replaced.
+class ReferenceCache {
+ public:
+  ReferenceCache();
+
+  explicit ReferenceCache(const std::string &folder);
+
+  bool lookup(UID id, size_t key, Sequence &seq, steps_t &steps) const;
+
+  void insert(UID id, size_t key, const Sequence &seq, const steps_t &steps);
+
+  void remove(UID id);
+
+ private:
+  std::string getPath(UID id) const;
+
+  std::string folder;
+};
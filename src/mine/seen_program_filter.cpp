@@ -0,0 +1,81 @@
+#include "mine/seen_program_filter.hpp"
+
+#include <algorithm>
+
+// About 16 bits per key and 8 probes yield a false positive rate of less
+// than 0.1% for a full generation.
+inline size_t getNumBitsLog2(size_t capacity) {
+  size_t result = 6;
+  while (result < 40 && (static_cast<size_t>(1) << result) < 16 * capacity) {
+    result++;
+  }
+  return result;
+}
+
+SeenProgramFilter::SeenProgramFilter(size_t capacity)
+    : capacity(std::max<size_t>(capacity, 1)),
+      current(0),
+      num_current(0) {
+  generations.reserve(2);
+  for (size_t i = 0; i < 2; i++) {
+    generations.emplace_back(getNumBitsLog2(capacity), 8);
+  }
+}
+
+bool SeenProgramFilter::checkAndInsert(const Program &p) {
+  const auto key = getKey(p);
+  if (generations[0].mayContain(key) || generations[1].mayContain(key)) {
+    return true;
+  }
+  if (num_current >= capacity) {
+    // aging: forget the programs of the previous generation
+    current = 1 - current;
+    generations[current].clear();
+    num_current = 0;
+  }
+  generations[current].insert(key);
+  num_current++;
+  return false;
+}
+
+void SeenProgramFilter::clear() {
+  for (auto &g : generations) {
+    g.clear();
+  }
+  num_current = 0;
+}
+
+inline uint64_t mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline uint64_t getOperandKey(const Operand &op) {
+  const uint64_t v = op.value.fitsInInt64()
+                         ? static_cast<uint64_t>(op.value.asInt())
+                         : static_cast<uint64_t>(op.value.hash());
+  return mix(v + static_cast<uint64_t>(op.type));
+}
+
+uint64_t SeenProgramFilter::getKey(const Program &p) {
+  uint64_t h = 0;
+  for (const auto &op : p.ops) {
+    if (op.type == Operation::Type::NOP) {
+      continue;
+    }
+    const auto &meta = Operation::Metadata::get(op.type);
+    uint64_t k = static_cast<uint64_t>(op.type);
+    if (meta.num_operands > 0) {
+      k = mix(k ^ getOperandKey(op.target));
+    }
+    if (meta.num_operands > 1) {
+      k = mix(k + getOperandKey(op.source));
+    }
+    h = mix(h ^ k) + 1;
+  }
+  return h;
+}
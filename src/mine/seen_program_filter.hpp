@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include "lang/program.hpp"
+#include "mine/bloom_filter.hpp"
+
+// Probabilistic set of recently seen programs. It is used to skip the
+// evaluation of generated or mutated programs which are identical to a
+// program seen before. The keys are stored in two generations of Bloom
+// filters. If the current generation is full, the previous generation is
+// dropped, so that the filter forgets old programs and its memory usage is
+// bounded. Lookups can return false positives, i.e., a small fraction of new
+// programs is skipped.
+class SeenProgramFilter {
+ public:
+  // Create a filter that remembers at least the given number of programs.
+  explicit SeenProgramFilter(size_t capacity);
+
+  // Returns true if the program was seen before. Otherwise the program is
+  // inserted and false is returned. The program should be normalized.
+  bool checkAndInsert(const Program &p);
+
+  void clear();
+
+  // Well-distributed hash value of a program ignoring nops and comments.
+  static uint64_t getKey(const Program &p);
+
+ private:
+  const size_t capacity;
+  std::vector<BloomFilter> generations;
+  size_t current;      // index of the current generation
+  size_t num_current;  // number of keys in the current generation
+};
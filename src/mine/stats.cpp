@@ -514,6 +514,83 @@ void Stats::updateSequenceStats(UID id, bool program_found,
   }
 }
 
+void Stats::merge(Stats& other) {
+  num_programs += other.num_programs;
+  num_sequences += other.num_sequences;
+  num_formulas += other.num_formulas;
+  for (const auto& e : other.num_constants) {
+    num_constants[e.first] += e.second;
+  }
+  for (const auto& e : other.num_operations) {
+    num_operations[e.first] += e.second;
+  }
+  for (const auto& e : other.num_operation_positions) {
+    num_operation_positions[e.first] += e.second;
+  }
+  // assign submitter ref ids in the order of first occurrence
+  std::vector<const std::string*> submitters(
+      other.num_programs_per_submitter.size(), nullptr);
+  for (const auto& e : other.submitter_ref_ids) {
+    submitters[e.second] = &e.first;
+  }
+  std::vector<int64_t> ref_ids(submitters.size(), 0);
+  for (size_t i = 0; i < submitters.size(); i++) {
+    if (!submitters[i]) {
+      continue;
+    }
+    auto it = submitter_ref_ids.find(*submitters[i]);
+    int64_t ref_id;
+    if (it != submitter_ref_ids.end()) {
+      ref_id = it->second;
+    } else {
+      ref_id = submitter_ref_ids.size() + 1;
+      submitter_ref_ids[*submitters[i]] = ref_id;
+      if (ref_id >= static_cast<int64_t>(num_programs_per_submitter.size())) {
+        num_programs_per_submitter.resize(ref_id + 1, 0);
+      }
+    }
+    num_programs_per_submitter[ref_id] += other.num_programs_per_submitter[i];
+    ref_ids[i] = ref_id;
+  }
+  for (const auto& e : other.program_submitter) {
+    program_submitter[e.first] = ref_ids.at(e.second);
+  }
+  call_graph.insert(other.call_graph.begin(), other.call_graph.end());
+  if (other.num_programs_per_length.size() > num_programs_per_length.size()) {
+    num_programs_per_length.resize(other.num_programs_per_length.size(), 0);
+  }
+  for (size_t i = 0; i < other.num_programs_per_length.size(); i++) {
+    num_programs_per_length[i] += other.num_programs_per_length[i];
+  }
+  for (size_t i = 0; i < other.num_ops_per_type.size(); i++) {
+    num_ops_per_type[i] += other.num_ops_per_type[i];
+  }
+  program_lengths.insert(other.program_lengths.begin(),
+                         other.program_lengths.end());
+  for (const auto& e : other.program_usages) {
+    program_usages[e.first] += e.second;
+  }
+  program_operation_types_bitmask.insert(
+      other.program_operation_types_bitmask.begin(),
+      other.program_operation_types_bitmask.end());
+  const std::vector<std::pair<UIDSet*, const UIDSet*>> sets = {
+      {&all_program_ids, &other.all_program_ids},
+      {&supports_inceval, &other.supports_inceval},
+      {&supports_logeval, &other.supports_logeval},
+      {&supports_vireval, &other.supports_vireval},
+      {&has_loop, &other.has_loop},
+      {&has_formula, &other.has_formula},
+      {&has_pari, &other.has_pari},
+      {&has_lean, &other.has_lean},
+      {&has_indirect, &other.has_indirect}};
+  for (const auto& s : sets) {
+    for (auto id : *s.second) {
+      s.first->insert(id);
+    }
+  }
+  blocks_collector.merge(other.blocks_collector);
+}
+
 void Stats::finalize() {
   if (!blocks_collector.empty()) {
     if (!blocks.list.ops.empty()) {
@@ -48,6 +48,10 @@ class Stats {
 
   void updateSequenceStats(UID id, bool program_found, bool formula_found);
 
+  // Merge stats of programs that were processed after the programs of this
+  // object. The program IDs of both objects must be disjoint.
+  void merge(Stats &other);
+
   void finalize();
 
   int64_t getTransitiveLength(UID id) const;
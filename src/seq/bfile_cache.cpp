@@ -0,0 +1,186 @@
+#include "seq/bfile_cache.hpp"
+
+#include "sys/log.hpp"
+
+BFileCache& BFileCache::get() {
+  static BFileCache cache;
+  return cache;
+}
+
+BFileCache::BFileCache()
+    : max_terms(DEFAULT_MAX_TERMS),
+      num_terms(0),
+      num_hits(0),
+      num_misses(0),
+      generation(0),
+      stop(false) {}
+
+BFileCache::~BFileCache() {
+  // joining the thread is not safe during static destruction
+  if (worker.joinable()) {
+    worker.detach();
+  }
+}
+
+void BFileCache::stopPrefetch() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  queued.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  queue.clear();
+  queued_ids.clear();
+  stop = false;
+}
+
+BFileCache::terms_ptr BFileCache::getTerms(const ManagedSequence& seq) {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    auto it = entries.find(seq.id);
+    if (it != entries.end()) {
+      lru.splice(lru.begin(), lru, it->second.lru_pos);
+      num_hits++;
+      return it->second.terms;
+    }
+    if (loading.find(seq.id) == loading.end()) {
+      break;
+    }
+    // wait for the b-file loaded by another thread
+    loaded.wait(lock);
+  }
+  num_misses++;
+  loading.insert(seq.id);
+  const size_t load_generation = generation;
+  lock.unlock();
+  terms_ptr terms;
+  try {
+    terms = std::make_shared<const Sequence>(seq.loadFullTerms());
+  } catch (...) {
+    lock.lock();
+    loading.erase(seq.id);
+    lock.unlock();
+    loaded.notify_all();
+    throw;
+  }
+  lock.lock();
+  loading.erase(seq.id);
+  if (generation == load_generation) {
+    insert(seq.id, terms);
+  }
+  lock.unlock();
+  loaded.notify_all();
+  return terms;
+}
+
+void BFileCache::prefetch(const ManagedSequence& seq) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (entries.find(seq.id) != entries.end() ||
+      loading.find(seq.id) != loading.end() ||
+      queued_ids.find(seq.id) != queued_ids.end() ||
+      queue.size() >= MAX_PREFETCH_QUEUE) {
+    return;
+  }
+  queue.push_back(seq);
+  queued_ids.insert(seq.id);
+  if (!worker.joinable()) {
+    worker = std::thread(&BFileCache::runPrefetch, this);
+  }
+  queued.notify_one();
+}
+
+void BFileCache::runPrefetch() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    queued.wait(lock, [this] { return stop || !queue.empty(); });
+    if (stop) {
+      break;
+    }
+    auto seq = queue.front();
+    queue.pop_front();
+    queued_ids.erase(seq.id);
+    lock.unlock();
+    try {
+      getTerms(seq);
+    } catch (const std::exception& e) {
+      Log::get().warn("Error prefetching b-file of " + seq.id.string() + ": " +
+                      e.what());
+    }
+    lock.lock();
+  }
+}
+
+void BFileCache::insert(UID id, terms_ptr terms) {
+  auto it = entries.find(id);
+  if (it != entries.end()) {
+    num_terms -= it->second.terms->size();
+    it->second.terms = terms;
+    lru.splice(lru.begin(), lru, it->second.lru_pos);
+  } else {
+    lru.push_front(id);
+    entries[id] = {terms, lru.begin()};
+  }
+  num_terms += terms->size();
+  evict();
+}
+
+void BFileCache::evict() {
+  // always keep the most recently used sequence
+  while (num_terms > max_terms && lru.size() > 1) {
+    auto it = entries.find(lru.back());
+    num_terms -= it->second.terms->size();
+    entries.erase(it);
+    lru.pop_back();
+  }
+}
+
+void BFileCache::invalidate(UID id) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = entries.find(id);
+  if (it != entries.end()) {
+    num_terms -= it->second.terms->size();
+    lru.erase(it->second.lru_pos);
+    entries.erase(it);
+  }
+}
+
+void BFileCache::setMaxTerms(size_t max_num_terms) {
+  std::lock_guard<std::mutex> lock(mutex);
+  max_terms = max_num_terms;
+  evict();
+}
+
+void BFileCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  lru.clear();
+  queue.clear();
+  queued_ids.clear();
+  num_terms = 0;
+  generation++;
+  num_hits = 0;
+  num_misses = 0;
+}
+
+size_t BFileCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return entries.size();
+}
+
+size_t BFileCache::numTerms() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return num_terms;
+}
+
+size_t BFileCache::numHits() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return num_hits;
+}
+
+size_t BFileCache::numMisses() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return num_misses;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "base/uid.hpp"
+#include "math/sequence.hpp"
+#include "seq/managed_seq.hpp"
+
+// Global cache of the full terms of sequences loaded from b-files. The cache
+// is bounded by the total number of cached terms and evicts the least recently
+// used sequences. B-files of sequences can be prefetched by a background
+// thread, e.g. after a matcher hit and before the terms are needed by the
+// checker. Concurrent requests for the same sequence load its b-file once.
+// The prefetch thread must be stopped using stopPrefetch() before the program
+// exits, because it uses other global objects.
+class BFileCache {
+ public:
+  using terms_ptr = std::shared_ptr<const Sequence>;
+
+  static constexpr size_t DEFAULT_MAX_TERMS = 4000000;
+
+  static BFileCache &get();
+
+  // Get the full terms of a sequence. Loads the b-file if not cached.
+  terms_ptr getTerms(const ManagedSequence &seq);
+
+  // Schedule loading the b-file of a sequence in the background.
+  void prefetch(const ManagedSequence &seq);
+
+  // Stop the prefetch thread and discard scheduled b-files. The thread is
+  // restarted by the next call of prefetch().
+  void stopPrefetch();
+
+  // Remove the cached terms of a sequence, e.g. if its b-file was removed.
+  void invalidate(UID id);
+
+  void setMaxTerms(size_t max_terms);
+
+  // Remove all cached terms, e.g. if the sequence data is reloaded.
+  void clear();
+
+  size_t size() const;
+
+  size_t numTerms() const;
+
+  size_t numHits() const;
+
+  size_t numMisses() const;
+
+  ~BFileCache();
+
+ private:
+  static constexpr size_t MAX_PREFETCH_QUEUE = 100;
+
+  class Entry {
+   public:
+    terms_ptr terms;
+    std::list<UID>::iterator lru_pos;
+  };
+
+  BFileCache();
+
+  void insert(UID id, terms_ptr terms);
+
+  void evict();
+
+  void runPrefetch();
+
+  mutable std::mutex mutex;
+  std::condition_variable loaded;
+  std::condition_variable queued;
+  std::unordered_map<UID, Entry> entries;
+  std::list<UID> lru;  // most recently used first
+  std::unordered_set<UID> loading;
+  std::deque<ManagedSequence> queue;
+  std::unordered_set<UID> queued_ids;
+  std::thread worker;
+  size_t max_terms;
+  size_t num_terms;
+  size_t num_hits;
+  size_t num_misses;
+  size_t generation;  // incremented on clear to discard pending loads
+  bool stop;
+};
@@ -1,5 +1,6 @@
 #include "seq/managed_seq.hpp"
 
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
@@ -8,6 +9,7 @@
 #include "lang/program_util.hpp"
 #include "math/big_number.hpp"
 #include "mine/api_client.hpp"
+#include "seq/bfile_cache.hpp"
 #include "seq/seq_util.hpp"
 #include "sys/file.hpp"
 #include "sys/log.hpp"
@@ -16,11 +18,46 @@
 #include "sys/web_client.hpp"
 
 ManagedSequence::ManagedSequence(UID id)
-    : id(id), offset(0), num_bfile_terms(0) {}
+    : id(id),
+      offset(0),
+      packed_terms(nullptr),
+      num_packed_terms(0) {}
 
 ManagedSequence::ManagedSequence(UID id, const std::string& name,
                                  const Sequence& full)
-    : id(id), name(name), offset(0), terms(full), num_bfile_terms(0) {}
+    : id(id),
+      name(name),
+      offset(0),
+      terms(full),
+      packed_terms(nullptr),
+      num_packed_terms(0) {}
+
+void ManagedSequence::attachPackedTerms(std::shared_ptr<const MappedFile> file,
+                                        const char* data, size_t num_terms) {
+  packed_file = file;
+  packed_terms = data;
+  num_packed_terms = num_terms;
+  terms = CompactSequence();
+}
+
+const char* ManagedSequence::decodePackedTerms(const char* data,
+                                               size_t num_terms,
+                                               Sequence& seq) {
+  int64_t value, length;
+  for (size_t i = 0; i < num_terms; i++) {
+    std::memcpy(&value, data, sizeof(int64_t));
+    data += sizeof(int64_t);
+    if (value == PACKED_BIG_TERM) {
+      std::memcpy(&length, data, sizeof(int64_t));
+      data += sizeof(int64_t);
+      seq.push_back(Number(std::string(data, length)));
+      data += length;
+    } else {
+      seq.push_back(Number(value));
+    }
+  }
+  return data;
+}
 
 std::ostream& operator<<(std::ostream& out, const ManagedSequence& s) {
   out << s.id.string() << ": " << s.name;
@@ -46,32 +83,70 @@ void ManagedSequence::removeInvalidBFile(const std::string& error) const {
     if (isFile(path)) {
       Log::get().warn("Removing " + error + " b-file " + path);
       std::remove(path.c_str());
+      BFileCache::get().invalidate(id);
       // report broken b-file to API server
       ApiClient::getDefaultInstance().reportBrokenBFile(id);
     }
   }
 }
 
-Sequence ManagedSequence::loadBFile() const {
+// Parse a signed integer of a b-file line. Returns a pointer to the first
+// character after the integer or nullptr if there is no valid integer.
+inline const char* parseBFileInt(const char* pos, const char* end,
+                                 std::string& digits) {
+  const char* start = pos;
+  if (pos != end && *pos == '-') {
+    pos++;
+  }
+  const char* first = pos;
+  while (pos != end && *pos >= '0' && *pos <= '9') {
+    pos++;
+  }
+  // same rules as Number::readIntString(): no leading zeros and no "-0"
+  if (pos == first || (*first == '0' && pos - first > 1) ||
+      (*first == '0' && first != start)) {
+    return nullptr;
+  }
+  digits.assign(start, pos - start);
+  return pos;
+}
+
+inline const char* skipBFileSpaces(const char* pos, const char* end) {
+  while (pos != end && std::isspace(static_cast<unsigned char>(*pos))) {
+    pos++;
+  }
+  return pos;
+}
+
+Sequence ManagedSequence::loadBFile(const Sequence& base) const {
   Sequence result;
 
   // try to read b-file
   try {
-    std::ifstream big_file(getBFilePath());
-    std::string buf;
+    std::ifstream big_file(getBFilePath(), std::ios::binary);
     if (big_file.good()) {
-      std::string l;
+      const std::string content((std::istreambuf_iterator<char>(big_file)),
+                                std::istreambuf_iterator<char>());
+      const char* pos = content.data();
+      const char* const end = pos + content.size();
+      std::string digits;
       int64_t expected_index = -1, index = 0;
-      while (std::getline(big_file, l)) {
-        l.erase(l.begin(), std::find_if(l.begin(), l.end(), [](int ch) {
-                  return !std::isspace(ch);
-                }));
-        if (l.empty() || l[0] == '#') {
+      while (pos != end) {
+        const char* eol =
+            static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+        if (!eol) {
+          eol = end;
+        }
+        const char* p = skipBFileSpaces(pos, eol);
+        pos = (eol == end) ? end : eol + 1;
+        if (p == eol || *p == '#') {
           continue;
         }
-        // TODO: avoid extra buffer
-        std::stringstream ss(l);
-        ss >> index;
+        p = parseBFileInt(p, eol, digits);
+        if (!p || digits.size() > 18) {
+          throw std::runtime_error("invalid index");
+        }
+        index = std::stoll(digits);
         if (expected_index == -1) {
           expected_index = index;
         }
@@ -83,10 +158,16 @@ Sequence ManagedSequence::loadBFile() const {
           result.clear();
           return result;
         }
-        ss >> std::ws;
-        Number::readIntString(ss, buf);
-        Number value(buf);
-        if (!ss || SequenceUtil::isTooBig(value)) {
+        p = skipBFileSpaces(p, eol);
+        p = parseBFileInt(p, eol, digits);
+        if (!p) {
+          throw std::runtime_error("invalid term");
+        }
+        // fast path for terms that fit into int64
+        const auto num_digits = digits.size() - (digits[0] == '-' ? 1 : 0);
+        Number value = (num_digits <= 18) ? Number(std::stoll(digits))
+                                          : Number(digits);
+        if (SequenceUtil::isTooBig(value)) {
           break;
         }
         result.push_back(value);
@@ -113,25 +194,25 @@ Sequence ManagedSequence::loadBFile() const {
   }
 
   // align sequences on common prefix (will verify correctness below again!)
-  result.align(terms, 5);
+  result.align(base, 5);
 
   // check length
   std::string error_state;
 
-  if (result.size() < terms.size()) {
+  if (result.size() < base.size()) {
     // big should never be shorter (there can be parser issues causing this)
-    result = terms;
+    result = base;
   }
 
   if (result.empty()) {
     error_state = "empty";
   } else {
     // check that the sequences agree on prefix
-    auto test = result.subsequence(0, terms.size());
-    if (test != terms) {
+    auto test = result.subsequence(0, base.size());
+    if (test != base) {
       Log::get().warn("Unexpected terms in b-file or program for " +
                       id.string());
-      Log::get().warn("- expected: " + terms.to_string());
+      Log::get().warn("- expected: " + base.to_string());
       Log::get().warn("- found:    " + test.to_string());
       error_state = "invalid";
     }
@@ -154,55 +235,70 @@ Sequence ManagedSequence::loadBFile() const {
   return result;
 }
 
+size_t ManagedSequence::numExistingTerms() const {
+  return packed_terms ? num_packed_terms : terms.size();
+}
+
+Sequence ManagedSequence::getBaseTerms(size_t max_num_terms) const {
+  Sequence result;
+  if (!packed_terms) {
+    result.resize(std::min(max_num_terms, terms.size()));
+    for (size_t i = 0; i < result.size(); i++) {
+      result[i] = terms.get(i);
+    }
+    return result;
+  }
+  const auto n = std::min(max_num_terms, num_packed_terms);
+  result.reserve(n);
+  decodePackedTerms(packed_terms, n, result);
+  return result;
+}
+
 Sequence ManagedSequence::getTerms(int64_t max_num_terms) const {
   // determine real number of terms
   size_t real_max_terms =
       (max_num_terms >= 0) ? max_num_terms : SequenceUtil::EXTENDED_SEQ_LENGTH;
 
   // already have enough terms?
-  if (real_max_terms <= terms.size()) {
-    return terms.subsequence(0, real_max_terms);
+  if (real_max_terms <= numExistingTerms()) {
+    return getBaseTerms(real_max_terms);
   }
 
   if (id.number() == 0) {
     Log::get().error("Invalid sequence ID: " + id.string(), true);
   }
 
-  // try to (re-)load b-file if not loaded yet or if there are more terms
-  // available
-  if (num_bfile_terms == 0 || num_bfile_terms > terms.size()) {
-    const auto path = getBFilePath();
-    auto big = loadBFile();
-    if (big.empty() && id.domain() == 'A') {
-      // fetch b-file
-      std::ifstream big_file(path);
-      if (!big_file.good() ||
-          big_file.peek() == std::ifstream::traits_type::eof()) {
-        ensureDir(path);
-        std::remove(path.c_str());
-        std::string bfile = "b" + id.string().substr(1) + ".txt";
-        ApiClient::getDefaultInstance().getOeisFile(bfile, path);
-        big = loadBFile();
-      }
-    }
-    if (big.empty()) {
-      if (id.domain() == 'A') {
-        Log::get().error("Error loading b-file " + path, true);
-      } else {
-        Log::get().warn("Missing b-file for " + id.string());
-        big = terms;  // use what we have
-      }
-    }
-    num_bfile_terms = big.size();
+  // the full terms are managed by the b-file cache
+  auto big = BFileCache::get().getTerms(*this);
+  if (big->size() <= real_max_terms) {
+    return *big;
+  }
+  return big->subsequence(0, real_max_terms);
+}
 
-    // shrink big sequence to maximum number of terms
-    if (big.size() > real_max_terms) {
-      big = big.subsequence(0, real_max_terms);
+Sequence ManagedSequence::loadFullTerms() const {
+  const auto base = getBaseTerms(numExistingTerms());
+  const auto path = getBFilePath();
+  auto big = loadBFile(base);
+  if (big.empty() && id.domain() == 'A') {
+    // fetch b-file
+    std::ifstream big_file(path);
+    if (!big_file.good() ||
+        big_file.peek() == std::ifstream::traits_type::eof()) {
+      ensureDir(path);
+      std::remove(path.c_str());
+      std::string bfile = "b" + id.string().substr(1) + ".txt";
+      ApiClient::getDefaultInstance().getOeisFile(bfile, path);
+      big = loadBFile(base);
     }
-
-    // replace terms
-    terms = big;
   }
-
-  return terms;
+  if (big.empty()) {
+    if (id.domain() == 'A') {
+      Log::get().error("Error loading b-file " + path, true);
+    } else {
+      Log::get().warn("Missing b-file for " + id.string());
+      big = base;  // use what we have
+    }
+  }
+  return big;
 }
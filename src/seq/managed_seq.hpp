@@ -1,14 +1,22 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <unordered_set>
 
 #include "base/uid.hpp"
+#include "math/compact_sequence.hpp"
 #include "math/sequence.hpp"
 #include "seq/seq_util.hpp"
 
+class MappedFile;
+
 class ManagedSequence {
  public:
+  // Marker of a big term in packed terms. Packed terms are int64 values in
+  // native byte order; big terms are stored as marker, length and digits.
+  static constexpr int64_t PACKED_BIG_TERM = INT64_MIN;
+
   ManagedSequence(UID id = UID());
 
   ManagedSequence(UID id, const std::string& name, const Sequence& full);
@@ -18,7 +26,21 @@ class ManagedSequence {
   Sequence getTerms(
       int64_t max_num_terms = SequenceUtil::EXTENDED_SEQ_LENGTH) const;
 
-  size_t numExistingTerms() const { return terms.size(); }
+  size_t numExistingTerms() const;
+
+  // Load all terms including the b-file, fetching it if necessary. Use
+  // getTerms() to access the terms via the global b-file cache.
+  Sequence loadFullTerms() const;
+
+  // Use packed terms of a memory-mapped file instead of storing the terms.
+  // The mapping is shared by all processes that attach the same file and
+  // the terms are decoded on demand.
+  void attachPackedTerms(std::shared_ptr<const MappedFile> file,
+                         const char *data, size_t num_terms);
+
+  // Decode packed terms. Returns a pointer to the end of the terms.
+  static const char *decodePackedTerms(const char *data, size_t num_terms,
+                                       Sequence &seq);
 
   std::string string() const;
 
@@ -29,9 +51,12 @@ class ManagedSequence {
   int64_t offset;
 
  private:
-  mutable Sequence terms;
-  mutable size_t num_bfile_terms;
+  CompactSequence terms;  // terms without b-file
+  std::shared_ptr<const MappedFile> packed_file;
+  const char *packed_terms;
+  size_t num_packed_terms;
 
-  Sequence loadBFile() const;
+  Sequence getBaseTerms(size_t max_num_terms) const;
+  Sequence loadBFile(const Sequence& base) const;
   void removeInvalidBFile(const std::string& error = "invalid") const;
 };
@@ -1,7 +1,9 @@
 #include "seq/seq_loader.hpp"
 
 #include <chrono>
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <sstream>
 
 #include "seq/seq_list.hpp"
@@ -13,8 +15,13 @@ void throwParseError(const std::string &line) {
   Log::get().error("Error parsing line: " + line, true);
 }
 
-SequenceLoader::SequenceLoader(SequenceIndex &index, size_t min_num_terms)
-    : index(index), min_num_terms(min_num_terms), num_loaded(0), num_total(0) {}
+SequenceLoader::SequenceLoader(SequenceIndex &index, size_t min_num_terms,
+                               bool shared_terms)
+    : index(index),
+      min_num_terms(min_num_terms),
+      shared_terms(shared_terms),
+      num_loaded(0),
+      num_total(0) {}
 
 void SequenceLoader::load(std::string folder, char domain) {
   if (!checkFolderDomain(folder, domain)) {
@@ -26,9 +33,12 @@ void SequenceLoader::load(std::string folder, char domain) {
 
   auto new_loaded = num_loaded;
   auto new_total = num_total;
-  loadData(folder, domain);
-  loadNames(folder, domain);
-  loadOffsets(folder, domain);
+  if (!loadSnapshot(folder, domain)) {
+    loadData(folder, domain);
+    loadNames(folder, domain);
+    loadOffsets(folder, domain);
+    saveSnapshot(folder, domain, num_total - new_total);
+  }
   new_loaded = num_loaded - new_loaded;
   new_total = num_total - new_total;
 
@@ -160,6 +170,201 @@ void SequenceLoader::loadOffsets(const std::string &folder, char domain) {
   }
 }
 
+// --- Binary snapshot --------------------------------------------------------
+
+const std::string SNAPSHOT_FILE = "stripped.bin";
+const char SNAPSHOT_MAGIC[8] = {'L', 'O', 'D', 'A', 'S', 'E', 'Q', '1'};
+const int64_t SNAPSHOT_BIG_TERM = ManagedSequence::PACKED_BIG_TERM;
+
+// Source files of a snapshot. Their sizes and modification times are stored
+// in the snapshot header to detect stale snapshots.
+const std::vector<std::string> SNAPSHOT_SOURCES = {"stripped", "names",
+                                                   "offsets"};
+
+std::vector<int64_t> getSnapshotStamps(const std::string &folder) {
+  std::vector<int64_t> stamps;
+  for (const auto &source : SNAPSHOT_SOURCES) {
+    std::error_code ec;
+    const std::filesystem::path path(folder + source);
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+      stamps.push_back(-1);
+      stamps.push_back(-1);
+      continue;
+    }
+    const auto time = std::filesystem::last_write_time(path, ec);
+    stamps.push_back(static_cast<int64_t>(size));
+    stamps.push_back(ec ? -1 : static_cast<int64_t>(
+                                   time.time_since_epoch().count()));
+  }
+  return stamps;
+}
+
+void writeInt(std::ostream &out, int64_t value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+bool readInt(const char *&pos, const char *end, int64_t &value) {
+  if (end - pos < static_cast<std::ptrdiff_t>(sizeof(value))) {
+    return false;
+  }
+  std::memcpy(&value, pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+bool readString(const char *&pos, const char *end, std::string &value) {
+  int64_t length;
+  if (!readInt(pos, end, length) || length < 0 || end - pos < length) {
+    return false;
+  }
+  value.assign(pos, length);
+  pos += length;
+  return true;
+}
+
+bool SequenceLoader::loadSnapshot(const std::string &folder, char domain) {
+  const std::string path = folder + SNAPSHOT_FILE;
+  if (!isFile(path)) {
+    return false;
+  }
+  Log::get().debug("Loading sequence snapshot from \"" + path + "\"");
+  std::shared_ptr<MappedFile> file;
+  try {
+    file.reset(new MappedFile(path));
+  } catch (const std::exception &e) {
+    Log::get().warn(std::string(e.what()));
+    return false;
+  }
+  const char *pos = file->data();
+  const char *end = pos + file->size();
+
+  // check header
+  if (file->size() < sizeof(SNAPSHOT_MAGIC) ||
+      std::memcmp(pos, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+    Log::get().warn("Ignoring invalid sequence snapshot " + path);
+    return false;
+  }
+  pos += sizeof(SNAPSHOT_MAGIC);
+  int64_t snapshot_domain, snapshot_min_terms, total, count;
+  if (!readInt(pos, end, snapshot_domain) ||
+      !readInt(pos, end, snapshot_min_terms) || !readInt(pos, end, total) ||
+      !readInt(pos, end, count) || snapshot_domain != domain ||
+      snapshot_min_terms != static_cast<int64_t>(min_num_terms)) {
+    Log::get().debug("Ignoring incompatible sequence snapshot " + path);
+    return false;
+  }
+  for (auto stamp : getSnapshotStamps(folder)) {
+    int64_t snapshot_stamp;
+    if (!readInt(pos, end, snapshot_stamp) || snapshot_stamp != stamp) {
+      Log::get().debug("Ignoring outdated sequence snapshot " + path);
+      return false;
+    }
+  }
+
+  // decode sequences; they are added to the index only if the snapshot is
+  // complete
+  std::vector<ManagedSequence> seqs;
+  seqs.reserve(count);
+  Sequence terms;
+  std::string name, big;
+  int64_t id = 0, offset = 0, num_terms = 0, term = 0;
+  bool ok = true;
+  for (int64_t i = 0; i < count && ok; i++) {
+    ok = readInt(pos, end, id) && readInt(pos, end, offset) &&
+         readString(pos, end, name) && readInt(pos, end, num_terms) &&
+         id > 0 && num_terms >= 0 && num_terms <= (end - pos) / 8;
+    terms.clear();
+    const char *packed = pos;
+    for (int64_t j = 0; j < num_terms && ok; j++) {
+      ok = readInt(pos, end, term);
+      if (ok && term == SNAPSHOT_BIG_TERM) {
+        ok = readString(pos, end, big);
+        if (ok && !shared_terms) {
+          terms.push_back(Number(big));
+        }
+      } else if (ok && !shared_terms) {
+        terms.push_back(Number(term));
+      }
+    }
+    if (ok) {
+      seqs.emplace_back(UID(domain, id), name, terms);
+      seqs.back().offset = offset;
+      if (shared_terms) {
+        seqs.back().attachPackedTerms(file, packed, num_terms);
+      }
+    }
+  }
+  if (!ok || pos != end) {
+    Log::get().warn("Ignoring corrupt sequence snapshot " + path);
+    return false;
+  }
+  for (auto &seq : seqs) {
+    index.add(std::move(seq));
+  }
+  num_loaded += seqs.size();
+  num_total += total;
+  return true;
+}
+
+void SequenceLoader::saveSnapshot(const std::string &folder, char domain,
+                                  size_t total) {
+  const std::string path = folder + SNAPSHOT_FILE;
+  // unique temporary file for concurrent rebuilds by multiple processes
+  const std::string tmp_path =
+      path + ".tmp" + std::to_string(Random::get().gen());
+  Log::get().debug("Saving sequence snapshot to \"" + path + "\"");
+  std::vector<const ManagedSequence *> seqs;
+  for (const auto &s : index) {
+    if (s.id.domain() == domain) {
+      seqs.push_back(&s);
+    }
+  }
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeInt(out, domain);
+    writeInt(out, min_num_terms);
+    writeInt(out, total);
+    writeInt(out, seqs.size());
+    for (auto stamp : getSnapshotStamps(folder)) {
+      writeInt(out, stamp);
+    }
+    for (auto s : seqs) {
+      writeInt(out, s->id.number());
+      writeInt(out, s->offset);
+      writeInt(out, s->name.size());
+      out.write(s->name.data(), s->name.size());
+      const auto terms = s->getTerms(s->numExistingTerms());
+      writeInt(out, terms.size());
+      for (const auto &t : terms) {
+        if (t.fitsInInt64() && t.asInt() != SNAPSHOT_BIG_TERM) {
+          writeInt(out, t.asInt());
+        } else {
+          const auto str = t.to_string();
+          writeInt(out, SNAPSHOT_BIG_TERM);
+          writeInt(out, str.size());
+          out.write(str.data(), str.size());
+        }
+      }
+    }
+    if (!out.good()) {
+      Log::get().warn("Cannot write sequence snapshot " + tmp_path);
+      out.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  // replace the snapshot atomically
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    Log::get().warn("Cannot rename sequence snapshot " + tmp_path + ": " +
+                    ec.message());
+    std::remove(tmp_path.c_str());
+  }
+}
+
 bool SequenceLoader::checkFolderDomain(std::string &folder, char domain) {
   if (folder.back() != '/' && folder.back() != '\\') {
     folder += FILE_SEP;
@@ -4,7 +4,11 @@
 
 class SequenceLoader {
  public:
-  SequenceLoader(SequenceIndex& index, size_t min_num_terms);
+  // If shared_terms is true, the terms of sequences loaded from a snapshot are
+  // not copied but decoded on demand from the memory-mapped snapshot, which
+  // is shared by all miner processes on the same machine.
+  SequenceLoader(SequenceIndex& index, size_t min_num_terms,
+                 bool shared_terms = false);
 
   void load(std::string folder, char domain);
 
@@ -18,10 +22,17 @@ class SequenceLoader {
   void loadNames(const std::string& folder, char domain);
   void loadOffsets(const std::string& folder, char domain);
 
+  // Binary snapshot of the sequence data, names and offsets of a folder. It
+  // is memory-mapped and decoded without text parsing. The snapshot is
+  // rebuilt if any of the source files was changed.
+  bool loadSnapshot(const std::string& folder, char domain);
+  void saveSnapshot(const std::string& folder, char domain, size_t total);
+
   bool checkFolderDomain(std::string& folder, char domain);
 
   SequenceIndex& index;
   const size_t min_num_terms;
+  const bool shared_terms;
   size_t num_loaded;
   size_t num_total;
   std::vector<std::string> folders;
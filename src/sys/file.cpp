@@ -23,7 +23,9 @@
 #include <psapi.h>
 #include <windows.h>
 #else
+#include <fcntl.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -372,3 +374,72 @@ void FolderLock::release() {
   fd = 0;
 #endif
 }
+
+MappedFile::MappedFile(const std::string& path) : ptr(nullptr), len(0) {
+#ifdef _WIN64
+  mapping = nullptr;
+  // allow other processes to replace the file while it is mapped
+  file = CreateFile(path.c_str(), GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_DELETE, 0, OPEN_EXISTING,
+                    FILE_ATTRIBUTE_NORMAL, 0);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    throw std::runtime_error("Cannot determine size of " + path);
+  }
+  len = static_cast<size_t>(file_size.QuadPart);
+  if (len > 0) {
+    mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+    if (mapping) {
+      ptr = static_cast<const char*>(
+          MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!ptr) {
+      if (mapping) {
+        CloseHandle(mapping);
+      }
+      CloseHandle(file);
+      throw std::runtime_error("Cannot map " + path);
+    }
+  }
+#else
+  fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot determine size of " + path);
+  }
+  len = static_cast<size_t>(st.st_size);
+  if (len > 0) {
+    void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Cannot map " + path);
+    }
+    ptr = static_cast<const char*>(p);
+  }
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN64
+  if (ptr) {
+    UnmapViewOfFile(ptr);
+  }
+  if (mapping) {
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+#else
+  if (ptr) {
+    munmap(const_cast<char*>(ptr), len);
+  }
+  close(fd);
+#endif
+}
@@ -77,3 +77,30 @@ class FolderLock {
   int fd;
 #endif
 };
+
+// Read-only memory mapping of a file. The mapped data is valid until the
+// object is destroyed.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return ptr; }
+
+  size_t size() const { return len; }
+
+ private:
+  const char *ptr;
+  size_t len;
+#ifdef _WIN64
+  void *file;
+  void *mapping;
+#else
+  int fd;
+#endif
+};
@@ -203,6 +203,38 @@ std::vector<std::pair<std::string, std::string>> Git::diffTree(
   return result;
 }
 
+std::string Git::headCommit(const std::string &folder) {
+  auto tmp_file = getTmpFile();
+  std::string result;
+  if (git(folder, "rev-parse HEAD > \"" + tmp_file + "\"", false)) {
+    std::ifstream in(tmp_file);
+    std::getline(in, result);
+  }
+  std::remove(tmp_file.c_str());
+  return result;
+}
+
+bool Git::changedFiles(const std::string &folder, const std::string &commit_id,
+                       std::vector<std::string> &files) {
+  auto tmp_file = getTmpFile();
+  const std::string redirect = " >> \"" + tmp_file + "\"";
+  std::remove(tmp_file.c_str());
+  bool ok = git(folder, "diff --name-only " + commit_id + " HEAD" + redirect,
+                false) &&
+            git(folder, "diff --name-only HEAD" + redirect, false);
+  if (ok) {
+    std::ifstream in(tmp_file);
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty()) {
+        files.push_back(line);
+      }
+    }
+  }
+  std::remove(tmp_file.c_str());
+  return ok;
+}
+
 void Git::gunzip(const std::string &path, bool keep) { ::gunzip(path, keep); }
 
 std::string Git::extractHeadVersion(const std::string &folder,
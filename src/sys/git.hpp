@@ -32,6 +32,16 @@ class Git {
   static std::vector<std::pair<std::string, std::string>> diffTree(
       const std::string &folder, const std::string &commit_id);
 
+  // Returns the ID of the HEAD commit or an empty string on errors.
+  static std::string headCommit(const std::string &folder);
+
+  // Collect the files that were changed since the given commit, including
+  // uncommitted changes of tracked files. Returns false on errors, e.g., if
+  // the commit is unknown.
+  static bool changedFiles(const std::string &folder,
+                           const std::string &commit_id,
+                           std::vector<std::string> &files);
+
   static void gunzip(const std::string &path, bool keep);
 
   // Returns the path to a tmp file containing the HEAD version of the file.
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <thread>
 
 #include "sys/file.hpp"
@@ -133,6 +134,9 @@ void Log::log(Level level, const std::string& msg) {
   if (level < this->level || silent) {
     return;
   }
+  // serialize messages of concurrent mining threads
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
   time_t rawtime;
   char buffer[80];
   time(&rawtime);
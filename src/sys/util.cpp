@@ -39,8 +39,16 @@ Settings::Settings()
       parallel_mining(false),
       report_cpu_hours(true),
       num_miner_instances(0),
+      num_mine_threads(1),
       num_mine_hours(0),
-      print_as_b_file(false) {}
+      num_stats_threads(0),
+      num_eval_threads(1),
+      num_seen_programs(DEFAULT_SEEN_PROGRAMS),
+      print_as_b_file(false),
+      use_bytecode(true),
+      use_memory_journal(true),
+      use_term_store(true),
+      use_shared_seqs(true) {}
 
 enum class Option {
   NONE,
@@ -49,7 +57,11 @@ enum class Option {
   MAX_CYCLES,
   MAX_EVAL_SECS,
   NUM_INSTANCES,
+  NUM_MINE_THREADS,
   NUM_MINE_HOURS,
+  NUM_STATS_THREADS,
+  NUM_EVAL_THREADS,
+  NUM_SEEN_PROGRAMS,
   MINER_PROFILE,
   EXPORT_FORMAT,
   LOG_LEVEL
@@ -62,12 +74,17 @@ std::vector<std::string> Settings::parseArgs(int argc, char* argv[]) {
     std::string arg(argv[i]);
     if (option == Option::NUM_TERMS || option == Option::MAX_MEMORY ||
         option == Option::MAX_CYCLES || option == Option::MAX_EVAL_SECS ||
-        option == Option::NUM_INSTANCES || option == Option::NUM_MINE_HOURS) {
+        option == Option::NUM_INSTANCES || option == Option::NUM_MINE_THREADS ||
+        option == Option::NUM_MINE_HOURS ||
+        option == Option::NUM_STATS_THREADS ||
+        option == Option::NUM_EVAL_THREADS ||
+        option == Option::NUM_SEEN_PROGRAMS) {
       std::stringstream s(arg);
       int64_t val;
       s >> val;
       if (option != Option::MAX_CYCLES && option != Option::MAX_MEMORY &&
-          option != Option::MAX_EVAL_SECS && val < 1) {
+          option != Option::MAX_EVAL_SECS &&
+          val < (option == Option::NUM_SEEN_PROGRAMS ? 0 : 1)) {
         Log::get().error("Invalid value for option: " + std::to_string(val),
                          true);
       }
@@ -87,9 +104,21 @@ std::vector<std::string> Settings::parseArgs(int argc, char* argv[]) {
         case Option::NUM_INSTANCES:
           num_miner_instances = val;
           break;
+        case Option::NUM_MINE_THREADS:
+          num_mine_threads = val;
+          break;
         case Option::NUM_MINE_HOURS:
           num_mine_hours = val;
           break;
+        case Option::NUM_STATS_THREADS:
+          num_stats_threads = val;
+          break;
+        case Option::NUM_EVAL_THREADS:
+          num_eval_threads = val;
+          break;
+        case Option::NUM_SEEN_PROGRAMS:
+          num_seen_programs = val;
+          break;
         case Option::LOG_LEVEL:
         case Option::MINER_PROFILE:
         case Option::EXPORT_FORMAT:
@@ -142,12 +171,24 @@ std::vector<std::string> Settings::parseArgs(int argc, char* argv[]) {
       } else if (opt == "P") {
         parallel_mining = true;
         option = Option::NUM_INSTANCES;
+      } else if (opt == "T") {
+        option = Option::NUM_MINE_THREADS;
       } else if (opt == "H") {
         option = Option::NUM_MINE_HOURS;
       } else if (opt == "b") {
         print_as_b_file = true;
       } else if (opt == "-no-report-cpu-hours") {
         report_cpu_hours = false;
+      } else if (opt == "-no-term-store") {
+        use_term_store = false;
+      } else if (opt == "-no-shared-seqs") {
+        use_shared_seqs = false;
+      } else if (opt == "-stats-threads") {
+        option = Option::NUM_STATS_THREADS;
+      } else if (opt == "-eval-threads") {
+        option = Option::NUM_EVAL_THREADS;
+      } else if (opt == "-seen-programs") {
+        option = Option::NUM_SEEN_PROGRAMS;
       } else if (opt == "l") {
         option = Option::LOG_LEVEL;
       } else {
@@ -182,6 +223,10 @@ void Settings::printArgs(std::vector<std::string>& args) {
   if (parallel_mining) {
     args.push_back("-p");
   }
+  if (num_mine_threads > 1) {
+    args.push_back("-T");
+    args.push_back(std::to_string(num_mine_threads));
+  }
   if (num_mine_hours > 0) {
     args.push_back("-H");
     args.push_back(std::to_string(num_mine_hours));
@@ -189,6 +234,24 @@ void Settings::printArgs(std::vector<std::string>& args) {
   if (!report_cpu_hours) {
     args.push_back("--no-report-cpu-hours");
   }
+  if (!use_term_store) {
+    args.push_back("--no-term-store");
+  }
+  if (!use_shared_seqs) {
+    args.push_back("--no-shared-seqs");
+  }
+  if (num_stats_threads > 0) {
+    args.push_back("--stats-threads");
+    args.push_back(std::to_string(num_stats_threads));
+  }
+  if (num_eval_threads > 1) {
+    args.push_back("--eval-threads");
+    args.push_back(std::to_string(num_eval_threads));
+  }
+  if (num_seen_programs != DEFAULT_SEEN_PROGRAMS) {
+    args.push_back("--seen-programs");
+    args.push_back(std::to_string(num_seen_programs));
+  }
   if (!miner_profile.empty()) {
     args.push_back("-i");
     args.push_back(miner_profile);
@@ -335,7 +398,8 @@ uint32_t ProgressMonitor::decode(uint64_t value) {
 }
 
 Random& Random::get() {
-  static Random rand;
+  // one generator per thread to support concurrent mining threads
+  static thread_local Random rand;
   return rand;
 }
 
@@ -345,7 +409,7 @@ Random::Random() {
   gen.seed(seed);
 }
 
-bool Signals::HALT = false;
+std::atomic<bool> Signals::HALT(false);
 
 void trimString(std::string& str) {
   while (!str.empty()) {
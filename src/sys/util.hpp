@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <map>
@@ -21,6 +22,7 @@ class Settings {
   static constexpr size_t DEFAULT_NUM_TERMS = 8;
   static constexpr int64_t DEFAULT_MAX_MEMORY = 2000;
   static constexpr int64_t DEFAULT_MAX_CYCLES = 100000000;
+  static constexpr int64_t DEFAULT_SEEN_PROGRAMS = 1000000;
 
   size_t num_terms;
   int64_t max_memory;
@@ -32,13 +34,29 @@ class Settings {
   bool parallel_mining;
   bool report_cpu_hours;
   int64_t num_miner_instances;
+  int64_t num_mine_threads;
   int64_t num_mine_hours;
+  int64_t num_stats_threads;  // 0: number of hardware threads
+  int64_t num_eval_threads;   // 1: sequential evaluation
+  int64_t num_seen_programs;  // 0: no filtering of seen programs
   std::string miner_profile;
   std::string export_format;
 
   // flag for printing evaluation results in b-file format
   bool print_as_b_file;
 
+  // flag for running programs using the bytecode interpreter
+  bool use_bytecode;
+
+  // flag for undoing loop iterations using a journal instead of snapshots
+  bool use_memory_journal;
+
+  // flag for sharing evaluated sequence terms between miner processes
+  bool use_term_store;
+
+  // flag for sharing the memory-mapped sequence data between miner processes
+  bool use_shared_seqs;
+
   Settings();
 
   std::vector<std::string> parseArgs(int argc, char* argv[]);
@@ -101,7 +119,8 @@ class Random {
 
 class Signals {
  public:
-  static bool HALT;
+  // stop flag; can be set from any thread
+  static std::atomic<bool> HALT;
 };
 
 void trimString(std::string& str);